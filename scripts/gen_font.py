@@ -0,0 +1,382 @@
+"""
+Compile BDF/PSF fonts into the packed glyph atlases the MAX7219 driver draws from
+
+    python3 scripts/gen_font.py                      # fonts/fonts.json -> src/max7219_font.{h,cpp}
+    python3 scripts/gen_font.py -o /tmp/f.h          # write /tmp/f.h and /tmp/f.cpp
+    python3 scripts/gen_font.py --dump FONT_NARROW   # print a font's glyphs as ASCII art
+
+fonts/fonts.json lists the fonts to build:
+
+    name          C identifier of the Font
+    source        BDF or PSF (v1/v2) file, relative to fonts/
+    chars         Characters to keep, e.g. "0123456789: " (optional)
+    ranges        Code point ranges to keep, e.g. [[32, 127]] (optional; all glyphs if
+                  neither is given)
+    spacing       Columns added after every glyph (default 0)
+    proportional  Crop each glyph to its ink and advance by ink width + spacing
+    if            Preprocessor condition the font is built under, so a build variant
+                  only carries the fonts it uses (optional)
+
+Glyph rows are packed back to back, width bits each, leftmost column first (see
+src/font.h). A font whose glyphs all share one width and advance needs no per-glyph
+index. The output also holds the bit-order tables the driver uses for the flipped
+orientation, so rotating is a table lookup rather than per-bit work at refresh time.
+Data goes in the .cpp and the header only declares it, so any module can pick a font.
+Run it again (or `make fonts`) after editing a font or the manifest; the output is
+checked in.
+"""
+
+import argparse
+import json
+import os
+import struct
+
+ROOT = os.path.normpath(os.path.join(os.path.dirname(__file__), '..'))
+FONTS = os.path.join(ROOT, 'fonts')
+
+# Row bytes hold at most this many columns (FONT_MAX_WIDTH in src/font.h)
+MAX_WIDTH = 8
+
+# Rows on the LED matrix; taller fonts are clipped when drawn
+PANEL_ROWS = 8
+
+class Glyph:
+    def __init__(self, code, name, rows, width, advance):
+        self.code = code
+        self.name = name
+        self.rows = rows        # One int per font row, bit (width - 1 - x) = column x
+        self.width = width
+        self.advance = advance  # Spacing added in compile_font()
+
+def parse_bdf(path):
+    """Return (height, default char, [Glyph]) with every glyph placed in the font's cell"""
+    props = {}
+    raw = []
+    bbox = None
+    glyph = None
+    with open(path) as f:
+        for line in f:
+            parts = line.split()
+            if not parts:
+                continue
+            key = parts[0]
+            if glyph is not None and 'bitmap' in glyph and key != 'ENDCHAR':
+                glyph['bitmap'].append((int(key, 16), len(key) * 4))
+            elif key == 'FONTBOUNDINGBOX':
+                bbox = [int(p) for p in parts[1:5]]
+            elif key in ('FONT_ASCENT', 'FONT_DESCENT', 'DEFAULT_CHAR'):
+                props[key] = int(parts[1])
+            elif key == 'STARTCHAR':
+                glyph = {'name': parts[1] if len(parts) > 1 else None}
+            elif key == 'ENCODING':
+                glyph['code'] = int(parts[1])
+            elif key == 'DWIDTH':
+                glyph['dwidth'] = int(parts[1])
+            elif key == 'BBX':
+                glyph['bbx'] = [int(p) for p in parts[1:5]]
+            elif key == 'BITMAP':
+                glyph['bitmap'] = []
+            elif key == 'ENDCHAR':
+                raw.append(glyph)
+                glyph = None
+
+    ascent = props.get('FONT_ASCENT', bbox[1] + bbox[3])
+    descent = props.get('FONT_DESCENT', -bbox[3])
+    height = ascent + descent
+
+    glyphs = []
+    for g in raw:
+        code = g.get('code', -1)
+        if code < 0:
+            continue
+        w, h, xoff, yoff = g.get('bbx', bbox)
+        advance = g.get('dwidth', w)
+        width = max(advance, xoff + w)
+        rows = [0] * height
+        top = ascent - (yoff + h)
+        for i, (bits, padded) in enumerate(g.get('bitmap', [])):
+            y = top + i
+            if 0 <= y < height:
+                # BDF rows are left-aligned in whole bytes
+                rows[y] = (bits >> (padded - w)) << (width - xoff - w)
+        glyphs.append(Glyph(code, g['name'], rows, width, advance))
+    return height, props.get('DEFAULT_CHAR'), glyphs
+
+def parse_psf(path):
+    """Return (height, default char, [Glyph]) from a PSF1 or PSF2 console font"""
+    with open(path, 'rb') as f:
+        data = f.read()
+
+    v1 = data[:2] == b'\x36\x04'
+    if v1:
+        mode, height = data[2], data[3]
+        count = 512 if mode & 0x01 else 256
+        width, offset, glyph_bytes = 8, 4, height
+        has_table = bool(mode & 0x06)
+    elif data[:4] == b'\x72\xb5\x4a\x86':
+        _, offset, flags, count, glyph_bytes, height, width = struct.unpack('<7I', data[4:32])
+        has_table = bool(flags & 0x01)
+    else:
+        raise SystemExit(f"{path}: not a PSF font")
+    row_bytes = (width + 7) // 8
+
+    bitmaps = []
+    for i in range(count):
+        start = offset + i * glyph_bytes
+        rows = []
+        for y in range(height):
+            bits = int.from_bytes(data[start + y * row_bytes:start + (y + 1) * row_bytes], 'big')
+            rows.append(bits >> (row_bytes * 8 - width))
+        bitmaps.append(rows)
+
+    # Without a Unicode table glyph i is character i
+    codes = {i: [i] for i in range(count)}
+    if has_table:
+        codes = psf_unicode_table(data, offset + count * glyph_bytes, count, v1)
+
+    glyphs = []
+    for i, rows in enumerate(bitmaps):
+        for code in codes.get(i, []):
+            glyphs.append(Glyph(code, f'U+{code:04X}', rows, width, width))
+    return height, None, glyphs
+
+def psf_unicode_table(data, pos, count, v1):
+    """Map glyph index -> code points (single characters only; sequences are skipped)"""
+    codes = {}
+    for i in range(count):
+        entry = []
+        in_sequence = False
+        while pos < len(data):
+            if v1:
+                (value,) = struct.unpack('<H', data[pos:pos + 2])
+                pos += 2
+                if value == 0xFFFF:
+                    break
+                if value == 0xFFFE:
+                    in_sequence = True
+                elif not in_sequence:
+                    entry.append(value)
+                continue
+            byte = data[pos]
+            if byte in (0xFE, 0xFF):
+                pos += 1
+                if byte == 0xFF:
+                    break
+                in_sequence = True
+                continue
+            length = 1 if byte < 0x80 else 2 if byte < 0xE0 else 3 if byte < 0xF0 else 4
+            if not in_sequence:
+                entry.append(ord(data[pos:pos + length].decode('utf-8')))
+            pos += length
+        codes[i] = entry
+    return codes
+
+def wanted(entry):
+    """Set of code points a manifest entry keeps, or None for all"""
+    keep = {ord(ch) for ch in entry.get('chars', '')}
+    for first, last in entry.get('ranges', []):
+        keep.update(range(first, last + 1))
+    return keep or None
+
+def crop(glyph):
+    """Drop blank columns on both sides; blank glyphs keep their advance"""
+    ink = 0
+    for row in glyph.rows:
+        ink |= row
+    if ink == 0:
+        return Glyph(glyph.code, glyph.name, glyph.rows, 0, glyph.advance)
+    right = (ink & -ink).bit_length() - 1
+    width = ink.bit_length() - right
+    return Glyph(glyph.code, glyph.name, [row >> right for row in glyph.rows], width, width)
+
+def char_comment(glyph):
+    # Printable ASCII as itself, anything else by its glyph name
+    if 32 < glyph.code < 126 and glyph.code != ord('\\'):
+        return chr(glyph.code)
+    return glyph.name or f'U+{glyph.code:04X}'
+
+def compile_font(entry):
+    """Return (glyphs, height, monospace) for one manifest entry"""
+    name = entry['name']
+    source = os.path.join(FONTS, entry['source'])
+    height, default, glyphs = (parse_bdf if source.endswith('.bdf') else parse_psf)(source)
+    proportional = entry.get('proportional', False)
+
+    keep = wanted(entry)
+    by_code = {}
+    for g in glyphs:
+        if g.code <= 255 and (keep is None or g.code in keep) and g.code not in by_code:
+            by_code[g.code] = crop(g) if proportional else g
+    if keep is not None and keep - set(by_code):
+        missing = ' '.join(repr(chr(c)) for c in sorted(keep - set(by_code)))
+        print(f"warning: {name}: {entry['source']} has no glyph for {missing}")
+    if height > PANEL_ROWS:
+        print(f"warning: {name}: {height} rows, only the top {PANEL_ROWS} show on the matrix")
+
+    glyphs = [by_code[c] for c in sorted(by_code)]
+    for g in glyphs:
+        g.advance += entry.get('spacing', 0)
+        if max(g.width, g.advance) > MAX_WIDTH:
+            raise SystemExit(f"{source}: glyph {g.code} takes {max(g.width, g.advance)} columns, "
+                             f"at most {MAX_WIDTH} fit a row byte")
+
+    # One width and advance for every glyph: offsets follow from the index
+    monospace = not proportional and len({(g.width, g.advance) for g in glyphs}) == 1
+    if not monospace:
+        for g in glyphs:
+            if not any(g.rows):
+                g.width = 0
+    return glyphs, height, monospace, default
+
+def emit(entry):
+    """Return (C lines, flash bytes) for one manifest entry"""
+    name = entry['name']
+    glyphs, height, monospace, default = compile_font(entry)
+
+    # Contiguous code points share a range
+    ranges = []
+    for i, g in enumerate(glyphs):
+        if ranges and ranges[-1][1] == g.code - 1:
+            ranges[-1][1] = g.code
+        else:
+            ranges.append([g.code, g.code, i])
+
+    bits = []
+    offsets = []
+    for g in glyphs:
+        offsets.append(len(bits))
+        for row in g.rows:
+            bits.extend((row >> (g.width - 1 - x)) & 1 for x in range(g.width))
+    if len(bits) >= 1 << 16:
+        raise SystemExit(f"{name}: {len(bits)} bits of glyphs, offsets are 16-bit")
+    # One spare byte: a row is read as the two bytes it may straddle
+    bitmap = bytearray((len(bits) + 7) // 8 + 1)
+    for i, b in enumerate(bits):
+        if b:
+            bitmap[i >> 3] |= 0x80 >> (i & 7)
+
+    codes = [g.code for g in glyphs]
+    fallback = default if default in codes else (32 if 32 in codes else codes[0])
+
+    size = len(bitmap) + 3 * len(ranges) + (0 if monospace else 4 * len(glyphs))
+    cells = f"{glyphs[0].width}x{height} cells" if monospace else f"{height} rows, variable width"
+    lines = [f'// {name}: {entry["source"]}, {len(glyphs)} glyphs, {cells}, {size} bytes']
+    if 'if' in entry:
+        lines.append(f'#if {entry["if"]}')
+
+    lines.append(f'static const uint8_t {name}_BITMAP[] PROGMEM = {{')
+    for start in range(0, len(bitmap), 16):
+        lines.append('    ' + ', '.join(f'0x{b:02X}' for b in bitmap[start:start + 16]) + ',')
+    lines.append('};')
+
+    lines.append(f'static const FontRange {name}_RANGES[] PROGMEM = {{')
+    for first, last, index in ranges:
+        lines.append(f'    {{{first}, {last}, {index}}},')
+    lines.append('};')
+
+    table = 'nullptr'
+    width = advance = 0
+    if monospace:
+        width, advance = glyphs[0].width, glyphs[0].advance
+    else:
+        table = f'{name}_GLYPHS'
+        lines.append(f'static const FontGlyph {table}[] PROGMEM = {{')
+        for g, offset in zip(glyphs, offsets):
+            lines.append(f'    {{{offset}, {g.width}, {g.advance}}}, // {char_comment(g)}')
+        lines.append('};')
+
+    lines.append(f'const Font {name} = {{{name}_BITMAP, {table}, {name}_RANGES, '
+                 f'{len(ranges)}, {height}, {width}, {advance}, {codes.index(fallback)}}};')
+    if 'if' in entry:
+        lines.append('#endif')
+    lines.append('')
+    return lines, size
+
+def reverse_bits(b):
+    return int(f'{b:08b}'[::-1], 2)
+
+def load_manifest(path):
+    with open(path) as f:
+        return json.load(f)['fonts']
+
+def generate(manifest, out):
+    """Write the declarations to out and the atlases next to it as a .cpp"""
+    header = os.path.basename(out)
+    guard = header.upper().replace('.', '_')
+    source = os.path.splitext(out)[0] + '.cpp'
+    banner = [
+        '/**',
+        ' * MAX7219 Fonts',
+        ' *',
+        f' * Generated by scripts/gen_font.py from {os.path.relpath(manifest, ROOT)} - do not edit',
+    ]
+
+    decls = banner + [
+        ' * Packed glyph atlases (layout in font.h) and the row bit-order tables',
+        ' */',
+        '',
+        f'#ifndef {guard}',
+        f'#define {guard}',
+        '',
+        '#include "font.h"',
+        '',
+    ]
+    defs = banner + [
+        ' */',
+        '',
+        f'#include "{header}"',
+        '',
+    ]
+
+    for entry in load_manifest(manifest):
+        font, size = emit(entry)
+        if 'if' in entry:
+            decls.append(f'#if {entry["if"]}')
+        summary = font[0].split(': ', 1)[1]
+        decls.append(f'extern const Font {entry["name"]};{" " * max(1, 12 - len(entry["name"]))}// {summary}')
+        if 'if' in entry:
+            decls.append('#endif')
+        defs.extend(font[1:])
+        print(f"{entry['name']}: {size} bytes")
+
+    decls.append('')
+    decls.append('// Row byte as written to the chip: [0] upright, [1] flipped (bit order reversed)')
+    decls.append('extern const uint8_t ROW_BIT_ORDER[2][256];')
+    decls.append('')
+    decls.append(f'#endif // {guard}')
+
+    # [0] = identity, [1] = bit-reversed; indexed by the rotation flag
+    defs.append('const uint8_t ROW_BIT_ORDER[2][256] PROGMEM = {')
+    for table in (lambda b: b, reverse_bits):
+        defs.append('    {')
+        for start in range(0, 256, 16):
+            cells = ', '.join(f'0x{table(b):02X}' for b in range(start, start + 16))
+            defs.append(f'        {cells},')
+        defs.append('    },')
+    defs.append('};')
+
+    for path, lines in ((out, decls), (source, defs)):
+        with open(path, 'w') as f:
+            f.write('\n'.join(lines) + '\n')
+        print(f"Wrote {os.path.relpath(path, ROOT)}")
+
+def dump(manifest, name):
+    entries = [e for e in load_manifest(manifest) if e['name'] == name]
+    if not entries:
+        raise SystemExit(f"{name} is not in {os.path.relpath(manifest, ROOT)}")
+    glyphs, _, _, _ = compile_font(entries[0])
+    for g in glyphs:
+        print(f"{char_comment(g)} (width {g.width}, advance {g.advance})")
+        for row in g.rows:
+            print('  ' + ''.join('#' if (row >> (g.width - 1 - x)) & 1 else '.' for x in range(g.width)))
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Compile fonts into MAX7219 glyph atlases")
+    parser.add_argument('manifest', nargs='?', default=os.path.join(FONTS, 'fonts.json'))
+    parser.add_argument('-o', '--output', default=os.path.join(ROOT, 'src', 'max7219_font.h'))
+    parser.add_argument('--dump', metavar='NAME', help="print a font's glyphs instead of writing the header")
+    args = parser.parse_args()
+    if args.dump:
+        dump(args.manifest, args.dump)
+    else:
+        generate(args.manifest, args.output)
@@ -0,0 +1,85 @@
+"""
+Query the clock's NTP server from a PC on the same network
+
+    python3 scripts/ntp_query.py 192.168.1.50            # 4 queries, 2 s apart
+    python3 scripts/ntp_query.py 192.168.1.50 -n 12 -i 0 # back to back, trips the rate limit
+
+Same check as `ntpdate -q 192.168.1.50`, with the header fields spelled out
+"""
+
+import argparse
+import socket
+import struct
+import time
+
+NTP_UNIX_OFFSET = 2208988800
+
+def to_ntp(t):
+    seconds = int(t) + NTP_UNIX_OFFSET
+    fraction = int((t % 1) * 2**32)
+    return struct.pack('!II', seconds, fraction)
+
+def from_ntp(data):
+    seconds, fraction = struct.unpack('!II', data)
+    return seconds - NTP_UNIX_OFFSET + fraction / 2**32
+
+def from_short(data):
+    return struct.unpack('!I', data)[0] / 2**16
+
+def query(host, port, timeout):
+    client = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    client.settimeout(timeout)
+    try:
+        t1 = time.time()
+        request = b'\x23' + b'\0' * 39 + to_ntp(t1)  # Version 4, mode 3
+        client.sendto(request, (host, port))
+        data, _ = client.recvfrom(1024)
+        t4 = time.time()
+    except socket.timeout:
+        return None
+    finally:
+        client.close()
+
+    if len(data) < 48 or data[24:32] != request[40:48]:
+        print("❌ Reply doesn't echo our transmit timestamp")
+        return None
+
+    t2 = from_ntp(data[32:40])
+    t3 = from_ntp(data[40:48])
+    return {
+        'leap': data[0] >> 6,
+        'version': (data[0] >> 3) & 7,
+        'mode': data[0] & 7,
+        'stratum': data[1],
+        'precision': struct.unpack('!b', data[3:4])[0],
+        'root_delay': from_short(data[4:8]),
+        'root_dispersion': from_short(data[8:12]),
+        'ref_id': '.'.join(str(b) for b in data[12:16]),
+        'offset': ((t2 - t1) + (t3 - t4)) / 2,
+        'delay': (t4 - t1) - (t3 - t2),
+    }
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Query an NTP server")
+    parser.add_argument('host')
+    parser.add_argument('-p', '--port', type=int, default=123)
+    parser.add_argument('-n', '--count', type=int, default=4)
+    parser.add_argument('-i', '--interval', type=float, default=2.0)
+    parser.add_argument('-t', '--timeout', type=float, default=1.0)
+    args = parser.parse_args()
+
+    answered = 0
+    for i in range(args.count):
+        r = query(args.host, args.port, args.timeout)
+        if r is None:
+            print(f"{i + 1:3}: no reply (rate limited or not serving)")
+        else:
+            answered += 1
+            status = "✅" if r['leap'] != 3 and r['stratum'] < 16 else "⚠️ unsynchronized"
+            print(f"{i + 1:3}: {status} stratum {r['stratum']} ref {r['ref_id']} "
+                  f"offset {r['offset'] * 1000:+.1f} ms delay {r['delay'] * 1000:.1f} ms "
+                  f"root delay {r['root_delay'] * 1000:.0f} ms dispersion {r['root_dispersion'] * 1000:.0f} ms")
+        if i + 1 < args.count:
+            time.sleep(args.interval)
+
+    print(f"{answered}/{args.count} answered")
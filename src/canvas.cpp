@@ -0,0 +1,225 @@
+/**
+ * Canvas Implementation
+ *
+ * Every drawing call ends in blitRow(): clip the run to the clip
+ * rectangle as a mask, then apply it to the (at most two) words it spans
+ */
+
+#include "canvas.h"
+
+#include <string.h>
+
+Canvas::Canvas(uint32_t* words, uint16_t width, uint8_t height)
+    : _words(words), _width(width), _height(height), _stride(CANVAS_STRIDE(width)) {
+    memset(_words, 0, sizeof(uint32_t) * _stride * _height);
+    resetClip();
+    clearDirty();
+}
+
+void Canvas::setClip(int16_t x, int16_t y, int16_t width, int16_t height) {
+    int16_t x1 = x + width;
+    int16_t y1 = y + height;
+    if (x < 0) x = 0;
+    if (y < 0) y = 0;
+    if (x1 > (int16_t)_width) x1 = _width;
+    if (y1 > (int16_t)_height) y1 = _height;
+
+    _clip.x = x;
+    _clip.y = y;
+    _clip.width = x1 > x ? x1 - x : 0;
+    _clip.height = y1 > y ? y1 - y : 0;
+}
+
+void Canvas::resetClip() {
+    setClip(0, 0, _width, _height);
+}
+
+void Canvas::clear() {
+    clearRect(_clip.x, _clip.y, _clip.width, _clip.height);
+}
+
+void Canvas::setPixel(int16_t x, int16_t y, bool on) {
+    blitRow(x, y, on ? 0x80000000UL : 0, 1, BLIT_COPY);
+}
+
+bool Canvas::getPixel(int16_t x, int16_t y) const {
+    if (x < 0 || y < 0 || x >= (int16_t)_width || y >= (int16_t)_height) {
+        return false;
+    }
+    return _words[y * _stride + (x >> 5)] & (0x80000000UL >> (x & 31));
+}
+
+void Canvas::fillRect(int16_t x, int16_t y, int16_t width, int16_t height, BlitOp op) {
+    for (int16_t row = y; row < y + height; row++) {
+        for (int16_t col = x; col < x + width; col += 32) {
+            int16_t run = x + width - col;
+            blitRow(col, row, 0xFFFFFFFFUL, run > 32 ? 32 : (uint8_t)run, op);
+        }
+    }
+}
+
+void Canvas::clearRect(int16_t x, int16_t y, int16_t width, int16_t height) {
+    for (int16_t row = y; row < y + height; row++) {
+        for (int16_t col = x; col < x + width; col += 32) {
+            int16_t run = x + width - col;
+            blitRow(col, row, 0, run > 32 ? 32 : (uint8_t)run, BLIT_COPY);
+        }
+    }
+}
+
+bool Canvas::applyWord(uint32_t& word, uint32_t bits, uint32_t mask, BlitOp op) {
+    uint32_t before = word;
+    bits &= mask;
+    if (op == BLIT_COPY) {
+        word = (word & ~mask) | bits;
+    } else if (op == BLIT_OR) {
+        word |= bits;
+    } else {
+        word ^= bits;
+    }
+    return word != before;
+}
+
+void Canvas::blitRow(int16_t x, int16_t y, uint32_t bits, uint8_t width, BlitOp op) {
+    if (width == 0 || y < _clip.y || y >= _clip.y + _clip.height) {
+        return;
+    }
+    if (width > 32) width = 32;
+
+    // Columns of the run inside the clip
+    int16_t x0 = x > _clip.x ? x : _clip.x;
+    int16_t x1 = x + width;
+    if (x1 > _clip.x + _clip.width) x1 = _clip.x + _clip.width;
+    if (x0 >= x1) {
+        return;
+    }
+
+    // Mask relative to the run, bit 31 = column x
+    uint32_t mask = 0xFFFFFFFFUL >> (x0 - x);
+    if (x1 - x < 32) {
+        mask &= ~(0xFFFFFFFFUL >> (x1 - x));
+    }
+
+    // Realign to column x0 (never negative), then split across two words if needed
+    bits <<= (x0 - x);
+    mask <<= (x0 - x);
+    uint32_t* row = &_words[y * _stride];
+    uint8_t word = x0 >> 5;
+    uint8_t shift = x0 & 31;
+
+    bool changed = applyWord(row[word], bits >> shift, mask >> shift, op);
+    if (shift && word + 1 < _stride) {
+        changed |= applyWord(row[word + 1], bits << (32 - shift), mask << (32 - shift), op);
+    }
+
+    if (changed) {
+        addDirty(x0, y, x1 - x0);
+    }
+}
+
+void Canvas::blit(const uint8_t* bitmap, uint16_t width, uint8_t height, int16_t x, int16_t y, BlitOp op) {
+    uint16_t rowBytes = (width + 7) / 8;
+    for (uint8_t row = 0; row < height; row++) {
+        const uint8_t* src = bitmap + row * rowBytes;
+
+        // Four bytes per blit
+        for (uint16_t byte = 0; byte < rowBytes; byte += 4) {
+            uint32_t bits = 0;
+            for (uint8_t i = 0; i < 4 && byte + i < rowBytes; i++) {
+                bits |= (uint32_t)src[byte + i] << (24 - 8 * i);
+            }
+            uint16_t run = width - byte * 8;
+            blitRow(x + byte * 8, y + row, bits, run > 32 ? 32 : (uint8_t)run, op);
+        }
+    }
+}
+
+void Canvas::drawSprite(const Sprite& sprite, int16_t x, int16_t y, BlitOp op) {
+    uint16_t rowBytes = (sprite.width + 7) / 8;
+    for (uint8_t row = 0; row < sprite.height; row++) {
+        const uint8_t* src = sprite.bits + row * rowBytes;
+
+        for (uint16_t byte = 0; byte < rowBytes; byte += 4) {
+            uint32_t bits = 0;
+            for (uint8_t i = 0; i < 4 && byte + i < rowBytes; i++) {
+                bits |= (uint32_t)pgm_read_byte(&src[byte + i]) << (24 - 8 * i);
+            }
+            uint16_t run = sprite.width - byte * 8;
+            blitRow(x + byte * 8, y + row, bits, run > 32 ? 32 : (uint8_t)run, op);
+        }
+    }
+}
+
+int16_t Canvas::drawText(const char* text, const Font& font, int16_t x, int16_t y, BlitOp op) {
+    FontGlyph glyph;
+    while (*text && x < _clip.x + _clip.width) {
+        fontGlyph(font, (uint8_t)*text++, glyph);
+        for (uint8_t row = 0; row < font.height; row++) {
+            blitRow(x, y + row, (uint32_t)fontRow(font, glyph, row) << 24, glyph.advance, op);
+        }
+        x += glyph.advance;
+    }
+    return x;
+}
+
+uint8_t Canvas::readByte(int16_t x, int16_t y) const {
+    if (y < 0 || y >= (int16_t)_height || x >= (int16_t)_width || x <= -8) {
+        return 0;
+    }
+
+    // Columns left of the canvas read blank
+    uint8_t lead = 0;
+    if (x < 0) {
+        lead = -x;
+        x = 0;
+    }
+
+    const uint32_t* row = &_words[y * _stride];
+    uint8_t word = x >> 5;
+    uint8_t shift = x & 31;
+    uint32_t bits = row[word] << shift;
+    if (shift > 24 && word + 1 < _stride) {
+        bits |= row[word + 1] >> (32 - shift);
+    }
+
+    uint8_t value = (uint8_t)(bits >> 24) >> lead;
+
+    // Columns right of the canvas read blank
+    if (x + 8 - lead > (int16_t)_width) {
+        value &= (uint8_t)(0xFF << (x + 8 - lead - _width));
+    }
+    return value;
+}
+
+void Canvas::addDirty(int16_t x, int16_t y, int16_t width) {
+    if (_dirty.width == 0) {
+        _dirty.x = x;
+        _dirty.y = y;
+        _dirty.width = width;
+        _dirty.height = 1;
+        return;
+    }
+
+    int16_t x1 = _dirty.x + _dirty.width;
+    int16_t y1 = _dirty.y + _dirty.height;
+    if (x < _dirty.x) _dirty.x = x;
+    if (y < _dirty.y) _dirty.y = y;
+    if (x + width > x1) x1 = x + width;
+    if (y + 1 > y1) y1 = y + 1;
+    _dirty.width = x1 - _dirty.x;
+    _dirty.height = y1 - _dirty.y;
+}
+
+void Canvas::markAllDirty() {
+    _dirty.x = 0;
+    _dirty.y = 0;
+    _dirty.width = _width;
+    _dirty.height = _height;
+}
+
+void Canvas::clearDirty() {
+    _dirty.x = 0;
+    _dirty.y = 0;
+    _dirty.width = 0;
+    _dirty.height = 0;
+}
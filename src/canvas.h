@@ -0,0 +1,140 @@
+/**
+ * Canvas Header
+ *
+ * One-bit pixel canvas shared by the display drivers: rows of 32-bit
+ * words, leftmost pixel in the MSB of each word. Drawing goes through
+ * row blits (copy, OR, XOR) limited to a clip rectangle, and the canvas
+ * keeps the bounding box of what changed so a driver's present() can
+ * push just that region
+ */
+
+#ifndef CANVAS_H
+#define CANVAS_H
+
+#include <stdint.h>
+#include "font.h"
+
+// Words per row for a canvas width
+#define CANVAS_STRIDE(width) (((width) + 31) / 32)
+
+enum BlitOp : uint8_t {
+    BLIT_COPY,  // Source replaces the pixels it covers, blanks included
+    BLIT_OR,    // Source pixels turn on, the rest are left alone
+    BLIT_XOR    // Source pixels invert what is there
+};
+
+struct CanvasRect {
+    int16_t x;
+    int16_t y;
+    int16_t width;
+    int16_t height;
+};
+
+/**
+ * Bitmap in PROGMEM: rows top first, (width + 7) / 8 bytes each,
+ * leftmost pixel in the MSB
+ */
+struct Sprite {
+    const uint8_t* bits;
+    uint8_t width;
+    uint8_t height;
+};
+
+class Canvas {
+public:
+    /**
+     * @param words Pixel storage, height * CANVAS_STRIDE(width) words, owned by the caller
+     */
+    Canvas(uint32_t* words, uint16_t width, uint8_t height);
+
+    uint16_t getWidth() const { return _width; }
+    uint8_t getHeight() const { return _height; }
+
+    /**
+     * Limit drawing to a rectangle (trimmed to the canvas)
+     */
+    void setClip(int16_t x, int16_t y, int16_t width, int16_t height);
+    void resetClip();
+    const CanvasRect& getClip() const { return _clip; }
+
+    /**
+     * Blank the clip rectangle
+     */
+    void clear();
+
+    void setPixel(int16_t x, int16_t y, bool on);
+    bool getPixel(int16_t x, int16_t y) const;
+
+    /**
+     * Turn a rectangle on (BLIT_COPY/BLIT_OR) or invert it (BLIT_XOR)
+     */
+    void fillRect(int16_t x, int16_t y, int16_t width, int16_t height, BlitOp op = BLIT_COPY);
+
+    /**
+     * Blank a rectangle
+     */
+    void clearRect(int16_t x, int16_t y, int16_t width, int16_t height);
+
+    /**
+     * Draw up to 32 pixels of one row
+     * @param bits Pixels, leftmost in the MSB
+     * @param width Pixels of bits to use (1-32)
+     */
+    void blitRow(int16_t x, int16_t y, uint32_t bits, uint8_t width, BlitOp op);
+
+    /**
+     * Draw a bitmap held in RAM (same layout as Sprite)
+     */
+    void blit(const uint8_t* bitmap, uint16_t width, uint8_t height, int16_t x, int16_t y, BlitOp op);
+
+    /**
+     * Draw a PROGMEM sprite
+     */
+    void drawSprite(const Sprite& sprite, int16_t x, int16_t y, BlitOp op = BLIT_OR);
+
+    /**
+     * Draw text with a font atlas, one glyph cell (spacing included) per character
+     * @return Column after the last glyph
+     */
+    int16_t drawText(const char* text, const Font& font, int16_t x, int16_t y, BlitOp op = BLIT_OR);
+
+    /**
+     * 8 pixels of a row starting at any column, leftmost in the MSB (blank off the canvas)
+     * For drivers whose hardware takes bytes
+     */
+    uint8_t readByte(int16_t x, int16_t y) const;
+
+    /**
+     * Check if anything changed since clearDirty()
+     */
+    bool isDirty() const { return _dirty.width > 0; }
+
+    /**
+     * Bounding box of the pixels changed since clearDirty()
+     */
+    const CanvasRect& getDirty() const { return _dirty; }
+
+    /**
+     * Mark the whole canvas changed (e.g. the display was overwritten by other output)
+     */
+    void markAllDirty();
+    void clearDirty();
+
+private:
+    uint32_t* _words;
+    uint16_t _width;
+    uint8_t _height;
+    uint8_t _stride;        // Words per row
+    CanvasRect _clip;
+    CanvasRect _dirty;
+
+    /**
+     * Combine masked bits into one word
+     * @return true if the word changed
+     */
+    bool applyWord(uint32_t& word, uint32_t bits, uint32_t mask, BlitOp op);
+
+    void addDirty(int16_t x, int16_t y, int16_t width);
+};
+
+#endif // CANVAS_H
@@ -0,0 +1,111 @@
+/**
+ * Civil Time Header
+ *
+ * Allocation-free conversion between day counts and Gregorian dates
+ * after Howard Hinnant's days_from_civil / civil_from_days
+ * Everything is constexpr (C++11 single-expression form) so tables and
+ * tests can be evaluated at compile time
+ */
+
+#ifndef CIVIL_TIME_H
+#define CIVIL_TIME_H
+
+#include <stdint.h>
+
+#define SECONDS_PER_DAY 86400UL
+
+/**
+ * Gregorian calendar date
+ */
+struct CivilDate {
+    int32_t year;
+    uint8_t month;    // 1-12
+    uint8_t day;      // 1-31
+    uint8_t weekday;  // 0 = Sunday
+};
+
+namespace civil_detail {
+
+// Years start on March 1 so the leap day is the last day of the year
+constexpr int32_t shiftedYear(int32_t y, uint32_t m) { return m <= 2 ? y - 1 : y; }
+constexpr int32_t eraOfYear(int32_t y) { return (y >= 0 ? y : y - 399) / 400; }
+constexpr uint32_t dayOfShiftedYear(uint32_t m, uint32_t d) {
+    return (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+}
+constexpr uint32_t dayOfEra(uint32_t yoe, uint32_t doy) { return yoe * 365 + yoe / 4 - yoe / 100 + doy; }
+constexpr int32_t daysFromShifted(int32_t y, uint32_t m, uint32_t d) {
+    return eraOfYear(y) * 146097 +
+           (int32_t)dayOfEra((uint32_t)(y - eraOfYear(y) * 400), dayOfShiftedYear(m, d)) - 719468;
+}
+
+constexpr int32_t eraOfDays(int32_t z) { return (z >= 0 ? z : z - 146096) / 146097; }
+constexpr uint32_t yearOfEra(uint32_t doe) { return (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365; }
+constexpr uint32_t dayOfYear(uint32_t doe, uint32_t yoe) { return doe - (365 * yoe + yoe / 4 - yoe / 100); }
+constexpr uint32_t monthIndex(uint32_t doy) { return (5 * doy + 2) / 153; }  // 0 = March
+constexpr uint8_t monthOf(uint32_t mp) { return (uint8_t)(mp < 10 ? mp + 3 : mp - 9); }
+constexpr uint8_t dayOf(uint32_t doy, uint32_t mp) { return (uint8_t)(doy - (153 * mp + 2) / 5 + 1); }
+
+constexpr CivilDate fromDoy(int32_t z, int32_t y, uint32_t doy) {
+    return CivilDate{y + (monthOf(monthIndex(doy)) <= 2), monthOf(monthIndex(doy)),
+                     dayOf(doy, monthIndex(doy)),
+                     (uint8_t)(z >= -4 ? (z + 4) % 7 : (z + 5) % 7 + 6)};
+}
+constexpr CivilDate fromDoe(int32_t z, int32_t era, uint32_t doe) {
+    return fromDoy(z, (int32_t)yearOfEra(doe) + era * 400, dayOfYear(doe, yearOfEra(doe)));
+}
+constexpr CivilDate fromShifted(int32_t z, int32_t zs) {
+    return fromDoe(z, eraOfDays(zs), (uint32_t)(zs - eraOfDays(zs) * 146097));
+}
+
+}  // namespace civil_detail
+
+/**
+ * Days since 1970-01-01 for a proleptic Gregorian date
+ * @param y Year
+ * @param m Month (1-12)
+ * @param d Day (1-31)
+ */
+constexpr int32_t daysFromCivil(int32_t y, uint32_t m, uint32_t d) {
+    return civil_detail::daysFromShifted(civil_detail::shiftedYear(y, m), m, d);
+}
+
+/**
+ * Gregorian date for a day count since 1970-01-01
+ */
+constexpr CivilDate civilFromDays(int32_t days) {
+    return civil_detail::fromShifted(days, days + 719468);
+}
+
+constexpr bool isLeapYear(int32_t y) {
+    return (y % 4 == 0 && y % 100 != 0) || y % 400 == 0;
+}
+
+constexpr uint8_t daysInMonth(int32_t y, uint8_t m) {
+    return m == 2 ? (isLeapYear(y) ? 29 : 28) : (m == 4 || m == 6 || m == 9 || m == 11) ? 30 : 31;
+}
+
+/**
+ * Date of a Unix time, recomputed only when the day changes
+ */
+class CivilDateMemo {
+public:
+    CivilDateMemo() : _days(-1), _date(civilFromDays(0)) {}
+
+    /**
+     * @param epoch Seconds since 1970-01-01 (local or UTC, as the caller keeps it)
+     */
+    const CivilDate& get(uint32_t epoch) {
+        int32_t days = (int32_t)(epoch / SECONDS_PER_DAY);
+        if (days != _days) {
+            _date = civilFromDays(days);
+            _days = days;
+        }
+        return _date;
+    }
+
+private:
+    int32_t _days;  // Day the memo holds (-1 = none)
+    CivilDate _date;
+};
+
+#endif // CIVIL_TIME_H
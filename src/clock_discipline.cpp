@@ -0,0 +1,156 @@
+/**
+ * Clock Discipline Implementation
+ *
+ * Frequency error = offset accumulated since the last correction / interval
+ * The first updates apply the full error, later ones a quarter of it so
+ * network jitter averages out
+ */
+
+#include "clock_discipline.h"
+
+ClockDiscipline::ClockDiscipline() : _freqPpb(0) {
+    reset();
+}
+
+DisciplineResult ClockDiscipline::sample(int64_t offsetMs, int32_t pendingSlewMs, uint32_t intervalMs) {
+    DisciplineResult result;
+    result.step = offsetMs > CLOCK_STEP_THRESHOLD_MS || offsetMs < -CLOCK_STEP_THRESHOLD_MS;
+    result.freqErrorPpb = 0;
+
+    if (intervalMs >= CLOCK_FLL_MIN_INTERVAL_MS) {
+        // Offset that built up since the last correction was fully applied
+        int64_t driftMs = offsetMs - pendingSlewMs;
+        int64_t errorPpb = driftMs * 1000000000LL / intervalMs;
+
+        // Anything beyond twice the tolerance is a time error, not a rate error
+        if (errorPpb <= 2 * CLOCK_MAX_FREQ_PPB && errorPpb >= -2 * CLOCK_MAX_FREQ_PPB) {
+            int32_t change = (int32_t)(_updates < 2 ? errorPpb : errorPpb / 4);
+            setFrequencyPpb(_freqPpb + change);
+            result.freqErrorPpb = (int32_t)errorPpb;
+
+            if (change <= CLOCK_LOCK_TOLERANCE_PPB && change >= -CLOCK_LOCK_TOLERANCE_PPB) {
+                if (_stableCount < 255) _stableCount++;
+            } else {
+                _stableCount = 0;
+            }
+            if (_updates < 255) _updates++;
+        }
+    }
+
+    result.freqPpb = _freqPpb;
+    return result;
+}
+
+void ClockDiscipline::setFrequencyPpb(int32_t ppb) {
+    if (ppb > CLOCK_MAX_FREQ_PPB) ppb = CLOCK_MAX_FREQ_PPB;
+    if (ppb < -CLOCK_MAX_FREQ_PPB) ppb = -CLOCK_MAX_FREQ_PPB;
+    _freqPpb = ppb;
+}
+
+void ClockDiscipline::reset() {
+    _updates = 0;
+    _stableCount = 0;
+}
+
+PollController::PollController(uint8_t minPoll, uint8_t maxPoll, uint8_t unlockedMaxPoll)
+    : _minPoll(minPoll), _maxPoll(maxPoll), _unlockedMaxPoll(unlockedMaxPoll) {
+    if (_maxPoll > POLL_EXPONENT_CAP) _maxPoll = POLL_EXPONENT_CAP;
+    if (_minPoll > _maxPoll) _minPoll = _maxPoll;
+    if (_unlockedMaxPoll > _maxPoll) _unlockedMaxPoll = _maxPoll;
+    if (_unlockedMaxPoll < _minPoll) _unlockedMaxPoll = _minPoll;
+    reset();
+}
+
+void PollController::update(int64_t offsetMs, uint32_t jitterMs, bool stepped, bool locked) {
+    if (stepped) {
+        reset();
+        return;
+    }
+
+    bool good = offsetMs <= POLL_OFFSET_TOLERANCE_MS && offsetMs >= -POLL_OFFSET_TOLERANCE_MS &&
+                jitterMs <= POLL_JITTER_TOLERANCE_MS;
+    uint8_t ceiling = locked ? _maxPoll : _unlockedMaxPoll;
+
+    if (good) {
+        _counter += _exponent;
+        if (_counter >= POLL_COUNTER_LIMIT) {
+            _counter = 0;
+            if (_exponent < ceiling) _exponent++;
+        }
+    } else {
+        _counter -= 2 * _exponent;
+        if (_counter <= -POLL_COUNTER_LIMIT) {
+            _counter = 0;
+            if (_exponent > _minPoll) _exponent--;
+        }
+    }
+
+    // Lost lock since the exponent grew
+    if (_exponent > ceiling) {
+        _exponent = ceiling;
+        _counter = 0;
+    }
+}
+
+void PollController::reset() {
+    _exponent = _minPoll;
+    _counter = 0;
+}
+
+AgingCalibrator::AgingCalibrator() {
+    reset();
+}
+
+bool AgingCalibrator::sample(int64_t offsetMs, uint32_t intervalMs) {
+    if (!_started || intervalMs == 0) {
+        start(offsetMs);
+        return false;
+    }
+
+    // Offsets build up between writes: only the change since the last one is new
+    int64_t change = offsetMs - _phaseMs;
+    int64_t ppb = change * 1000000000LL / intervalMs;
+    if (ppb > RTC_CAL_MAX_DRIFT_PPB || ppb < -RTC_CAL_MAX_DRIFT_PPB) {
+        start(offsetMs);  // Not drift: measure again from here
+        return false;
+    }
+
+    _changeMs = change;
+    _driftMs += change;
+    _baselineMs += intervalMs;
+    _writeDue = offsetMs >= RTC_CAL_WRITE_MS || offsetMs <= -RTC_CAL_WRITE_MS;
+    _phaseMs = _writeDue ? 0 : offsetMs;
+    return _baselineMs >= RTC_CAL_BASELINE_MS;
+}
+
+int32_t AgingCalibrator::getDriftPpb() const {
+    if (_baselineMs == 0) return 0;
+    // A fast RTC is ahead of the server, so its offsets are negative
+    return (int32_t)(-_driftMs * 1000000000LL / (int64_t)_baselineMs);
+}
+
+int8_t AgingCalibrator::agingFor(int8_t current) const {
+    int32_t drift = getDriftPpb();
+    int32_t lsb = (drift + (drift >= 0 ? RTC_AGING_PPB_PER_LSB / 2 : -RTC_AGING_PPB_PER_LSB / 2)) /
+                  RTC_AGING_PPB_PER_LSB;
+    int32_t aging = current + lsb;
+    if (aging > 127) aging = 127;
+    if (aging < -128) aging = -128;
+    return (int8_t)aging;
+}
+
+void AgingCalibrator::reset() {
+    _driftMs = 0;
+    _phaseMs = 0;
+    _changeMs = 0;
+    _baselineMs = 0;
+    _started = false;
+    _writeDue = false;
+}
+
+void AgingCalibrator::start(int64_t offsetMs) {
+    reset();
+    _changeMs = offsetMs;
+    _started = true;
+    _writeDue = true;
+}
@@ -0,0 +1,214 @@
+/**
+ * Clock Discipline Header
+ *
+ * Frequency-locked loop for the software clock
+ * Estimates the local oscillator's frequency error from successive NTP
+ * offsets and decides whether a correction is slewed or stepped,
+ * plus the adaptive poll interval that follows from clock stability
+ * and the aging offset trim for a DS3231, whose rate we can't steer per sync
+ */
+
+#ifndef CLOCK_DISCIPLINE_H
+#define CLOCK_DISCIPLINE_H
+
+#include <stdint.h>
+
+// Offsets larger than this are stepped, smaller ones are slewed (ntpd default)
+#ifndef CLOCK_STEP_THRESHOLD_MS
+#define CLOCK_STEP_THRESHOLD_MS 128
+#endif
+
+// Largest frequency correction we will ever apply
+#define CLOCK_MAX_FREQ_PPB 500000   // 500 ppm
+
+// Rate at which slewed corrections are applied
+#define CLOCK_SLEW_PPB 500000       // 0.5 ms per second
+
+// Shortest interval that gives a usable frequency measurement
+#define CLOCK_FLL_MIN_INTERVAL_MS 60000
+
+// Frequency updates before the loop counts as locked
+#define CLOCK_LOCK_SAMPLES 4
+
+// Frequency changes below this count toward lock
+#define CLOCK_LOCK_TOLERANCE_PPB 2000   // 2 ppm
+
+// Poll adjustment: offsets and jitter within these let the interval grow
+#define POLL_OFFSET_TOLERANCE_MS 25
+#define POLL_JITTER_TOLERANCE_MS 50
+
+// Hysteresis counter limit (ntpd's LIMIT)
+#define POLL_COUNTER_LIMIT 30
+
+// Largest exponent whose interval in ms fits 32 bits
+#define POLL_EXPONENT_CAP 22
+
+// DS3231 aging offset: one LSB moves the frequency by about 0.1 ppm at 25 C,
+// positive values slow the oscillator down
+#define RTC_AGING_PPB_PER_LSB 100
+
+// Drift is averaged over at least this long before the aging offset is changed
+#ifndef RTC_CAL_BASELINE_MS
+#define RTC_CAL_BASELINE_MS 86400000UL  // 24 hours
+#endif
+
+// A sample implying more drift than this is a time error (e.g. RTC reset)
+#define RTC_CAL_MAX_DRIFT_PPB 20000    // 20 ppm, the DS3231 is specified to 2 ppm
+
+// Phase error the RTC is left to build up before it is rewritten; kept below
+// CLOCK_STEP_THRESHOLD_MS so every step is also a write the calibrator knows of
+#ifndef RTC_CAL_WRITE_MS
+#define RTC_CAL_WRITE_MS 100
+#endif
+
+/**
+ * What to do with a measured offset
+ */
+struct DisciplineResult {
+    bool step;            // Step the clock instead of slewing
+    int32_t freqPpb;      // Frequency correction to apply from now on
+    int32_t freqErrorPpb; // Residual frequency error seen in this sample
+};
+
+class ClockDiscipline {
+public:
+    ClockDiscipline();
+
+    /**
+     * Process one offset measurement
+     * @param offsetMs Server minus local clock
+     * @param pendingSlewMs Part of the previous correction not yet slewed in
+     * @param intervalMs Time from the previous correction to when this offset was
+     *                   measured; 0 if there was none or the offset predates it
+     *                   (such a sample neither moves the frequency nor counts toward lock)
+     * @return Action and updated frequency
+     */
+    DisciplineResult sample(int64_t offsetMs, int32_t pendingSlewMs, uint32_t intervalMs);
+
+    /**
+     * Seed the frequency (e.g. drift persisted before a reboot)
+     */
+    void setFrequencyPpb(int32_t ppb);
+    int32_t getFrequencyPpb() const { return _freqPpb; }
+
+    /**
+     * True once the frequency estimate has settled
+     */
+    bool isLocked() const { return _stableCount >= CLOCK_LOCK_SAMPLES; }
+
+    /**
+     * Forget the lock state (e.g. after a clock source change)
+     */
+    void reset();
+
+private:
+    int32_t _freqPpb;
+    uint8_t _updates;      // Frequency updates since reset
+    uint8_t _stableCount;  // Consecutive small frequency changes
+};
+
+/**
+ * Poll exponent control, after ntpd's poll adjustment
+ * Good samples add the exponent to a counter and bad ones subtract twice
+ * that; the exponent moves by one when the counter passes the limit
+ */
+class PollController {
+public:
+    /**
+     * @param minPoll Smallest exponent (interval 2^minPoll seconds)
+     * @param maxPoll Largest exponent once the clock is disciplined
+     * @param unlockedMaxPoll Largest exponent before the frequency has settled
+     */
+    PollController(uint8_t minPoll, uint8_t maxPoll, uint8_t unlockedMaxPoll);
+
+    /**
+     * Adjust after a completed sync
+     * @param offsetMs Offset that was corrected
+     * @param jitterMs Clock filter jitter
+     * @param stepped true if the clock had to be stepped
+     * @param locked true if the frequency estimate has settled
+     */
+    void update(int64_t offsetMs, uint32_t jitterMs, bool stepped, bool locked);
+
+    /**
+     * Drop back to the minimum interval (e.g. clock source changed)
+     */
+    void reset();
+
+    uint8_t getExponent() const { return _exponent; }
+    uint32_t getIntervalMs() const { return 1000UL << _exponent; }
+
+private:
+    uint8_t _minPoll;
+    uint8_t _maxPoll;
+    uint8_t _unlockedMaxPoll;
+    uint8_t _exponent;
+    int16_t _counter;
+};
+
+/**
+ * DS3231 aging offset estimation
+ * Follows the RTC's phase error against NTP over a long baseline; the
+ * average rate is converted to aging offset LSBs. Each write restarts the
+ * RTC second when the loop gets to it, a few ms late, and that lag would
+ * read as drift, so the RTC is only rewritten at the start of a baseline
+ * and once the error reaches RTC_CAL_WRITE_MS
+ */
+class AgingCalibrator {
+public:
+    AgingCalibrator();
+
+    /**
+     * Add the offset measured at one sync
+     * @param offsetMs Server minus RTC
+     * @param intervalMs Time since the previous sample (0 = none, starts the baseline)
+     * @return true once the baseline is long enough for an estimate
+     */
+    bool sample(int64_t offsetMs, uint32_t intervalMs);
+
+    /**
+     * True if the offset just sampled should be written to the RTC
+     * The offset measured after a write is taken as the change since it
+     */
+    bool needsWrite() const { return _writeDue; }
+
+    /**
+     * Change in phase error over the last interval
+     * (the correction a clock rewritten every sync would have needed)
+     */
+    int64_t getChangeMs() const { return _changeMs; }
+
+    /**
+     * Average RTC rate error over the baseline
+     * @return Parts per billion, positive if the RTC runs fast
+     */
+    int32_t getDriftPpb() const;
+
+    /**
+     * Aging offset that cancels the measured drift
+     * @param current Aging offset in effect during the baseline
+     */
+    int8_t agingFor(int8_t current) const;
+
+    uint64_t getBaselineMs() const { return _baselineMs; }
+
+    /**
+     * Start a new baseline at the next sample (after a write or a clock source change)
+     */
+    void reset();
+
+private:
+    int64_t _driftMs;      // Phase error gained over the baseline, across writes
+    int64_t _phaseMs;      // Error left in the RTC after the last sample
+    int64_t _changeMs;
+    uint64_t _baselineMs;
+    bool _started;
+    bool _writeDue;
+
+    /**
+     * Begin a baseline at the current sample, whose offset is written
+     */
+    void start(int64_t offsetMs);
+};
+
+#endif // CLOCK_DISCIPLINE_H
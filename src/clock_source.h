@@ -32,7 +32,7 @@ public:
     
     /**
      * Get current epoch time (seconds since 1970-01-01 00:00:00 UTC)
-     * @return Unix timestamp with timezone applied
+     * @return Unix timestamp (UTC)
      */
     virtual unsigned long getEpochTime() const = 0;
     
@@ -42,6 +42,57 @@ public:
      */
     virtual void setEpochTime(unsigned long epoch) = 0;
     
+    /**
+     * Get current epoch time with millisecond resolution
+     * Default implementation has whole-second resolution
+     * @return Milliseconds since 1970-01-01 00:00:00 UTC
+     */
+    virtual uint64_t getEpochMillis() const {
+        return (uint64_t)getEpochTime() * 1000ULL;
+    }
+    
+    /**
+     * Set epoch time with millisecond resolution
+     * Default implementation drops the fraction
+     * @param epochMs Milliseconds since 1970-01-01 00:00:00
+     */
+    virtual void setEpochMillis(uint64_t epochMs) {
+        setEpochTime((unsigned long)(epochMs / 1000ULL));
+    }
+    
+    /**
+     * Apply a small correction gradually instead of stepping
+     * Replaces any correction still in progress
+     * Default implementation steps
+     * @param offsetMs Amount to add to the clock
+     */
+    virtual void slew(int32_t offsetMs) {
+        setEpochMillis(getEpochMillis() + offsetMs);
+    }
+    
+    /**
+     * Part of the last slew() not yet applied
+     */
+    virtual int32_t getPendingSlewMs() const { return 0; }
+    
+    /**
+     * Rate correction for the clock's oscillator
+     * Default implementation ignores it (hardware clocks keep their own rate)
+     * @param ppb Parts per billion to add to the nominal rate
+     */
+    virtual void setFrequencyPpb(int32_t ppb) { (void)ppb; }
+    virtual int32_t getFrequencyPpb() const { return 0; }
+    
+    /**
+     * Hardware oscillator trim (the DS3231 aging offset)
+     * Clocks with a trim are calibrated over long baselines instead of
+     * through setFrequencyPpb(); default implementation has none
+     * The accessors return false when the trim can't be read or written
+     */
+    virtual bool hasAgingTrim() const { return false; }
+    virtual bool getAgingOffset(int8_t& offset) const { (void)offset; return false; }
+    virtual bool setAgingOffset(int8_t offset) { (void)offset; return false; }
+    
     /**
      * Check if clock has been set/synchronized
      * @return true if time is valid
@@ -25,8 +25,51 @@
 // NTP Configuration
 // =============================================================================
 #define NTP_SERVER "pool.ntp.org"
-#define NTP_UPDATE_INTERVAL 3600000 // 1 hour in ms
-#define UTC_OFFSET_SECONDS -28800   // PST (UTC-8), adjust for your timezone
+#define NTP_MIN_POLL 10             // Shortest poll interval: 2^10 s = 17 min
+#define NTP_MAX_POLL 14             // Longest once disciplined: 2^14 s = 4.5 hours
+#define NTP_UNLOCKED_MAX_POLL 10    // Longest while the drift is still being learned (17 min)
+#define NTP_FULL_ROUND_POLLS 8      // Every 8th poll asks all servers, the rest only the selected one
+#define NTP_REQUEST_TIMEOUT 1500    // Give up on a round's stragglers after 1.5 s
+#define NTP_DNS_TIMEOUT 2000        // Longest one server lookup may hold up the loop
+#define NTP_BURST_SAMPLES 4         // Rounds per sync while the clock filter fills
+#define NTP_QUORUM 3                // A round completes once this many servers answer
+#define NTP_DRIFT_SAVE_INTERVAL 21600000 // Persist learned clock drift at most every 6 hours
+#define NTP_SERVE_ENABLED false     // Answer NTP requests from the LAN on UDP 123
+#define NTP_SERVE_PER_PASS 4        // Most requests answered per update() so the display tick isn't held up
+#define NTP_SERVE_POLL_INTERVAL 1   // Socket check while serving (ms); T2 is taken when a request is read
+#define TIMEZONE "PST8PDT,M3.2.0,M11.1.0" // POSIX TZ string (US Pacific), adjust for your timezone
+
+// =============================================================================
+// Radio Duty Cycle
+// =============================================================================
+// NTP and weather traffic share wake windows; between them the modem sleeps,
+// staying associated so the web portal remains reachable (with some latency).
+// Always awake while serving NTP, whose requests must be stamped on arrival.
+#define RADIO_SLEEP_ENABLED true
+#define RADIO_LISTEN_INTERVAL 3        // Beacons between wakes while asleep (~300 ms at 100 TU)
+#define RADIO_EARLY_DIVISOR 4          // A job may run up to 1/4 of its interval early to share a window
+#define RADIO_PREFETCH_SLACK_MS 30000  // The pre-display weather fetch may wait this long for a window
+#define RADIO_PORTAL_HOLD_MS 10000     // Stay awake this long after a web portal request
+
+// =============================================================================
+// DS3231 RTC Configuration
+// =============================================================================
+// INT/SQW is open drain and runs at 1 Hz; its falling edge marks the second.
+// Avoid D3/D4/D8: a reset while SQW is low would change the boot mode.
+// Avoid D5-D7: SPI.begin() claims GPIO12-14 for HSPI, dropping the pull-up.
+// SD3 (GPIO10) is free on NodeMCU boards whose flash runs in DIO mode
+// (board_build.flash_mode = dio); D0 has no interrupt.
+// Set per environment in platformio.ini: the D1 mini has no SD3 pad.
+// -1 = no SQW wire, track seconds by reading the RTC over I2C instead
+#ifndef DS3231_SQW_PIN
+#define DS3231_SQW_PIN -1
+#endif
+#define DS3231_VERIFY_INTERVAL 600000  // Full register read to check the tick count every 10 min
+
+// Hybrid clock (clockSource 2): software clock for reads, DS3231 for holdover
+#define HYBRID_CHECK_INTERVAL 60000    // Probe the RTC and compare both clocks every minute
+#define HYBRID_GLITCH_MS 250           // Change in software-RTC difference between checks that means a glitch
+#define HYBRID_RTC_TOLERANCE_MS 100    // Rewrite the RTC once it has drifted this far from NTP time
 
 // =============================================================================
 // VFD Display Pin Configuration (ESP8266)
@@ -51,6 +94,8 @@
 #define VFD_NUM_DIGITS 8           // 8-MD-06INKM has 8 digits
 #define VFD_DEFAULT_BRIGHTNESS 200 // 0-240 (240 = max brightness)
 #define VFD_SPI_SPEED 1000000      // 1 MHz SPI clock
+// #define VFD_SPI_SOFT_LSB        // Reverse bits in software and clock MSB first
+                                   // (for SPI ports without LSB-first support)
 
 // =============================================================================
 // Display Update Settings
@@ -77,6 +122,7 @@
 
 // Update interval (10 minutes recommended to stay within free tier limits)
 #define WEATHER_UPDATE_INTERVAL 600000  // 10 minutes in ms
+#define WEATHER_RETRY_INTERVAL 60000    // Wait after a failed fetch before trying again
 
 // Units: "metric" for Celsius, "imperial" for Fahrenheit
 #define WEATHER_UNITS "imperial"
@@ -92,5 +138,12 @@
 #define MAX7219_PIN_DATA D7   // GPIO13 - SPI MOSI (shared with VFD)
 
 #define MAX7219_NUM_MODULES 4  // Number of 8x8 modules in chain
+#define MAX7219_SPI_SPEED 10000000  // 10 MHz SPI clock (MAX7219 maximum)
+#define MAX7219_TEXT_ALIGN TEXT_ALIGN_CENTER  // Placement of text narrower than the panel
+
+// Text too wide for the panel even condensed scrolls
+#define MAX7219_SCROLL_SPEED 20       // Columns per second
+#define MAX7219_SCROLL_HOLD_MS 1000   // Pause on the start of the text before it moves
+#define MAX7219_SCROLL_FPS 30         // Frame rate the scroll is paced at
 
 #endif // CONFIG_H
@@ -12,6 +12,7 @@
 #define CONFIG_FILE "/config.json"
 #endif
 #include <ArduinoJson.h>
+#include <stdio.h>
 
 // Debug macros
 #ifdef NATIVE_TEST
@@ -86,7 +87,7 @@ bool ConfigManager::load() {
     DEBUG_PRINTLN("ConfigManager: Config loaded successfully");
     DEBUG_PRINTF("  Device: %s\n", _config.deviceName);
     DEBUG_PRINTF("  WiFi SSID: %s\n", _config.wifiSsid);
-    DEBUG_PRINTF("  Timezone: %ld\n", _config.timezoneOffset);
+    DEBUG_PRINTF("  Timezone: %s\n", _config.timezone);
     
     return true;
 #endif
@@ -137,7 +138,10 @@ void ConfigManager::setDefaults() {
     strncpy(_config.ntpServer, NTP_SERVER, sizeof(_config.ntpServer) - 1);
     _config.ntpServer[sizeof(_config.ntpServer) - 1] = 0;
     
-    _config.timezoneOffset = UTC_OFFSET_SECONDS;
+    strncpy(_config.timezone, TIMEZONE, sizeof(_config.timezone) - 1);
+    _config.timezone[sizeof(_config.timezone) - 1] = 0;
+    _config.ntpServe = NTP_SERVE_ENABLED;
+    
     _config.brightness = VFD_DEFAULT_BRIGHTNESS;
     _config.showSeconds = true;
     _config.showActivityIndicators = true;
@@ -159,10 +163,20 @@ void ConfigManager::setDefaults() {
     
     // Clock source defaults
     _config.clockSource = 0;  // ESP8266 software clock
+    _config.clockDriftPpb = 0;  // Unknown until learned from NTP
+    _config.rtcCalTime = 0;     // DS3231 never calibrated
+    _config.rtcAgingBefore = 0;
+    _config.rtcAgingAfter = 0;
+    _config.rtcDriftBeforePpb = 0;
+    _config.rtcDriftAfterPpb = 0;
+    _config.rtcCalVerified = false;
     
     // Tilt sensor defaults
     _config.tiltSensorPin = 0;  // Disabled
     _config.autoRotate = false;
+    
+    // Power
+    _config.radioSleep = RADIO_SLEEP_ENABLED;
 }
 
 void ConfigManager::setDeviceName(const char* name) {
@@ -183,8 +197,9 @@ void ConfigManager::setNtpServer(const char* server) {
     _config.ntpServer[sizeof(_config.ntpServer) - 1] = 0;
 }
 
-void ConfigManager::setTimezoneOffset(long offset) {
-    _config.timezoneOffset = offset;
+void ConfigManager::setTimezone(const char* posix) {
+    strncpy(_config.timezone, posix, sizeof(_config.timezone) - 1);
+    _config.timezone[sizeof(_config.timezone) - 1] = 0;
 }
 
 void ConfigManager::setBrightness(uint8_t brightness) {
@@ -206,6 +221,10 @@ void ConfigManager::setWeatherUnits(const char* units) {
     _config.weatherUnits[sizeof(_config.weatherUnits) - 1] = 0;
 }
 
+void ConfigManager::setClockDriftPpb(int32_t ppb) {
+    _config.clockDriftPpb = ppb;
+}
+
 void ConfigManager::deserializeConfig(const JsonDocument& doc) {
     strncpy(_config.deviceName, doc["deviceName"] | "VFD Clock", sizeof(_config.deviceName) - 1);
     _config.deviceName[sizeof(_config.deviceName) - 1] = 0;
@@ -219,7 +238,28 @@ void ConfigManager::deserializeConfig(const JsonDocument& doc) {
     strncpy(_config.ntpServer, doc["ntpServer"] | NTP_SERVER, sizeof(_config.ntpServer) - 1);
     _config.ntpServer[sizeof(_config.ntpServer) - 1] = 0;
     
-    _config.timezoneOffset = doc["timezoneOffset"] | UTC_OFFSET_SECONDS;
+    if (doc["timezone"].is<const char*>()) {
+        strncpy(_config.timezone, doc["timezone"], sizeof(_config.timezone) - 1);
+        _config.timezone[sizeof(_config.timezone) - 1] = 0;
+    } else if (doc["timezoneOffset"].is<long>()) {
+        // Config from before TZ strings: keep the fixed offset, e.g. -28800 -> "<-08>8"
+        long offset = doc["timezoneOffset"].as<long>();
+        long hours = (offset < 0 ? -offset : offset) / 3600;
+        long minutes = ((offset < 0 ? -offset : offset) % 3600) / 60;
+        char sign = offset < 0 ? '-' : '+';
+        const char* west = offset > 0 ? "-" : "";
+        if (minutes) {
+            snprintf(_config.timezone, sizeof(_config.timezone), "<%c%02ld%02ld>%s%ld:%02ld",
+                     sign, hours, minutes, west, hours, minutes);
+        } else {
+            snprintf(_config.timezone, sizeof(_config.timezone), "<%c%02ld>%s%ld",
+                     sign, hours, west, hours);
+        }
+    } else {
+        strncpy(_config.timezone, TIMEZONE, sizeof(_config.timezone) - 1);
+        _config.timezone[sizeof(_config.timezone) - 1] = 0;
+    }
+    _config.ntpServe = doc["ntpServe"] | NTP_SERVE_ENABLED;
     _config.brightness = doc["brightness"] | VFD_DEFAULT_BRIGHTNESS;
     _config.showSeconds = doc["showSeconds"] | true;
     _config.showActivityIndicators = doc["showActivityIndicators"] | true;
@@ -241,10 +281,20 @@ void ConfigManager::deserializeConfig(const JsonDocument& doc) {
     
     // Clock source
     _config.clockSource = doc["clockSource"] | 0;
+    _config.clockDriftPpb = doc["clockDriftPpb"] | 0;
+    _config.rtcCalTime = doc["rtcCalTime"] | 0;
+    _config.rtcAgingBefore = doc["rtcAgingBefore"] | 0;
+    _config.rtcAgingAfter = doc["rtcAgingAfter"] | 0;
+    _config.rtcDriftBeforePpb = doc["rtcDriftBeforePpb"] | 0;
+    _config.rtcDriftAfterPpb = doc["rtcDriftAfterPpb"] | 0;
+    _config.rtcCalVerified = doc["rtcCalVerified"] | false;
     
     // Tilt sensor
     _config.tiltSensorPin = doc["tiltSensorPin"] | 0;
     _config.autoRotate = doc["autoRotate"] | false;
+    
+    // Power
+    _config.radioSleep = doc["radioSleep"] | RADIO_SLEEP_ENABLED;
 }
 
 void ConfigManager::serializeConfig(JsonDocument& doc) const {
@@ -252,7 +302,8 @@ void ConfigManager::serializeConfig(JsonDocument& doc) const {
     doc["wifiSsid"] = _config.wifiSsid;
     doc["wifiPassword"] = _config.wifiPassword;
     doc["ntpServer"] = _config.ntpServer;
-    doc["timezoneOffset"] = _config.timezoneOffset;
+    doc["timezone"] = _config.timezone;
+    doc["ntpServe"] = _config.ntpServe;
     doc["brightness"] = _config.brightness;
     doc["showSeconds"] = _config.showSeconds;
     doc["showActivityIndicators"] = _config.showActivityIndicators;
@@ -268,8 +319,18 @@ void ConfigManager::serializeConfig(JsonDocument& doc) const {
     
     // Clock source
     doc["clockSource"] = _config.clockSource;
+    doc["clockDriftPpb"] = _config.clockDriftPpb;
+    doc["rtcCalTime"] = _config.rtcCalTime;
+    doc["rtcAgingBefore"] = _config.rtcAgingBefore;
+    doc["rtcAgingAfter"] = _config.rtcAgingAfter;
+    doc["rtcDriftBeforePpb"] = _config.rtcDriftBeforePpb;
+    doc["rtcDriftAfterPpb"] = _config.rtcDriftAfterPpb;
+    doc["rtcCalVerified"] = _config.rtcCalVerified;
     
     // Tilt sensor
     doc["tiltSensorPin"] = _config.tiltSensorPin;
     doc["autoRotate"] = _config.autoRotate;
+    
+    // Power
+    doc["radioSleep"] = _config.radioSleep;
 }
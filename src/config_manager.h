@@ -15,6 +15,7 @@
 #define CONFIG_SSID_MAX 32
 #define CONFIG_PASSWORD_MAX 64
 #define CONFIG_API_KEY_MAX 48
+#define CONFIG_TIMEZONE_MAX 48
 
 /**
  * Runtime configuration structure
@@ -29,7 +30,8 @@ struct ClockConfig {
     
     // NTP/Time
     char ntpServer[CONFIG_STRING_MAX];
-    long timezoneOffset;  // seconds from UTC
+    char timezone[CONFIG_TIMEZONE_MAX];  // POSIX TZ string, e.g. "PST8PDT,M3.2.0,M11.1.0"
+    bool ntpServe;       // Serve time to the LAN (SNTP server on UDP 123)
     
     // Display
     uint8_t brightness;  // 0-255
@@ -50,11 +52,23 @@ struct ClockConfig {
     uint8_t weatherDurationMax;      // Random duration max (seconds, e.g., 25)
     
     // Clock source
-    uint8_t clockSource;  // 0 = ESP8266 (software), 1 = DS3231 (RTC)
+    uint8_t clockSource;  // 0 = ESP8266 (software), 1 = DS3231 (RTC), 2 = Hybrid (software + DS3231 holdover)
+    int32_t clockDriftPpb; // Learned millis() frequency correction (set by TimeManager)
+    
+    // DS3231 aging calibration record (set by TimeManager)
+    uint32_t rtcCalTime;        // UTC of the last aging offset write (0 = never)
+    int8_t rtcAgingBefore;      // Aging offset before that write
+    int8_t rtcAgingAfter;       // Aging offset written
+    int32_t rtcDriftBeforePpb;  // RTC drift that prompted the write (positive = fast)
+    int32_t rtcDriftAfterPpb;   // RTC drift over the baseline that followed
+    bool rtcCalVerified;        // rtcDriftAfterPpb has been measured
     
     // Tilt sensor / display rotation
     uint8_t tiltSensorPin;  // GPIO pin for tilt sensor (0 = disabled)
     bool autoRotate;        // Enable auto-rotation from tilt sensor
+    
+    // Power
+    bool radioSleep;        // Modem sleep between network windows (off while serving NTP)
 };
 
 /**
@@ -97,7 +111,9 @@ public:
     const char* getWifiSsid() const { return _config.wifiSsid; }
     const char* getWifiPassword() const { return _config.wifiPassword; }
     const char* getNtpServer() const { return _config.ntpServer; }
-    long getTimezoneOffset() const { return _config.timezoneOffset; }
+    const char* getTimezone() const { return _config.timezone; }
+    bool getNtpServe() const { return _config.ntpServe; }
+    bool getRadioSleep() const { return _config.radioSleep; }
     uint8_t getBrightness() const { return _config.brightness; }
     bool getShowSeconds() const { return _config.showSeconds; }
     bool getShowActivityIndicators() const { return _config.showActivityIndicators; }
@@ -110,16 +126,18 @@ public:
     uint8_t getWeatherDisplayStartMax() const { return _config.weatherDisplayStartMax; }
     uint8_t getWeatherDurationMin() const { return _config.weatherDurationMin; }
     uint8_t getWeatherDurationMax() const { return _config.weatherDurationMax; }
+    int32_t getClockDriftPpb() const { return _config.clockDriftPpb; }
     
     // Convenience setters
     void setDeviceName(const char* name);
     void setWifiCredentials(const char* ssid, const char* password);
     void setNtpServer(const char* server);
-    void setTimezoneOffset(long offset);
+    void setTimezone(const char* posix);
     void setBrightness(uint8_t brightness);
     void setWeatherApiKey(const char* key);
     void setWeatherLocation(float lat, float lon);
     void setWeatherUnits(const char* units);
+    void setClockDriftPpb(int32_t ppb);
 
     // Exposed for testing
     void deserializeConfig(const JsonDocument& doc);
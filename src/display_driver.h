@@ -9,6 +9,19 @@
 #define DISPLAY_DRIVER_H
 
 #include <Arduino.h>
+#include "canvas.h"
+
+/**
+ * Frame push counters kept by every driver
+ * Used to check that unchanged content is never re-sent
+ */
+struct DisplayStats {
+    uint32_t frames;        // Frames submitted (print/clear/refresh)
+    uint32_t framesPushed;  // Frames that changed something on the hardware
+    uint32_t bytesSent;     // Bytes clocked out over SPI
+    uint32_t transactions;  // Chip-select transactions
+    uint32_t busMicros;     // Time spent clocking bytes out
+};
 
 /**
  * Abstract display driver interface
@@ -69,6 +82,42 @@ public:
      * @return true if display is flipped 180 degrees
      */
     virtual bool isRotated() const { return false; }
+    
+    /**
+     * Forget what the hardware is showing so the next frame is sent in full
+     * Drivers keep a shadow copy of the displayed frame and only push changes
+     */
+    virtual void invalidate() {}
+    
+    /**
+     * Get the driver's pixel canvas (sized to the display)
+     * Draw into it, then call present() to show it
+     * @return Canvas, or nullptr if the display has no pixel access
+     */
+    virtual Canvas* getCanvas() { return nullptr; }
+    
+    /**
+     * Push the region of the canvas changed since the last present()
+     * Whatever print() put on the display stays outside that region
+     * (widened to whole digits on character displays)
+     */
+    virtual void present() {}
+    
+    /**
+     * Get frame push counters
+     * @return Counters since boot or last resetStats()
+     */
+    const DisplayStats& getStats() const { return _stats; }
+    
+    /**
+     * Reset frame push counters
+     */
+    void resetStats() { memset(&_stats, 0, sizeof(_stats)); }
+
+protected:
+    DisplayDriver() { resetStats(); }
+    
+    DisplayStats _stats;
 };
 
 #endif // DISPLAY_DRIVER_H
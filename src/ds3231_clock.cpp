@@ -2,13 +2,46 @@
  * DS3231 RTC Clock Implementation
  * 
  * Hardware RTC with battery backup for time persistence
+ * The 1 Hz SQW falling edge coincides with the seconds register update,
+ * so the interrupt can count seconds without touching the I2C bus
  */
 
 #include "ds3231_clock.h"
+#include "config.h"
 #include <Wire.h>
 
+// Registers RTClib doesn't expose
+#define DS3231_ADDRESS 0x68
+#define DS3231_REG_CONTROL 0x0E
+#define DS3231_REG_STATUS 0x0F
+#define DS3231_REG_AGING 0x10
+#define DS3231_CONTROL_CONV 0x20
+#define DS3231_STATUS_BSY 0x04
+
+// Both return false on a NACK or short read, leaving value untouched
+static bool readRegister(uint8_t reg, uint8_t& value) {
+    Wire.beginTransmission(DS3231_ADDRESS);
+    Wire.write(reg);
+    if (Wire.endTransmission() != 0) return false;
+    if (Wire.requestFrom((uint8_t)DS3231_ADDRESS, (uint8_t)1) != 1) return false;
+    value = Wire.read();
+    return true;
+}
+
+static bool writeRegister(uint8_t reg, uint8_t value) {
+    Wire.beginTransmission(DS3231_ADDRESS);
+    Wire.write(reg);
+    Wire.write(value);
+    return Wire.endTransmission() == 0;
+}
+
+DS3231Clock* DS3231Clock::_instance = nullptr;
+
 DS3231Clock::DS3231Clock()
-    : _present(false), _valid(false), _cachedEpoch(0), _lastReadMillis(0) {
+    : _present(false), _valid(false), _cachedEpoch(0), _edgeMillis(0), _edgeKnown(false),
+      _edgeCount(0), _lastReadMillis(0), _sqwActive(false), _sqwStartDue(false), _readDue(false),
+      _lastVerifyMillis(0),
+      _pendingWrite(false), _pendingEpoch(0), _pendingAt(0), _pendingRetries(0) {
 }
 
 void DS3231Clock::begin() {
@@ -26,37 +59,232 @@ void DS3231Clock::begin() {
             // Read initial time
             DateTime now = _rtc.now();
             _cachedEpoch = now.unixtime();
+            _lastReadMillis = millis();
             Serial.printf("DS3231Clock: RTC time is %02d:%02d:%02d\n",
                           now.hour(), now.minute(), now.second());
         }
+        
+        // Attached on the first update(), once setup() has brought up the display's SPI
+        _sqwStartDue = DS3231_SQW_PIN >= 0;
     } else {
         _present = false;
         Serial.println("DS3231Clock: RTC not found!");
     }
 }
 
+void IRAM_ATTR DS3231Clock::onSqwEdge() {
+    DS3231Clock* clock = _instance;
+    if (!clock || clock->_pendingWrite) return;  // Old phase edges until the deferred write
+    
+    // Ringing or noise on the open-drain line: a real edge comes once a second
+    unsigned long now = millis();
+    if (clock->_edgeKnown && now - clock->_edgeMillis < SQW_MIN_EDGE_INTERVAL) return;
+    
+    clock->_cachedEpoch++;
+    clock->_edgeMillis = now;
+    clock->_edgeKnown = true;
+    clock->_edgeCount++;
+}
+
+void DS3231Clock::startSqw() {
+    _instance = this;
+    _rtc.writeSqwPinMode(DS3231_SquareWave1Hz);
+    pinMode(DS3231_SQW_PIN, INPUT_PULLUP);  // SQW is open drain
+    
+    // The phase is unknown until the first edge, which also confirms the wiring
+    unsigned long now = millis();
+    setCached(_cachedEpoch, now, false);
+    _readDue = true;
+    _lastVerifyMillis = now;
+    _sqwActive = true;
+    attachInterrupt(digitalPinToInterrupt(DS3231_SQW_PIN), onSqwEdge, FALLING);
+    
+    Serial.printf("DS3231Clock: Counting seconds from SQW on GPIO%d\n", DS3231_SQW_PIN);
+}
+
+void DS3231Clock::stopSqw() {
+    detachInterrupt(digitalPinToInterrupt(DS3231_SQW_PIN));
+    _rtc.writeSqwPinMode(DS3231_OFF);
+    _sqwActive = false;
+    _edgeKnown = false;
+    _lastReadMillis = 0;
+}
+
+void DS3231Clock::setCached(unsigned long epoch, unsigned long edgeMillis, bool edgeKnown) {
+    noInterrupts();
+    _cachedEpoch = epoch;
+    _edgeMillis = edgeMillis;
+    _edgeKnown = edgeKnown;
+    interrupts();
+}
+
 void DS3231Clock::update() {
     if (!_present) return;
     
-    // Periodically read from RTC to stay synchronized
+    if (_sqwStartDue) {
+        _sqwStartDue = false;
+        startSqw();
+    }
+    
     unsigned long now = millis();
-    if (now - _lastReadMillis >= READ_INTERVAL) {
+    
+    if (_pendingWrite) {
+        unsigned long late = now - _pendingAt;
+        if ((long)late < 0) return;
+        
+        // The RTC's second restarts at the write, so a late one leaves it behind by the
+        // lateness; wait for a later boundary the loop lands closer to, within reason
+        if (late > PENDING_WRITE_SLACK_MS && _pendingRetries < PENDING_WRITE_RETRIES) {
+            unsigned long skip = late / 1000 + 1;
+            _pendingEpoch += skip;
+            _pendingAt += skip * 1000;
+            _pendingRetries++;
+            return;
+        }
+        if (late > PENDING_WRITE_SLACK_MS) {
+            Serial.printf("DS3231Clock: RTC write %lu ms late\n", late);
+        }
+        writeEpoch(_pendingEpoch);
+        return;
+    }
+    
+    if (!_valid) return;  // Nothing to track until the RTC has been set
+    
+    if (_sqwActive) {
+        updateTicked(now);
+    } else {
+        updatePolled(now);
+    }
+}
+
+void DS3231Clock::updateTicked(unsigned long now) {
+    noInterrupts();
+    unsigned long epoch = _cachedEpoch;
+    unsigned long sinceEdge = now - _edgeMillis;
+    uint32_t edges = _edgeCount;
+    interrupts();
+    
+    // No edges: SQW not wired, or the RTC was reset and the square wave is off
+    if ((long)sinceEdge > (long)SQW_TIMEOUT) {
+        Serial.println("DS3231Clock: No SQW edges, falling back to I2C polling");
+        stopSqw();
+        return;
+    }
+    
+    if (now - _lastVerifyMillis >= DS3231_VERIFY_INTERVAL) {
+        _readDue = true;
+    }
+    
+    // Read early in the second so the registers can't tick mid-read
+    if (!_readDue || !_edgeKnown || sinceEdge >= 500) return;
+    
+    unsigned long rtcEpoch = _rtc.now().unixtime();
+    
+    noInterrupts();
+    bool ticked = _edgeCount != edges;
+    if (!ticked) {
+        _cachedEpoch += rtcEpoch - epoch;
+    }
+    interrupts();
+    if (ticked) return;  // Edge arrived during the read, try after the next one
+    
+    _readDue = false;
+    _lastVerifyMillis = now;
+    if (rtcEpoch != epoch) {
+        Serial.printf("DS3231Clock: Tick count off by %ld s, corrected\n",
+                      (long)(rtcEpoch - epoch));
+    }
+}
+
+void DS3231Clock::updatePolled(unsigned long now) {
+    if (!_edgeKnown) {
+        // The RTC only reports whole seconds: poll until it ticks to learn its phase
+        unsigned long epoch = _rtc.now().unixtime();
+        if (_lastReadMillis != 0 && epoch != _cachedEpoch) {
+            _edgeMillis = now;
+            _edgeKnown = true;
+        }
+        _cachedEpoch = epoch;
         _lastReadMillis = now;
-        DateTime dt = _rtc.now();
-        _cachedEpoch = dt.unixtime();
+        return;
+    }
+    
+    // Fold whole elapsed seconds into the cached epoch
+    unsigned long elapsed = now - _edgeMillis;
+    if (elapsed >= 1000) {
+        _cachedEpoch += elapsed / 1000;
+        _edgeMillis += (elapsed / 1000) * 1000;
+        elapsed %= 1000;
+    }
+    
+    // Cross-check mid-second so the read can't straddle a tick
+    if (now - _lastReadMillis >= READ_INTERVAL && elapsed >= 400 && elapsed < 600) {
+        _lastReadMillis = now;
+        unsigned long epoch = _rtc.now().unixtime();
+        if (epoch != _cachedEpoch) {
+            Serial.printf("DS3231Clock: RTC off by %ld s, re-locking\n",
+                          (long)(epoch - _cachedEpoch));
+            _cachedEpoch = epoch;
+            _edgeKnown = false;
+        }
     }
 }
 
 unsigned long DS3231Clock::getEpochTime() const {
-    return _cachedEpoch;
+    return (unsigned long)(getEpochMillis() / 1000ULL);
+}
+
+uint64_t DS3231Clock::getEpochMillis() const {
+    noInterrupts();
+    unsigned long epoch = _cachedEpoch;
+    unsigned long edgeMillis = _edgeMillis;
+    bool edgeKnown = _edgeKnown;
+    interrupts();
+    
+    uint64_t ms = (uint64_t)epoch * 1000ULL;
+    if (edgeKnown) {
+        ms += millis() - edgeMillis;
+    }
+    return ms;
 }
 
 void DS3231Clock::setEpochTime(unsigned long epoch) {
     if (!_present) return;
     
-    // Write to RTC hardware
+    _pendingWrite = false;
+    writeEpoch(epoch);
+}
+
+void DS3231Clock::setEpochMillis(uint64_t epochMs) {
+    if (!_present) return;
+    
+    unsigned long fraction = (unsigned long)(epochMs % 1000ULL);
+    if (fraction == 0) {
+        setEpochTime((unsigned long)(epochMs / 1000ULL));
+        return;
+    }
+    
+    // Serve interpolated time right away, write the RTC when the next second starts
+    unsigned long now = millis();
+    unsigned long epoch = (unsigned long)(epochMs / 1000ULL);
+    _pendingWrite = true;  // Before the cache so the interrupt leaves it alone
+    setCached(epoch, now - fraction, true);
+    _valid = true;
+    
+    _pendingEpoch = epoch + 1;
+    _pendingAt = now + (1000 - fraction);
+    _pendingRetries = 0;
+}
+
+void DS3231Clock::writeEpoch(unsigned long epoch) {
+    // Write to RTC hardware (resets its countdown chain)
     _rtc.adjust(DateTime(epoch));
-    _cachedEpoch = epoch;
+    
+    unsigned long now = millis();
+    setCached(epoch, now, true);
+    _lastReadMillis = now;
+    _readDue = true;  // Confirm the write once the first edge of the new phase arrives
+    _pendingWrite = false;
     _valid = true;
     
     DateTime dt = DateTime(epoch);
@@ -64,6 +292,75 @@ void DS3231Clock::setEpochTime(unsigned long epoch) {
                   dt.hour(), dt.minute(), dt.second());
 }
 
+bool DS3231Clock::checkHealth() {
+    Wire.beginTransmission(DS3231_ADDRESS);
+    if (Wire.endTransmission() != 0) {
+        if (_present) {
+            Serial.println("DS3231Clock: RTC stopped answering");
+        }
+        _present = false;
+        return false;
+    }
+    
+    if (!_present) {
+        if (!_rtc.begin()) return false;
+        Serial.println("DS3231Clock: RTC answering again");
+        _present = true;
+        _pendingWrite = false;
+        _valid = !_rtc.lostPower();
+        
+        // Edges were missed while it was away: re-read and re-learn the phase
+        if (_valid) {
+            setCached(_rtc.now().unixtime(), millis(), false);
+            _lastReadMillis = 0;
+            _readDue = true;
+        }
+        if (DS3231_SQW_PIN >= 0 && !_sqwActive) {
+            startSqw();
+        }
+        return _valid;
+    }
+    
+    if (_valid && _rtc.lostPower()) {
+        Serial.println("DS3231Clock: RTC lost power, needs sync");
+        _valid = false;
+    }
+    
+    return _valid;
+}
+
 bool DS3231Clock::isValid() const {
     return _present && _valid;
 }
+
+bool DS3231Clock::getAgingOffset(int8_t& offset) const {
+    if (!_present) return false;
+    
+    uint8_t value;
+    if (!readRegister(DS3231_REG_AGING, value)) {
+        Serial.println("DS3231Clock: Aging offset read failed");
+        return false;
+    }
+    offset = (int8_t)value;
+    return true;
+}
+
+bool DS3231Clock::setAgingOffset(int8_t offset) {
+    if (!_present) return false;
+    
+    if (!writeRegister(DS3231_REG_AGING, (uint8_t)offset)) {
+        Serial.println("DS3231Clock: Aging offset write failed");
+        return false;
+    }
+    
+    // A conversion already in progress will pick the trim up by itself;
+    // if this fails the trim still applies at the next automatic one (64 s)
+    uint8_t status, control;
+    if (readRegister(DS3231_REG_STATUS, status) && !(status & DS3231_STATUS_BSY) &&
+        readRegister(DS3231_REG_CONTROL, control)) {
+        writeRegister(DS3231_REG_CONTROL, control | DS3231_CONTROL_CONV);
+    }
+    
+    Serial.printf("DS3231Clock: Aging offset set to %d\n", offset);
+    return true;
+}
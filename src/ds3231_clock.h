@@ -2,7 +2,8 @@
  * DS3231 RTC Clock
  * 
  * Hardware real-time clock with battery backup
- * Uses I2C interface (SDA/SCL)
+ * Uses I2C interface (SDA/SCL); with INT/SQW wired to DS3231_SQW_PIN the
+ * seconds are counted from the 1 Hz square wave instead of I2C reads
  */
 
 #ifndef DS3231_CLOCK_H
@@ -19,28 +20,127 @@ public:
     void update() override;
     unsigned long getEpochTime() const override;
     void setEpochTime(unsigned long epoch) override;
+    uint64_t getEpochMillis() const override;
+    
+    /**
+     * Set time with millisecond resolution
+     * The RTC restarts its second when the seconds register is written,
+     * so the write is deferred to the next whole-second boundary
+     */
+    void setEpochMillis(uint64_t epochMs) override;
     bool isValid() const override;
     const char* getName() const override { return "DS3231"; }
     
+    bool hasAgingTrim() const override { return _present; }
+    
+    /**
+     * Read the aging offset register (0x10)
+     * @param offset Signed trim, one LSB is about 0.1 ppm
+     * @return false if the RTC is absent or the I2C read failed
+     */
+    bool getAgingOffset(int8_t& offset) const override;
+    
+    /**
+     * Write the aging offset register and start a temperature conversion
+     * so the new trim takes effect immediately instead of within 64 s
+     * @return false if the RTC is absent or didn't acknowledge the write
+     */
+    bool setAgingOffset(int8_t offset) override;
+    
     /**
      * Check if DS3231 is detected on I2C bus
      * @return true if RTC is present
      */
     bool isPresent() const { return _present; }
     
+    /**
+     * Probe the bus and the oscillator-stop flag
+     * An RTC that stopped answering is marked absent, one that lost
+     * power is marked invalid; an RTC that reappears is re-read
+     * @return true if the RTC answered and holds valid time
+     */
+    bool checkHealth();
+    
+    /**
+     * Check if the sub-second phase of the RTC is known
+     * @return false until a tick has been observed
+     */
+    bool hasPhase() const { return _edgeKnown; }
+    
     /**
      * Get the underlying RTC object for direct access
      * @return Reference to RTC_DS3231
      */
     RTC_DS3231& getRTC() { return _rtc; }
+    
+    /**
+     * Check if seconds are being counted from the SQW interrupt
+     * @return false when polling the RTC over I2C
+     */
+    bool isTicking() const { return _sqwActive; }
 
 private:
     RTC_DS3231 _rtc;
     bool _present;
     bool _valid;
-    unsigned long _cachedEpoch;
+    
+    // Written by the SQW interrupt as well as the main loop
+    volatile unsigned long _cachedEpoch;  // RTC seconds at _edgeMillis
+    volatile unsigned long _edgeMillis;   // millis() when the RTC ticked into _cachedEpoch
+    volatile bool _edgeKnown;             // false until a tick has been observed
+    volatile uint32_t _edgeCount;         // SQW edges seen
+    
     unsigned long _lastReadMillis;
-    static const unsigned long READ_INTERVAL = 500;  // Read RTC every 500ms
+    static const unsigned long READ_INTERVAL = 500;  // Cross-check RTC every 500ms (no SQW)
+    
+    // 1 Hz square wave tick
+    bool _sqwActive;
+    bool _sqwStartDue;              // begin() found the RTC; attach on the next update()
+    bool _readDue;                  // Full register read wanted after the next edge
+    unsigned long _lastVerifyMillis;
+    static const unsigned long SQW_TIMEOUT = 2500;   // Fall back to polling after this without an edge
+    static const unsigned long SQW_MIN_EDGE_INTERVAL = 900;  // Edges sooner than this after the last are noise
+    static DS3231Clock* _instance;  // Target of the interrupt handler
+    
+    // Write deferred to a second boundary by setEpochMillis()
+    volatile bool _pendingWrite;
+    unsigned long _pendingEpoch;
+    unsigned long _pendingAt;
+    uint8_t _pendingRetries;        // Boundaries passed up because the loop got there late
+    static const unsigned long PENDING_WRITE_SLACK_MS = 1;  // Lateness a write may have
+    static const uint8_t PENDING_WRITE_RETRIES = 30;        // Then write late rather than keep waiting
+    
+    /**
+     * Write seconds to the RTC; its new second starts now
+     */
+    void writeEpoch(unsigned long epoch);
+    
+    /**
+     * Set the cached second and its edge without racing the interrupt
+     */
+    void setCached(unsigned long epoch, unsigned long edgeMillis, bool edgeKnown);
+    
+    /**
+     * Enable the 1 Hz square wave and attach the interrupt
+     */
+    void startSqw();
+    
+    /**
+     * Detach the interrupt and switch the square wave off
+     */
+    void stopSqw();
+    
+    /**
+     * Track seconds from SQW edges, reading the registers only when due
+     */
+    void updateTicked(unsigned long now);
+    
+    /**
+     * Track seconds by reading the RTC over I2C
+     */
+    void updatePolled(unsigned long now);
+    
+    static void onSqwEdge();
 };
 
 #endif // DS3231_CLOCK_H
@@ -6,9 +6,13 @@
  */
 
 #include "esp8266_clock.h"
+#include "clock_discipline.h"
+
+static const int64_t PPB_SCALE = 1000000000LL;
 
 ESP8266Clock::ESP8266Clock()
-    : _epochTime(0), _lastMillis(0), _valid(false) {
+    : _epochMs(0), _lastMillis(0), _valid(false),
+      _freqPpb(0), _freqAccum(0), _slewRemainingMs(0), _slewAccum(0), _lastReadMs(0) {
 }
 
 void ESP8266Clock::begin() {
@@ -21,23 +25,96 @@ void ESP8266Clock::update() {
     
     unsigned long now = millis();
     unsigned long elapsed = now - _lastMillis;
+    if (elapsed == 0) return;
+    
+    _epochMs += (int64_t)elapsed + takeAdjust(elapsed, _freqAccum, _slewRemainingMs, _slewAccum);
+    _lastMillis = now;
+}
+
+int64_t ESP8266Clock::takeAdjust(unsigned long elapsed, int64_t& freqAccum,
+                                 int32_t& slewRemainingMs, int64_t& slewAccum) const {
+    int64_t adjust = 0;
+    
+    // Frequency correction
+    freqAccum += (int64_t)elapsed * _freqPpb;
+    int64_t whole = freqAccum / PPB_SCALE;
+    freqAccum -= whole * PPB_SCALE;
+    adjust += whole;
     
-    if (elapsed >= 1000) {
-        _epochTime += elapsed / 1000;
-        _lastMillis = now - (elapsed % 1000);
+    // Slew at a bounded rate until the pending correction is used up
+    if (slewRemainingMs != 0) {
+        slewAccum += (int64_t)elapsed * CLOCK_SLEW_PPB;
+        int64_t step = slewAccum / PPB_SCALE;
+        if (step > 0) {
+            slewAccum -= step * PPB_SCALE;
+            if (slewRemainingMs > 0) {
+                if (step > slewRemainingMs) step = slewRemainingMs;
+                slewRemainingMs -= (int32_t)step;
+                adjust += step;
+            } else {
+                if (step > -slewRemainingMs) step = -slewRemainingMs;
+                slewRemainingMs += (int32_t)step;
+                adjust -= step;
+            }
+        }
     }
+    
+    return adjust;
 }
 
 unsigned long ESP8266Clock::getEpochTime() const {
-    return _epochTime;
+    // Derived live so the second flips on the boundary, not on the next update()
+    return (unsigned long)(getEpochMillis() / 1000ULL);
 }
 
 void ESP8266Clock::setEpochTime(unsigned long epoch) {
-    _epochTime = epoch;
+    setEpochMillis((uint64_t)epoch * 1000ULL);
+}
+
+uint64_t ESP8266Clock::getEpochMillis() const {
+    if (!_valid) return _epochMs;
+    
+    // What update() would make of it now, without committing the accumulators,
+    // so a read just before an update agrees with one just after
+    unsigned long elapsed = millis() - _lastMillis;
+    int64_t freqAccum = _freqAccum;
+    int32_t slewRemainingMs = _slewRemainingMs;
+    int64_t slewAccum = _slewAccum;
+    uint64_t now = _epochMs + (int64_t)elapsed + takeAdjust(elapsed, freqAccum, slewRemainingMs, slewAccum);
+    
+    // A rate and a slew step backwards can land in the same ms; hold the clock instead
+    if (now < _lastReadMs) {
+        return _lastReadMs;
+    }
+    _lastReadMs = now;
+    return now;
+}
+
+void ESP8266Clock::setEpochMillis(uint64_t epochMs) {
+    _epochMs = epochMs;
     _lastMillis = millis();
+    _lastReadMs = 0;  // A step may go backwards
+    _slewRemainingMs = 0;
+    _slewAccum = 0;
     _valid = true;
 }
 
+void ESP8266Clock::slew(int32_t offsetMs) {
+    if (!_valid) {
+        ClockSource::slew(offsetMs);
+        return;
+    }
+    
+    update();  // Settle time at the old rate first
+    _slewRemainingMs = offsetMs;
+    _slewAccum = 0;
+}
+
+void ESP8266Clock::setFrequencyPpb(int32_t ppb) {
+    update();
+    _freqPpb = ppb;
+}
+
 bool ESP8266Clock::isValid() const {
     return _valid;
 }
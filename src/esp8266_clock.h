@@ -3,6 +3,8 @@
  * 
  * Time tracking using millis() - extracted from original TimeManager
  * Maintains time in memory, loses time on power cycle
+ * Supports a frequency correction and slewed adjustments so NTP
+ * corrections never make the displayed time jump or repeat
  */
 
 #ifndef ESP8266_CLOCK_H
@@ -18,13 +20,32 @@ public:
     void update() override;
     unsigned long getEpochTime() const override;
     void setEpochTime(unsigned long epoch) override;
+    uint64_t getEpochMillis() const override;
+    void setEpochMillis(uint64_t epochMs) override;
+    void slew(int32_t offsetMs) override;
+    int32_t getPendingSlewMs() const override { return _slewRemainingMs; }
+    void setFrequencyPpb(int32_t ppb) override;
+    int32_t getFrequencyPpb() const override { return _freqPpb; }
     bool isValid() const override;
     const char* getName() const override { return "ESP8266"; }
 
 private:
-    unsigned long _epochTime;
-    unsigned long _lastMillis;
+    uint64_t _epochMs;          // Clock time at _lastMillis
+    unsigned long _lastMillis;  // millis() when _epochMs was last advanced
     bool _valid;
+    
+    int32_t _freqPpb;           // Oscillator rate correction
+    int64_t _freqAccum;         // Sub-ms remainder of the rate correction (ms * 1e9)
+    int32_t _slewRemainingMs;   // Correction still to be slewed in
+    int64_t _slewAccum;         // Sub-ms remainder of the slew (ms * 1e9)
+    mutable uint64_t _lastReadMs;  // Latest time handed out; reads never go below it
+    
+    /**
+     * Rate and slew correction for elapsed ms, advancing the given accumulators
+     * @return Whole ms to add on top of elapsed
+     */
+    int64_t takeAdjust(unsigned long elapsed, int64_t& freqAccum,
+                       int32_t& slewRemainingMs, int64_t& slewAccum) const;
 };
 
 #endif // ESP8266_CLOCK_H
@@ -0,0 +1,60 @@
+/**
+ * Font Atlas Implementation
+ *
+ * Rows are read as a 16-bit window at their byte, so a glyph up to 8 columns
+ * wide never needs more than two byte reads
+ */
+
+#include "font.h"
+
+#include <string.h>
+
+static uint8_t glyphIndex(const Font& font, uint8_t c, bool& found) {
+    // Ranges are few (one for full ASCII), a linear scan is enough
+    for (uint8_t i = 0; i < font.rangeCount; i++) {
+        uint8_t first = pgm_read_byte(&font.ranges[i].first);
+        if (c < first) break;
+        if (c <= pgm_read_byte(&font.ranges[i].last)) {
+            found = true;
+            return pgm_read_byte(&font.ranges[i].glyph) + (c - first);
+        }
+    }
+    found = false;
+    return font.fallback;
+}
+
+bool fontGlyph(const Font& font, uint8_t c, FontGlyph& glyph) {
+    bool found;
+    uint8_t index = glyphIndex(font, c, found);
+
+    if (font.glyphs) {
+        memcpy_P(&glyph, &font.glyphs[index], sizeof(glyph));
+    } else {
+        glyph.bitmap = (uint16_t)(index * font.width * font.height);
+        glyph.width = font.width;
+        glyph.advance = font.advance;
+    }
+    return found;
+}
+
+uint8_t fontRow(const Font& font, const FontGlyph& glyph, uint8_t row) {
+    if (row >= font.height || glyph.width == 0) return 0;
+
+    uint16_t bit = glyph.bitmap + (uint16_t)row * glyph.width;
+    const uint8_t* p = &font.bitmap[bit >> 3];
+    uint16_t window = ((uint16_t)pgm_read_byte(p) << 8) | pgm_read_byte(p + 1);
+
+    // Left-align the row in the window, keep its width in the top bits
+    window <<= (bit & 7);
+    return (uint8_t)(window >> 8) & (uint8_t)(0xFF << (8 - glyph.width));
+}
+
+uint16_t fontTextWidth(const Font& font, const char* text) {
+    uint16_t width = 0;
+    FontGlyph glyph;
+    while (*text) {
+        fontGlyph(font, (uint8_t)*text++, glyph);
+        width += glyph.advance;
+    }
+    return width;
+}
@@ -0,0 +1,73 @@
+/**
+ * Font Atlas Header
+ *
+ * Packed glyph atlases produced by scripts/gen_font.py from BDF/PSF fonts
+ * Glyph rows are stored back to back, width bits each, leftmost column first;
+ * no padding between rows or glyphs. Each font holds only the characters its
+ * manifest entry asks for, as sorted ranges
+ */
+
+#ifndef FONT_H
+#define FONT_H
+
+#include <stdint.h>
+
+#ifdef NATIVE_TEST
+#define PROGMEM
+#define pgm_read_byte(p) (*(const uint8_t*)(p))
+#define memcpy_P memcpy
+#else
+#include <pgmspace.h>
+#endif
+
+// Widest glyph a row byte can hold
+#define FONT_MAX_WIDTH 8
+
+/**
+ * Characters first..last map to consecutive glyphs starting at glyph
+ */
+struct FontRange {
+    uint8_t first;
+    uint8_t last;
+    uint8_t glyph;
+};
+
+/**
+ * Where a glyph's rows are and how far it advances
+ */
+struct FontGlyph {
+    uint16_t bitmap;    // Bit offset of the first row
+    uint8_t width;      // Columns per row (0 for blank glyphs such as space)
+    uint8_t advance;    // Columns to the next glyph, spacing included
+};
+
+struct Font {
+    const uint8_t* bitmap;      // PROGMEM, padded by one byte so a row can always be read as two
+    const FontGlyph* glyphs;    // PROGMEM, nullptr when every glyph has the same width and advance
+    const FontRange* ranges;    // PROGMEM, sorted by first
+    uint8_t rangeCount;
+    uint8_t height;             // Rows per glyph
+    uint8_t width;              // Cell width (glyphs == nullptr)
+    uint8_t advance;            // Cell advance (glyphs == nullptr)
+    uint8_t fallback;           // Glyph drawn for characters the font doesn't have
+};
+
+/**
+ * Look up a character
+ * @param glyph Output: the character's glyph, or the fallback glyph
+ * @return false if the font doesn't have the character
+ */
+bool fontGlyph(const Font& font, uint8_t c, FontGlyph& glyph);
+
+/**
+ * One row of a glyph
+ * @return Row bits, leftmost column in the MSB (0 past the glyph's height)
+ */
+uint8_t fontRow(const Font& font, const FontGlyph& glyph, uint8_t row);
+
+/**
+ * Columns a string takes, spacing after the last glyph included
+ */
+uint16_t fontTextWidth(const Font& font, const char* text);
+
+#endif // FONT_H
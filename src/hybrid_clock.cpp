@@ -0,0 +1,142 @@
+/**
+ * Hybrid Clock Implementation
+ * 
+ * Neither oscillator drifts by more than a few ms per minute, so a larger
+ * change in their difference between checks is a glitch, not drift
+ */
+
+#include "hybrid_clock.h"
+#include "config.h"
+
+HybridClock::HybridClock(ESP8266Clock& soft, DS3231Clock& rtc)
+    : _soft(soft), _rtc(rtc), _rtcOk(false), _softFromNtp(false), _phaseSeeded(false),
+      _lastCheck(0), _lastDiffMs(0), _haveDiff(false) {
+}
+
+void HybridClock::begin() {
+    _soft.begin();
+    _rtc.begin();
+    _lastCheck = millis();
+    _rtcOk = _rtc.isValid();
+    
+    if (_rtcOk && !_soft.isValid()) {
+        // Holdover: correct time before Wi-Fi is up
+        _soft.setEpochMillis(_rtc.getEpochMillis());
+        _phaseSeeded = _rtc.hasPhase();
+        Serial.println("HybridClock: Software clock seeded from RTC");
+    } else if (!_rtcOk) {
+        Serial.println("HybridClock: RTC unavailable, waiting for NTP");
+    }
+}
+
+void HybridClock::update() {
+    _soft.update();
+    if (_rtcOk) {
+        _rtc.update();
+    }
+    
+    // Seeded at whole-second resolution: refine once the RTC's phase is known
+    if (_rtcOk && !_softFromNtp && !_phaseSeeded && _rtc.hasPhase()) {
+        _soft.setEpochMillis(_rtc.getEpochMillis());
+        _phaseSeeded = true;
+        _haveDiff = false;
+    }
+    
+    unsigned long now = millis();
+    if (now - _lastCheck >= HYBRID_CHECK_INTERVAL) {
+        _lastCheck = now;
+        checkRtc();
+        if (_rtcOk) {
+            crossCheck();
+        }
+    }
+}
+
+void HybridClock::checkRtc() {
+    bool ok = _rtc.checkHealth();
+    
+    if (!ok && _rtc.isPresent() && _softFromNtp) {
+        // Present but without valid time: restore it from NTP time
+        _rtc.setEpochMillis(_soft.getEpochMillis());
+        ok = true;
+    }
+    
+    if (ok == _rtcOk) return;
+    
+    _rtcOk = ok;
+    _haveDiff = false;
+    if (ok) {
+        Serial.println("HybridClock: RTC available again");
+        if (!_soft.isValid()) {
+            _soft.setEpochMillis(_rtc.getEpochMillis());
+            _phaseSeeded = _rtc.hasPhase();
+        }
+    } else {
+        Serial.println("HybridClock: RTC unavailable, failing over to software clock");
+    }
+}
+
+void HybridClock::crossCheck() {
+    if (!_soft.isValid() || !_rtc.isValid() || !_rtc.hasPhase()) return;
+    
+    int64_t diff = (int64_t)_soft.getEpochMillis() - (int64_t)_rtc.getEpochMillis();
+    
+    if (_haveDiff) {
+        int64_t jump = diff - _lastDiffMs;
+        if (jump > HYBRID_GLITCH_MS || jump < -HYBRID_GLITCH_MS) {
+            Serial.printf("HybridClock: Software clock jumped %ld ms, restoring from RTC\n", (long)jump);
+            _soft.setEpochMillis(_rtc.getEpochMillis() + _lastDiffMs);
+            return;
+        }
+    }
+    
+    if (diff > HYBRID_RTC_TOLERANCE_MS || diff < -HYBRID_RTC_TOLERANCE_MS) {
+        if (_softFromNtp) {
+            // The software clock is disciplined: bring the RTC back to it
+            Serial.printf("HybridClock: RTC off by %ld ms, rewriting\n", (long)-diff);
+            _rtc.setEpochMillis(_soft.getEpochMillis());
+        } else {
+            // No NTP yet: the RTC's oscillator is the better of the two
+            _soft.setEpochMillis(_rtc.getEpochMillis());
+        }
+        _haveDiff = false;
+        return;
+    }
+    
+    _lastDiffMs = diff;
+    _haveDiff = true;
+}
+
+unsigned long HybridClock::getEpochTime() const {
+    return _soft.getEpochTime();
+}
+
+uint64_t HybridClock::getEpochMillis() const {
+    return _soft.getEpochMillis();
+}
+
+void HybridClock::setEpochTime(unsigned long epoch) {
+    setEpochMillis((uint64_t)epoch * 1000ULL);
+}
+
+void HybridClock::setEpochMillis(uint64_t epochMs) {
+    _soft.setEpochMillis(epochMs);
+    _softFromNtp = true;
+    _haveDiff = false;
+    
+    if (_rtcOk || _rtc.isPresent()) {
+        _rtc.setEpochMillis(epochMs);
+        _rtcOk = _rtc.isValid();
+    }
+}
+
+void HybridClock::slew(int32_t offsetMs) {
+    // Slews are a few ms per minute at most, well inside the glitch threshold;
+    // the RTC follows when it drifts past HYBRID_RTC_TOLERANCE_MS
+    _soft.slew(offsetMs);
+    _softFromNtp = true;
+}
+
+bool HybridClock::isValid() const {
+    return _soft.isValid();
+}
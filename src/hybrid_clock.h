@@ -0,0 +1,62 @@
+/**
+ * Hybrid Clock
+ * 
+ * Software clock for reads, DS3231 for holdover across power loss
+ * Time is served from the ESP8266 clock (millisecond resolution, no I2C);
+ * the RTC seeds it at boot, is kept within tolerance of NTP time and
+ * restores the software clock if that ever jumps. If the RTC disappears
+ * from the bus or loses power the software clock carries on alone.
+ */
+
+#ifndef HYBRID_CLOCK_H
+#define HYBRID_CLOCK_H
+
+#include "clock_source.h"
+#include "esp8266_clock.h"
+#include "ds3231_clock.h"
+
+class HybridClock : public ClockSource {
+public:
+    HybridClock(ESP8266Clock& soft, DS3231Clock& rtc);
+    
+    void begin() override;
+    void update() override;
+    unsigned long getEpochTime() const override;
+    void setEpochTime(unsigned long epoch) override;
+    uint64_t getEpochMillis() const override;
+    void setEpochMillis(uint64_t epochMs) override;
+    void slew(int32_t offsetMs) override;
+    int32_t getPendingSlewMs() const override { return _soft.getPendingSlewMs(); }
+    void setFrequencyPpb(int32_t ppb) override { _soft.setFrequencyPpb(ppb); }
+    int32_t getFrequencyPpb() const override { return _soft.getFrequencyPpb(); }
+    bool isValid() const override;
+    const char* getName() const override { return "Hybrid"; }
+    
+    /**
+     * Check if the RTC is currently backing the software clock
+     * @return false after failing over to the software clock alone
+     */
+    bool isRtcAvailable() const { return _rtcOk; }
+
+private:
+    ESP8266Clock& _soft;
+    DS3231Clock& _rtc;
+    bool _rtcOk;                // RTC answering and holding valid time
+    bool _softFromNtp;          // Software clock set from NTP rather than the RTC
+    bool _phaseSeeded;          // Software clock re-seeded once the RTC phase was known
+    unsigned long _lastCheck;
+    int64_t _lastDiffMs;        // Software minus RTC at the last check
+    bool _haveDiff;
+    
+    /**
+     * Probe the RTC and fail over or restore it
+     */
+    void checkRtc();
+    
+    /**
+     * Compare both clocks: repair a software clock glitch or RTC drift
+     */
+    void crossCheck();
+};
+
+#endif // HYBRID_CLOCK_H
@@ -0,0 +1,89 @@
+/**
+ * Loop Profiler Implementation
+ *
+ * Log2 histograms over ESP.getCycleCount() deltas
+ */
+
+#include "loop_profiler.h"
+
+#include <string.h>
+
+// Global instance
+LoopProfiler loopProfiler;
+
+static const char* const STAGE_NAMES[PROFILE_STAGE_COUNT] = {
+    "time",
+    "weather",
+    "web",
+    "render",
+    "tilt"
+};
+
+LoopProfiler::LoopProfiler()
+    : _cpuMHz(80), _windowStart(0), _windowLoops(0), _loopsPerSecond(0) {
+    reset();
+}
+
+void LoopProfiler::record(uint8_t stage, uint32_t cycles) {
+    if (stage >= PROFILE_STAGE_COUNT) return;
+
+    StageStats& s = _stages[stage];
+    s.count++;
+    s.totalCycles += cycles;
+    if (cycles < s.minCycles) s.minCycles = cycles;
+    if (cycles > s.maxCycles) s.maxCycles = cycles;
+
+    // Bucket index is floor(log2(cycles)), with 0 cycles in bucket 0
+    uint8_t bucket = 0;
+    if (cycles > 0) {
+        bucket = 31 - __builtin_clz(cycles);
+    }
+    s.buckets[bucket]++;
+}
+
+void LoopProfiler::tickLoop(unsigned long nowMs) {
+    _windowLoops++;
+
+    unsigned long elapsed = nowMs - _windowStart;
+    if (elapsed >= 1000) {
+        _loopsPerSecond = (uint32_t)((uint64_t)_windowLoops * 1000 / elapsed);
+        _windowLoops = 0;
+        _windowStart = nowMs;
+    }
+}
+
+uint32_t LoopProfiler::percentileCycles(uint8_t stage, uint8_t percent) const {
+    if (stage >= PROFILE_STAGE_COUNT) return 0;
+
+    const StageStats& s = _stages[stage];
+    if (s.count == 0) return 0;
+
+    // Rank of the requested sample (1-based, rounded up)
+    uint32_t rank = (uint32_t)(((uint64_t)s.count * percent + 99) / 100);
+    if (rank == 0) rank = 1;
+
+    uint32_t seen = 0;
+    for (uint8_t i = 0; i < PROFILE_HIST_BUCKETS; i++) {
+        seen += s.buckets[i];
+        if (seen >= rank) {
+            uint32_t upper = (i >= 31) ? 0xFFFFFFFFUL : ((1UL << (i + 1)) - 1);
+            return upper < s.maxCycles ? upper : s.maxCycles;
+        }
+    }
+
+    return s.maxCycles;
+}
+
+const char* LoopProfiler::stageName(uint8_t stage) {
+    if (stage >= PROFILE_STAGE_COUNT) return "?";
+    return STAGE_NAMES[stage];
+}
+
+void LoopProfiler::reset() {
+    memset(_stages, 0, sizeof(_stages));
+    for (uint8_t i = 0; i < PROFILE_STAGE_COUNT; i++) {
+        _stages[i].minCycles = 0xFFFFFFFFUL;
+    }
+    _windowLoops = 0;
+    _loopsPerSecond = 0;
+}
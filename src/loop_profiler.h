@@ -0,0 +1,140 @@
+/**
+ * Loop Profiler Header
+ *
+ * Cycle-accurate per-stage timing for the main loop
+ * Fixed-memory log2 histograms give min/max/percentiles without allocation
+ *
+ * Wrap a stage with PROFILE_SCOPE(PROFILE_STAGE_xxx) and call
+ * PROFILE_LOOP_TICK() once per loop() pass. Both compile to no-ops in
+ * the native environment (or with -D PROFILER_DISABLED).
+ */
+
+#ifndef LOOP_PROFILER_H
+#define LOOP_PROFILER_H
+
+#include <stdint.h>
+
+// Profiled loop stages
+enum ProfileStage {
+    PROFILE_STAGE_TIME,     // TimeManager::update
+    PROFILE_STAGE_WEATHER,  // WeatherManager::processFetchState
+    PROFILE_STAGE_WEB,      // WebPortal::handleClient
+    PROFILE_STAGE_RENDER,   // Display render
+    PROFILE_STAGE_TILT,     // TiltSensor::update
+    PROFILE_STAGE_COUNT
+};
+
+// One bucket per power of two of the cycle count
+#define PROFILE_HIST_BUCKETS 32
+
+/**
+ * Accumulated timing for one stage
+ */
+struct StageStats {
+    uint32_t count;
+    uint32_t minCycles;
+    uint32_t maxCycles;
+    uint64_t totalCycles;
+    uint32_t buckets[PROFILE_HIST_BUCKETS];  // bucket i holds [2^i, 2^(i+1)) cycles
+};
+
+class LoopProfiler {
+public:
+    LoopProfiler();
+
+    /**
+     * Set CPU clock used to convert cycles to microseconds
+     * @param mhz CPU frequency in MHz (80 or 160 on ESP8266)
+     */
+    void setCpuMHz(uint32_t mhz) { _cpuMHz = mhz > 0 ? mhz : 1; }
+    uint32_t getCpuMHz() const { return _cpuMHz; }
+
+    /**
+     * Record one stage execution
+     * @param stage ProfileStage index
+     * @param cycles Elapsed CPU cycles
+     */
+    void record(uint8_t stage, uint32_t cycles);
+
+    /**
+     * Count one loop() iteration
+     * @param nowMs Current time in ms
+     */
+    void tickLoop(unsigned long nowMs);
+
+    /**
+     * Loop iterations per second over the last full window
+     */
+    uint32_t getLoopsPerSecond() const { return _loopsPerSecond; }
+
+    /**
+     * Get raw stats for a stage
+     */
+    const StageStats& getStats(uint8_t stage) const { return _stages[stage]; }
+
+    /**
+     * Estimate a percentile from the histogram
+     * @param stage ProfileStage index
+     * @param percent 0-100
+     * @return Upper bound of the bucket holding the percentile, in cycles
+     */
+    uint32_t percentileCycles(uint8_t stage, uint8_t percent) const;
+
+    /**
+     * Convert a cycle count to microseconds
+     */
+    uint32_t cyclesToMicros(uint64_t cycles) const { return (uint32_t)(cycles / _cpuMHz); }
+
+    /**
+     * Get short name of a stage (for reports)
+     */
+    static const char* stageName(uint8_t stage);
+
+    /**
+     * Clear all collected stats
+     */
+    void reset();
+
+private:
+    StageStats _stages[PROFILE_STAGE_COUNT];
+    uint32_t _cpuMHz;
+
+    // Loop rate window
+    unsigned long _windowStart;
+    uint32_t _windowLoops;
+    uint32_t _loopsPerSecond;
+};
+
+// Global instance
+extern LoopProfiler loopProfiler;
+
+#if defined(NATIVE_TEST) || defined(PROFILER_DISABLED)
+
+#define PROFILE_SCOPE(stage) do {} while (0)
+#define PROFILE_LOOP_TICK() do {} while (0)
+
+#else
+
+#include <Arduino.h>
+
+/**
+ * RAII helper that records the cycles spent in its scope
+ */
+class ProfileScope {
+public:
+    explicit ProfileScope(uint8_t stage) : _stage(stage), _start(ESP.getCycleCount()) {}
+    ~ProfileScope() { loopProfiler.record(_stage, ESP.getCycleCount() - _start); }
+
+private:
+    uint8_t _stage;
+    uint32_t _start;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(stage) ProfileScope PROFILE_CONCAT(_profileScope, __LINE__)(stage)
+#define PROFILE_LOOP_TICK() loopProfiler.tickLoop(millis())
+
+#endif
+
+#endif // LOOP_PROFILER_H
@@ -27,7 +27,11 @@
 #include "clock_source.h"
 #include "esp8266_clock.h"
 #include "ds3231_clock.h"
+#include "hybrid_clock.h"
 #include "tilt_sensor.h"
+#include "scheduler.h"
+#include "loop_profiler.h"
+#include "radio_duty.h"
 
 // Conditional display driver selection
 #ifdef USE_MAX7219_DISPLAY
@@ -41,6 +45,7 @@
 // Clock sources
 ESP8266Clock esp8266Clock;
 DS3231Clock ds3231Clock;
+HybridClock hybridClock(esp8266Clock, ds3231Clock);
 
 // Tilt sensor for display rotation
 TiltSensor tiltSensor;
@@ -49,6 +54,7 @@ TiltSensor tiltSensor;
 TimeManager timeManager;
 WiFiManager wifiManager;
 WeatherManager weatherManager;
+RadioDutyCycle radio;  // Shares wake windows between NTP and weather traffic
 
 // Display mode
 enum DisplayMode {
@@ -63,28 +69,58 @@ DisplayMode currentMode = MODE_TIME;
 DisplayMode previousMode = MODE_TIME;  // For returning after weather display
 int lastDisplayedSecond = -1;  // Track for second-accurate updates
 int lastDisplayedMinute = -1;  // Track for smart updates
-unsigned long lastFastUpdate = 0; // Track for activity indicator blinking
+
+// Text shown in custom mode (serial 'm')
+char customMessage[48] = "";
+
+// The 'm' line is collected over several serial polls instead of blocking for it
+char messageInput[sizeof(customMessage)];
+int messageInputLen = -1;           // -1 = not reading a message
+unsigned long messageInputAt = 0;   // millis() of the last byte received
+const unsigned long MESSAGE_INPUT_TIMEOUT = 1000;  // Ends a line sent without a newline
 
 // Scheduled display timing
 bool showingScheduledWeather = false;
-unsigned long scheduledWeatherStart = 0;
 unsigned long currentWeatherDuration = 20000;  // Will be randomized
 
-// Sync timing
-unsigned long lastNtpSync = 0;
-const unsigned long NTP_SYNC_INTERVAL = 900000;  // 15 minutes
+// Cooperative task scheduler (replaces per-subsystem millis() bookkeeping)
+TaskScheduler scheduler;
+int8_t weatherEndTask = -1;
+int8_t secondTaskId = -1;
+int8_t scrollTaskId = -1;
+
+// Task periods
+const unsigned long NETWORK_POLL_INTERVAL = 10;   // NTP/HTTP state machines, web portal
+const unsigned long TILT_POLL_INTERVAL = 20;      // Well inside the 50ms debounce
+const unsigned long SCHEDULE_CHECK_INTERVAL = 250;
+const unsigned long SECOND_CHECK_INTERVAL = 1000; // Fallback; normally re-armed on each second boundary
+const unsigned long SECOND_FLIP_GUARD_MS = 1;     // Wake just after the boundary, never before
+const unsigned long ACTIVITY_BLINK_INTERVAL = 100; // 10Hz activity indicator
+const unsigned long SERIAL_POLL_INTERVAL = 50;
+const unsigned long MAX_IDLE_MS = 50;             // Cap on a single idle wait
+#ifdef USE_MAX7219_DISPLAY
+const unsigned long SCROLL_FRAME_INTERVAL = 1000 / MAX7219_SCROLL_FPS;
+#endif
 
 // Forward declarations
 void displayTime();
 void displayDate();
 void displayTimeWithSeconds();
 void displayWeather();
+void renderCurrentMode();
 void handleSerialCommands();
+void finishMessageInput();
 void handleScheduledDisplay();
+void endScheduledWeather();
+void setupTasks();
+void printLoopMetrics();
+void printNtpStats();
+void applyRadioState();
 
 void setup() {
     Serial.begin(115200);
     Serial.println("\n\n=== VFD Clock Starting ===");
+    loopProfiler.setCpuMHz(ESP.getCpuFreqMHz());
     
     // Initialize configuration manager first
     Serial.println("Loading configuration...");
@@ -92,7 +128,11 @@ void setup() {
     
     // Initialize clock source based on config
     const ClockConfig& cfg = configManager.getConfig();
-    if (cfg.clockSource == 1) {
+    if (cfg.clockSource == 2) {
+        Serial.println("Using hybrid clock source (software clock with DS3231 holdover)");
+        hybridClock.begin();
+        timeManager.setClockSource(&hybridClock);
+    } else if (cfg.clockSource == 1) {
         Serial.println("Using DS3231 RTC clock source");
         ds3231Clock.begin();
         timeManager.setClockSource(&ds3231Clock);
@@ -102,6 +142,10 @@ void setup() {
         timeManager.setClockSource(&esp8266Clock);
     }
     
+    // Clocks hold UTC; local time also applies to RTC holdover time before Wi-Fi is up
+    timeManager.setTimezone(cfg.timezone);
+    timeManager.setServeEnabled(cfg.ntpServe);
+    
     // Initialize tilt sensor if configured
     if (cfg.tiltSensorPin > 0 && cfg.autoRotate) {
         Serial.printf("Initializing tilt sensor on GPIO%d\n", cfg.tiltSensorPin);
@@ -117,7 +161,6 @@ void setup() {
     
     // Connect to WiFi using saved credentials
     Serial.println("Connecting to WiFi...");
-    display.clear();
     display.print("WiFi...");
     
     if (wifiManager.connect(configManager.getWifiSsid(), configManager.getWifiPassword())) {
@@ -125,113 +168,220 @@ void setup() {
         Serial.print("IP Address: ");
         Serial.println(WiFi.localIP());
         
-        display.clear();
         display.print("SYNC...");
         
-        // Initialize time from NTP with saved timezone
-        timeManager.setTimezoneOffset(configManager.getTimezoneOffset());
+        // Initialize time from NTP
         timeManager.begin();
         timeManager.sync();
-        lastNtpSync = millis();
         
         // Initialize weather
         weatherManager.begin();
         
+        // Serving NTP needs requests stamped on arrival, so it keeps the radio up
+        bool radioSleep = cfg.radioSleep && !cfg.ntpServe;
+        if (cfg.radioSleep && cfg.ntpServe) {
+            Serial.println("Radio: Duty cycling off while serving NTP");
+        }
+        radio.setEnabled(radioSleep, millis());
+        timeManager.setRadio(&radio);
+        weatherManager.setRadio(&radio);
+        applyRadioState();
+        
         // Start web configuration portal
+        webPortal.setDisplay(&display);
+        webPortal.setTimeManager(&timeManager);
+        webPortal.setRadio(&radio);
         webPortal.begin();
         Serial.printf("Web portal: http://%s/\n", WiFi.localIP().toString().c_str());
     } else {
         Serial.println("WiFi failed - running offline");
-        display.clear();
         display.print("OFFLINE");
         delay(1000);
     }
     
+    setupTasks();
+    
     Serial.println("Setup complete!");
 }
 
-void loop() {
-    // Periodic NTP sync every 15 minutes (non-blocking)
-    if (millis() - lastNtpSync >= NTP_SYNC_INTERVAL) {
-        Serial.println("Starting scheduled NTP sync...");
-        timeManager.startSync();  // Non-blocking!
-        lastNtpSync = millis();
+// =============================================================================
+// Scheduled tasks
+// =============================================================================
+
+void applyRadioState() {
+    // Modem sleep keeps the association, so the portal still answers between windows
+    if (radio.isAwake()) {
+        WiFi.setSleepMode(WIFI_NONE_SLEEP);
+    } else {
+        WiFi.setSleepMode(WIFI_MODEM_SLEEP, RADIO_LISTEN_INTERVAL);
+    }
+}
+
+void radioTask() {
+    // A portal request usually brings more; answer those without sleep latency
+    static unsigned long lastRequest = 0;
+    unsigned long request = webPortal.getLastRequestMillis();
+    if (request != lastRequest) {
+        lastRequest = request;
+        radio.holdAwake(millis(), RADIO_PORTAL_HOLD_MS);
     }
     
-    // Update time periodically
-    timeManager.update();
-    
-    // Handle scheduled display (weather every 5 mins)
-    handleScheduledDisplay();
-    
-    // Update weather periodically
+    if (radio.update(millis())) {
+        Serial.printf("Radio: %s\n", radio.isAwake() ? "Window open" : "Sleeping");
+        applyRadioState();
+    }
+}
+
+void timeTask() {
+    PROFILE_SCOPE(PROFILE_STAGE_TIME);
+    timeManager.update();  // Also starts NTP syncs on its adaptive poll interval
+}
+
+void ntpServeTask() {
+    timeManager.receivePackets();  // Between updates, so LAN requests wait at most 1 ms
+}
+
+void weatherTask() {
     weatherManager.update();
-    
-    // Handle web portal requests
+}
+
+void webPortalTask() {
+    PROFILE_SCOPE(PROFILE_STAGE_WEB);
     webPortal.handleClient();
-    
-    // Update tilt sensor and handle display rotation
-    if (tiltSensor.isEnabled()) {
-        tiltSensor.update();
-        if (tiltSensor.hasChanged()) {
-            display.setRotation(tiltSensor.isFlipped());
-        }
+}
+
+void tiltTask() {
+    PROFILE_SCOPE(PROFILE_STAGE_TILT);
+    tiltSensor.update();
+    if (tiltSensor.hasChanged()) {
+        display.setRotation(tiltSensor.isFlipped());
     }
-    
-    // Determine if we need fast updates for activity indicators
-    bool showActivity = configManager.getShowActivityIndicators() && 
-                        (timeManager.isSyncing() || weatherManager.isFetching());
-    bool updateDisplay = false;
+}
 
-    if (showActivity) {
-        // Fast update (10Hz) for smooth blinking
-        if (millis() - lastFastUpdate >= 100) {
-            lastFastUpdate = millis();
-            updateDisplay = true;
-        }
-    } else {
-        // Normal update exactly when the second changes
-        int currentSecond = timeManager.getSeconds();
+bool isShowingActivity() {
+    return configManager.getShowActivityIndicators() &&
+           (timeManager.isSyncing() || weatherManager.isFetching());
+}
+
+void secondTask() {
+    // Normal update exactly when the second changes
+    // (activity task owns the display while blinking)
+    if (!isShowingActivity()) {
+        int currentSecond = timeManager.snapshot().seconds;
         if (currentSecond != lastDisplayedSecond) {
             lastDisplayedSecond = currentSecond;
-            updateDisplay = true;
+            renderCurrentMode();
         }
     }
+    
+    // Wake again right after the next UTC second boundary
+    scheduler.runAt(secondTaskId,
+                    millis() + timeManager.getMillisToNextSecond() + SECOND_FLIP_GUARD_MS);
+}
 
-    if (updateDisplay) {
-        switch (currentMode) {
-            case MODE_TIME:
-                displayTime();
-                break;
-            case MODE_DATE:
-                displayDate();
-                break;
-            case MODE_SECONDS:
-                displayTimeWithSeconds();
-                break;
-            case MODE_WEATHER:
-                // Only update weather display once per minute (static content)
-                if (timeManager.getMinutes() != lastDisplayedMinute) {
-                    displayWeather();
-                    lastDisplayedMinute = timeManager.getMinutes();
-                }
-                break;
-            case MODE_CUSTOM:
-                // Custom mode - implement as needed
-                break;
-        }
+void activityTask() {
+    // Fast update (10Hz) for smooth blinking
+    if (isShowingActivity()) {
+        lastDisplayedSecond = -1;  // Force a redraw when activity ends
+        renderCurrentMode();
+    }
+}
+
+#ifdef USE_MAX7219_DISPLAY
+void scrollTask() {
+    PROFILE_SCOPE(PROFILE_STAGE_RENDER);
+    // Only armed while text is scrolling; the frame grid comes from the scheduler's deadlines
+    if (!display.isScrolling()) {
+        scheduler.cancel(scrollTaskId);
+        return;
+    }
+    display.updateScroll();
+}
+#endif
+
+void setupTasks() {
+    unsigned long now = millis();
+    
+    if (radio.isEnabled()) {
+        scheduler.addTask(radioTask, NETWORK_POLL_INTERVAL, now);
+    }
+    scheduler.addTask(timeTask, NETWORK_POLL_INTERVAL, now);
+    if (timeManager.isServing()) {
+        scheduler.addTask(ntpServeTask, NTP_SERVE_POLL_INTERVAL, now);
+    }
+    scheduler.addTask(handleScheduledDisplay, SCHEDULE_CHECK_INTERVAL, now);
+    scheduler.addTask(weatherTask, NETWORK_POLL_INTERVAL, now);
+    scheduler.addTask(webPortalTask, NETWORK_POLL_INTERVAL, now);
+    secondTaskId = scheduler.addTask(secondTask, SECOND_CHECK_INTERVAL, now);
+    scheduler.addTask(activityTask, ACTIVITY_BLINK_INTERVAL, now);
+    scheduler.addTask(handleSerialCommands, SERIAL_POLL_INTERVAL, now);
+    
+    if (tiltSensor.isEnabled()) {
+        scheduler.addTask(tiltTask, TILT_POLL_INTERVAL, now);
     }
     
-    // Handle serial commands for testing
-    handleSerialCommands();
+    // One-shot end of the scheduled weather display, armed when it starts
+    weatherEndTask = scheduler.addOneShot(endScheduledWeather);
+    
+#ifdef USE_MAX7219_DISPLAY
+    // Frame pacing for scrolling text, armed by renderCurrentMode()
+    scrollTaskId = scheduler.addTask(scrollTask, SCROLL_FRAME_INTERVAL, now, CATCH_UP_SKIP,
+                                     SCROLL_FRAME_INTERVAL);
+#endif
+}
+
+void loop() {
+    PROFILE_LOOP_TICK();
+    timeManager.takeSnapshot();  // Every task in this pass sees the same time
+    scheduler.run(millis());
     
-    // Small delay to prevent WDT reset
-    yield();
+    // Idle until the next deadline instead of spinning; delay() yields to the SDK
+    unsigned long idle = scheduler.timeUntilNext(millis());
+    if (idle > MAX_IDLE_MS) {
+        idle = MAX_IDLE_MS;
+    }
+    if (idle > 0) {
+        delay(idle);
+    } else {
+        yield();
+    }
+}
+
+void renderCurrentMode() {
+    PROFILE_SCOPE(PROFILE_STAGE_RENDER);
+    switch (currentMode) {
+        case MODE_TIME:
+            displayTime();
+            break;
+        case MODE_DATE:
+            displayDate();
+            break;
+        case MODE_SECONDS:
+            displayTimeWithSeconds();
+            break;
+        case MODE_WEATHER:
+            // Only update weather display once per minute (static content)
+            if (timeManager.snapshot().minutes != lastDisplayedMinute) {
+                displayWeather();
+                lastDisplayedMinute = timeManager.snapshot().minutes;
+            }
+            break;
+        case MODE_CUSTOM:
+            display.print(customMessage);
+            break;
+    }
+    
+#ifdef USE_MAX7219_DISPLAY
+    if (display.isScrolling() && !scheduler.isArmed(scrollTaskId)) {
+        scheduler.runAt(scrollTaskId, millis() + SCROLL_FRAME_INTERVAL);
+    }
+#endif
 }
 
 void handleScheduledDisplay() {
-    int minutes = timeManager.getMinutes();
-    int seconds = timeManager.getSeconds();
+    const TimeSnapshot& now = timeManager.snapshot();
+    int minutes = now.minutes;
+    int seconds = now.seconds;
     
     // Random trigger second for weather display (configurable range)
     static int nextWeatherTriggerSecond = -1;
@@ -239,11 +389,12 @@ void handleScheduledDisplay() {
     
     // Pre-fetch weather at minute 4 (1 min before display)
     // Also at 9, 14, 19, 24, 29, 34, 39, 44, 49, 54, 59
-    if ((minutes % 5 == 4) && seconds == 0) {
+    // Any second of the minute counts so a stalled loop can't skip the slot
+    if (minutes % 5 == 4) {
         static int lastPrefetchMinute = -1;
         if (minutes != lastPrefetchMinute) {
-            Serial.println("Starting non-blocking weather prefetch...");
-            weatherManager.startFetch();  // Non-blocking!
+            Serial.println("Requesting weather prefetch...");
+            weatherManager.requestFetch(RADIO_PREFETCH_SLACK_MS);  // Next radio window, non-blocking
             lastPrefetchMinute = minutes;
             
             // Generate random trigger second from config range
@@ -256,7 +407,8 @@ void handleScheduledDisplay() {
     
     // Show weather at minutes 0, 5, 10, 15... at random second
     if ((minutes % 5 == 0) && minutes != lastTriggerMinute && !showingScheduledWeather) {
-        if (nextWeatherTriggerSecond >= 0 && seconds == nextWeatherTriggerSecond) {
+        // Fire at or after the trigger second (catches up if that second was missed)
+        if (nextWeatherTriggerSecond >= 0 && seconds >= nextWeatherTriggerSecond) {
             // Generate random duration from config range
             int durMin = configManager.getWeatherDurationMin();
             int durMax = configManager.getWeatherDurationMax();
@@ -267,8 +419,9 @@ void handleScheduledDisplay() {
             previousMode = currentMode;
             currentMode = MODE_WEATHER;
             showingScheduledWeather = true;
-            scheduledWeatherStart = millis();
+            scheduler.runAt(weatherEndTask, millis() + currentWeatherDuration);
             lastTriggerMinute = minutes;
+            nextWeatherTriggerSecond = -1;
         }
     }
     
@@ -276,9 +429,11 @@ void handleScheduledDisplay() {
     if (minutes % 5 != 0) {
         lastTriggerMinute = -1;
     }
-    
+}
+
+void endScheduledWeather() {
     // Return to previous mode after random duration
-    if (showingScheduledWeather && (millis() - scheduledWeatherStart >= currentWeatherDuration)) {
+    if (showingScheduledWeather) {
         Serial.println("Ending scheduled weather display");
         currentMode = previousMode;
         showingScheduledWeather = false;
@@ -287,9 +442,10 @@ void handleScheduledDisplay() {
 
 void displayTime() {
     char buffer[16];
-    int hours = timeManager.getHours();
-    int minutes = timeManager.getMinutes();
-    int seconds = timeManager.getSeconds();
+    const TimeSnapshot& now = timeManager.snapshot();
+    int hours = now.hours;
+    int minutes = now.minutes;
+    int seconds = now.seconds;
     
     // Format: "12:34" or "12:34:56" with optional seconds
     // Format: "12:34" or "12:34:56" with optional seconds
@@ -314,12 +470,16 @@ void displayTime() {
                  hours, colonOn ? ':' : ' ', minutes);
     }
     
-    display.clear();
-    display.print(buffer);
+#ifdef USE_MAX7219_DISPLAY
+    // Full-height digits for HH:MM (27 columns); print() condenses HH:MM:SS itself
+    display.setFont(configManager.getShowSeconds() ? FONT_5X7 : FONT_CLOCK);
+#endif
+    display.print(buffer);  // Only changed cells/rows are sent
 }
 
 void displayTimeWithSeconds() {
     char buffer[16];
+    const TimeSnapshot& now = timeManager.snapshot();
     
     // Determine activity state for blink rate
     bool showActivity = configManager.getShowActivityIndicators() && 
@@ -334,32 +494,37 @@ void displayTimeWithSeconds() {
         colonsOn = (millis() / 100) % 2;
         
         snprintf(buffer, sizeof(buffer), "%02d%c%02d%c%02d",
-                 timeManager.getHours(),
+                 now.hours,
                  colonsOn ? ':' : ' ',
-                 timeManager.getMinutes(),
+                 now.minutes,
                  colonsOn ? ':' : ' ',
-                 timeManager.getSeconds());
+                 now.seconds);
     } else {
         // Standard display: fixed colons
         snprintf(buffer, sizeof(buffer), "%02d:%02d:%02d",
-                 timeManager.getHours(),
-                 timeManager.getMinutes(),
-                 timeManager.getSeconds());
+                 now.hours,
+                 now.minutes,
+                 now.seconds);
     }
     
-    display.clear();
-    display.print(buffer);
+#ifdef USE_MAX7219_DISPLAY
+    display.setFont(FONT_5X7);  // 48 columns in 5x7, print() falls back to the narrow digits
+#endif
+    display.print(buffer);  // Only changed cells/rows are sent
 }
 
 void displayDate() {
     char buffer[16];
+    const TimeSnapshot& now = timeManager.snapshot();
     snprintf(buffer, sizeof(buffer), "%02d-%02d-%02d",
-             timeManager.getMonth(),
-             timeManager.getDay(),
-             timeManager.getYear() % 100);
+             now.month,
+             now.day,
+             (int)(now.year % 100));
     
-    display.clear();
-    display.print(buffer);
+#ifdef USE_MAX7219_DISPLAY
+    display.setFont(FONT_5X7);
+#endif
+    display.print(buffer);  // Only changed cells/rows are sent
 }
 
 void displayWeather() {
@@ -375,11 +540,32 @@ void displayWeather() {
         snprintf(buffer, sizeof(buffer), "WEATHER?");
     }
     
-    display.clear();
-    display.print(buffer);
+#ifdef USE_MAX7219_DISPLAY
+    display.setFont(FONT_5X7);
+#endif
+    display.print(buffer);  // Only changed cells/rows are sent
 }
 
 void handleSerialCommands() {
+    // Take what has arrived of an 'm' line; the rest is picked up on later polls
+    if (messageInputLen >= 0) {
+        while (Serial.available()) {
+            char c = Serial.read();
+            messageInputAt = millis();
+            if (c == '\n') {
+                finishMessageInput();
+                return;
+            }
+            if (messageInputLen < (int)sizeof(messageInput) - 1) {
+                messageInput[messageInputLen++] = c;
+            }
+        }
+        if (millis() - messageInputAt >= MESSAGE_INPUT_TIMEOUT) {
+            finishMessageInput();
+        }
+        return;
+    }
+    
     if (Serial.available()) {
         char cmd = Serial.read();
         switch (cmd) {
@@ -399,6 +585,10 @@ void handleSerialCommands() {
                 currentMode = MODE_WEATHER;
                 Serial.println("Mode: Weather");
                 break;
+            case 'm': // Message mode: rest of the line is the text
+                messageInputLen = 0;
+                messageInputAt = millis();
+                break;
             case '+': // Brightness up
                 display.setBrightness(min(255, display.getBrightness() + 16));
                 Serial.printf("Brightness: %d\n", display.getBrightness());
@@ -411,6 +601,113 @@ void handleSerialCommands() {
                 Serial.println("Resyncing time...");
                 timeManager.sync();
                 break;
+            case 'p': // Loop profiler report
+                printLoopMetrics();
+                break;
+            case 'n': // NTP sync history
+                printNtpStats();
+                break;
+            case 'P': // Reset loop profiler
+                loopProfiler.reset();
+                display.resetStats();
+                Serial.println("Loop metrics reset");
+                break;
         }
     }
 }
+
+void finishMessageInput() {
+    size_t len = messageInputLen;
+    messageInputLen = -1;
+    while (len > 0 && (messageInput[len - 1] == '\r' || messageInput[len - 1] == ' ')) {
+        len--;
+    }
+    messageInput[len] = '\0';
+    
+    // "m hello"
+    const char* text = messageInput[0] == ' ' ? messageInput + 1 : messageInput;
+    strncpy(customMessage, text, sizeof(customMessage) - 1);
+    currentMode = MODE_CUSTOM;
+    renderCurrentMode();
+    Serial.printf("Mode: Message \"%s\"\n", customMessage);
+}
+
+void printLoopMetrics() {
+    Serial.printf("Loop: %u iter/s @ %u MHz\n",
+                  (unsigned)loopProfiler.getLoopsPerSecond(), (unsigned)loopProfiler.getCpuMHz());
+    Serial.println("stage      count    min_us   p50_us   p90_us   p99_us   max_us   avg_us");
+    for (uint8_t i = 0; i < PROFILE_STAGE_COUNT; i++) {
+        const StageStats& s = loopProfiler.getStats(i);
+        if (s.count == 0) {
+            Serial.printf("%-8s %7u        -        -        -        -        -        -\n",
+                          LoopProfiler::stageName(i), 0U);
+            continue;
+        }
+        Serial.printf("%-8s %7u %8u %8u %8u %8u %8u %8u\n",
+                      LoopProfiler::stageName(i),
+                      (unsigned)s.count,
+                      (unsigned)loopProfiler.cyclesToMicros(s.minCycles),
+                      (unsigned)loopProfiler.cyclesToMicros(loopProfiler.percentileCycles(i, 50)),
+                      (unsigned)loopProfiler.cyclesToMicros(loopProfiler.percentileCycles(i, 90)),
+                      (unsigned)loopProfiler.cyclesToMicros(loopProfiler.percentileCycles(i, 99)),
+                      (unsigned)loopProfiler.cyclesToMicros(s.maxCycles),
+                      (unsigned)loopProfiler.cyclesToMicros(s.totalCycles / s.count));
+    }
+    
+    const DisplayStats& ds = display.getStats();
+    Serial.printf("Display: %u frames, %u pushed, %u bytes, %u transactions",
+                  (unsigned)ds.frames, (unsigned)ds.framesPushed,
+                  (unsigned)ds.bytesSent, (unsigned)ds.transactions);
+    if (ds.frames > 0) {
+        Serial.printf(" (%.1f bytes/frame, %.2f transactions/frame)",
+                      (float)ds.bytesSent / ds.frames, (float)ds.transactions / ds.frames);
+    }
+    Serial.println();
+    if (ds.busMicros > 0) {
+        Serial.printf("SPI bus: %u us busy, %.3f bytes/us\n",
+                      (unsigned)ds.busMicros, (float)ds.bytesSent / ds.busMicros);
+    }
+#ifdef USE_MAX7219_DISPLAY
+    const TextLayoutCache& layouts = display.getLayoutCache();
+    Serial.printf("Text layout: %u cached, %u measured\n",
+                  (unsigned)layouts.getHits(), (unsigned)layouts.getMisses());
+#endif
+    
+    if (radio.isEnabled()) {
+        const RadioHourStats& cur = radio.getHour(0);
+        Serial.printf("Radio: %s, this hour %u s awake in %u windows",
+                      radio.isAwake() ? "awake" : "sleeping",
+                      (unsigned)(cur.awakeMs / 1000), (unsigned)cur.windows);
+        if (radio.getHoursRecorded() > 0) {
+            const RadioHourStats& last = radio.getHour(1);
+            Serial.printf(", last hour %u s (%.1f%%)",
+                          (unsigned)(last.awakeMs / 1000), last.awakeMs * 100.0f / RADIO_HOUR_MS);
+        }
+        Serial.println();
+    }
+}
+
+void printNtpStats() {
+    const NtpStats& stats = timeManager.getStats();
+    Serial.printf("NTP: %u syncs, %u%% available, jitter %u ms, delay mean %ld / max %ld ms, poll 2^%u s (next in %lu s)\n",
+                  (unsigned)stats.getTotal(), stats.availabilityPercent(), (unsigned)stats.jitterMs(),
+                  (long)stats.meanDelayMs(), (long)stats.maxDelayMs(), timeManager.getPollExponent(),
+                  timeManager.getMillisUntilPoll() / 1000);
+    for (uint8_t i = 0; i < NTP_SYNC_OUTCOME_COUNT; i++) {
+        uint32_t n = stats.getOutcomeCount(i);
+        if (n > 0) {
+            Serial.printf("  %-12s %u\n", NtpStats::outcomeName(i), (unsigned)n);
+        }
+    }
+    
+    Serial.println("utc         offset_ms delay_ms server           outcome      corr  rep poll");
+    for (uint8_t i = 0; i < stats.count(); i++) {
+        const NtpSyncRecord& r = stats.get(i);
+        char server[16];
+        snprintf(server, sizeof(server), "%u.%u.%u.%u", r.server[0], r.server[1], r.server[2], r.server[3]);
+        Serial.printf("%-10lu %10ld %8ld %-16s %-12s %-5s %3u %4u\n",
+                      (unsigned long)r.utc, (long)r.offsetMs, (long)r.delayMs, server,
+                      NtpStats::outcomeName(r.outcome), NtpStats::correctionName(r.correction),
+                      r.replies, r.pollExponent);
+    }
+}
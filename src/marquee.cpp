@@ -0,0 +1,128 @@
+/**
+ * Marquee Implementation
+ *
+ * A view row is assembled from byte-wide reads at any bit offset, with
+ * the wrap from the gap back to the start of the text spliced in
+ */
+
+#include "marquee.h"
+#include "text_layout.h"
+
+#include <string.h>
+
+#define MICROS_PER_SECOND 1000000UL
+
+Marquee::Marquee()
+    : _font(nullptr), _width(0), _loop(1), _offset(0), _speed(0), _active(false),
+      _holding(false), _lastMicros(0), _holdMicros(0), _remainder(0), _passes(0) {
+    memset(_canvas, 0, sizeof(_canvas));
+    _text[0] = '\0';
+}
+
+uint16_t Marquee::setText(const char* text, const Font& font, uint16_t viewWidth) {
+    memset(_canvas, 0, sizeof(_canvas));
+    strncpy(_text, text, MARQUEE_MAX_TEXT);
+    _text[MARQUEE_MAX_TEXT] = '\0';
+    _font = &font;
+    _active = false;
+    _offset = 0;
+
+    uint16_t col = 0;
+    TextGlyph glyph;
+    while (*text && col < MARQUEE_MAX_COLS) {
+        textGlyph(font, (uint8_t)*text++, false, glyph);
+        uint8_t shift = col & 7;
+        uint16_t byte = col >> 3;
+        for (uint8_t row = 0; row < MARQUEE_ROWS; row++) {
+            uint8_t bits = fontRow(font, glyph.glyph, row);
+            _canvas[row][byte] |= bits >> shift;
+            if (shift && byte + 1 < MARQUEE_MAX_COLS / 8) {
+                _canvas[row][byte + 1] |= (uint8_t)(bits << (8 - shift));
+            }
+        }
+        col += glyph.advance;
+    }
+
+    _width = col < MARQUEE_MAX_COLS ? col : MARQUEE_MAX_COLS;
+    _loop = _width + viewWidth;
+    return _width;
+}
+
+bool Marquee::hasText(const char* text, const Font& font) const {
+    return _font == &font && strncmp(_text, text, MARQUEE_MAX_TEXT) == 0;
+}
+
+void Marquee::start(uint32_t nowMicros, uint16_t columnsPerSecond, uint16_t holdMs) {
+    _active = true;
+    _holding = holdMs > 0;
+    _holdMicros = (uint32_t)holdMs * 1000;
+    _lastMicros = nowMicros;
+    _speed = columnsPerSecond;
+    _remainder = 0;
+    _offset = 0;
+    _passes = 0;
+}
+
+bool Marquee::advance(uint32_t nowMicros) {
+    if (!_active || _speed == 0) {
+        return false;
+    }
+
+    if (_holding) {
+        if (nowMicros - _lastMicros < _holdMicros) {
+            return false;
+        }
+        _lastMicros += _holdMicros;
+        _holding = false;
+    }
+
+    // Whole columns elapsed since the last update; the fraction carries over
+    uint64_t scaled = (uint64_t)(nowMicros - _lastMicros) * _speed + _remainder;
+    _lastMicros = nowMicros;
+    uint32_t columns = (uint32_t)(scaled / MICROS_PER_SECOND);
+    _remainder = (uint32_t)(scaled % MICROS_PER_SECOND);
+    if (columns == 0) {
+        return false;
+    }
+
+    uint32_t position = _offset + columns;
+    _passes += position / _loop;
+    _offset = (uint16_t)(position % _loop);
+    return true;
+}
+
+uint8_t Marquee::readCanvas(uint8_t row, uint16_t col) const {
+    if (col >= _width) {
+        return 0;
+    }
+
+    uint16_t byte = col >> 3;
+    uint16_t window = (uint16_t)_canvas[row][byte] << 8;
+    if (byte + 1 < MARQUEE_MAX_COLS / 8) {
+        window |= _canvas[row][byte + 1];
+    }
+    uint8_t bits = (uint8_t)((window << (col & 7)) >> 8);
+
+    // Columns past the end of the text belong to the gap
+    if (col + 8 > _width) {
+        bits &= (uint8_t)(0xFF << (col + 8 - _width));
+    }
+    return bits;
+}
+
+void Marquee::window(uint8_t row, uint8_t* out, uint8_t bytes) const {
+    uint16_t col = _offset;
+    for (uint8_t i = 0; i < bytes; i++) {
+        uint8_t bits = readCanvas(row, col);
+
+        // Byte runs off the end of the loop: the rest comes from the start of the text
+        uint16_t toEnd = _loop - col;
+        if (toEnd < 8) {
+            bits |= readCanvas(row, 0) >> toEnd;
+        }
+        out[i] = bits;
+
+        col += 8;
+        if (col >= _loop) col -= _loop;
+    }
+}
@@ -0,0 +1,101 @@
+/**
+ * Marquee Header
+ *
+ * Scrolls text wider than the panel: the text is drawn once into an
+ * off-screen canvas (row-major, leftmost column in the MSB, like the
+ * MAX7219 framebuffer) and the panel shows a window into it that moves
+ * at a fixed number of columns per second. The position follows elapsed
+ * time rather than frame count, so late frames don't slow the scroll
+ */
+
+#ifndef MARQUEE_H
+#define MARQUEE_H
+
+#include <stdint.h>
+#include "font.h"
+
+// Canvas size (MARQUEE_MAX_COLS / 8 bytes per row)
+#ifndef MARQUEE_MAX_COLS
+#define MARQUEE_MAX_COLS 256
+#endif
+
+#define MARQUEE_ROWS 8
+
+// Longest text kept for comparison; longer text still scrolls
+#ifndef MARQUEE_MAX_TEXT
+#define MARQUEE_MAX_TEXT 47
+#endif
+
+class Marquee {
+public:
+    Marquee();
+
+    /**
+     * Draw text into the canvas and stop scrolling
+     * The text is followed by a blank gap as wide as the view, so it leaves the
+     * panel before coming round again
+     * @param viewWidth Columns the panel shows
+     * @return Columns the text takes (clipped to MARQUEE_MAX_COLS)
+     */
+    uint16_t setText(const char* text, const Font& font, uint16_t viewWidth);
+
+    /**
+     * Check if the canvas holds this text in this font
+     * (compared on the first MARQUEE_MAX_TEXT characters)
+     */
+    bool hasText(const char* text, const Font& font) const;
+
+    /**
+     * Start scrolling from the beginning of the text
+     * @param nowMicros Current time in us (micros())
+     * @param columnsPerSecond Scroll speed
+     * @param holdMs Time the start of the text stays put before moving
+     */
+    void start(uint32_t nowMicros, uint16_t columnsPerSecond, uint16_t holdMs);
+
+    void stop() { _active = false; }
+    bool isActive() const { return _active; }
+
+    /**
+     * Move the window to where it should be now
+     * @return true if it moved (the view needs redrawing)
+     */
+    bool advance(uint32_t nowMicros);
+
+    /**
+     * One row of the view at the current position
+     * @param out Row bytes, leftmost column in the MSB of out[0]
+     * @param bytes Bytes of out to fill (view width / 8)
+     */
+    void window(uint8_t row, uint8_t* out, uint8_t bytes) const;
+
+    uint16_t getOffset() const { return _offset; }
+    uint16_t getTextWidth() const { return _width; }
+
+    /**
+     * Times the text has gone all the way round
+     */
+    uint32_t getPasses() const { return _passes; }
+
+private:
+    uint8_t _canvas[MARQUEE_ROWS][MARQUEE_MAX_COLS / 8];
+    char _text[MARQUEE_MAX_TEXT + 1];
+    const Font* _font;
+    uint16_t _width;        // Text columns
+    uint16_t _loop;         // Text plus gap: the offset wraps here
+    uint16_t _offset;       // Canvas column at the left edge of the view
+    uint16_t _speed;        // Columns per second
+    bool _active;
+    bool _holding;
+    uint32_t _lastMicros;   // Time the position was last brought up to date
+    uint32_t _holdMicros;
+    uint32_t _remainder;    // Column fraction carried between updates (x 1e6)
+    uint32_t _passes;
+
+    /**
+     * 8 canvas columns starting at col (blank past the text)
+     */
+    uint8_t readCanvas(uint8_t row, uint16_t col) const;
+};
+
+#endif // MARQUEE_H
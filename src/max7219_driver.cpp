@@ -2,119 +2,20 @@
  * MAX7219 LED Matrix Driver Implementation
  *
  * Driver for 4x 8x8 LED Dot Matrix Display
- * Cascaded MAX7219 configuration with 5x7 font rendering
+ * Cascaded MAX7219 configuration with packed-atlas font rendering
+ * Glyph rows are copied into the row-major framebuffer with a shift; refresh
+ * maps each row byte through a bit-order table, so nothing is transposed per frame
  */
 
 #include "max7219_driver.h"
 
-// 5x7 Font - Each character is 5 columns wide
-// Data is rotated: each byte represents one column, LSB = top row
-static const uint8_t FONT_5X7[][5] PROGMEM = {
-    {0x00, 0x00, 0x00, 0x00, 0x00}, // Space (32)
-    {0x00, 0x00, 0x5F, 0x00, 0x00}, // !
-    {0x00, 0x07, 0x00, 0x07, 0x00}, // "
-    {0x14, 0x7F, 0x14, 0x7F, 0x14}, // #
-    {0x24, 0x2A, 0x7F, 0x2A, 0x12}, // $
-    {0x23, 0x13, 0x08, 0x64, 0x62}, // %
-    {0x36, 0x49, 0x55, 0x22, 0x50}, // &
-    {0x00, 0x05, 0x03, 0x00, 0x00}, // '
-    {0x00, 0x1C, 0x22, 0x41, 0x00}, // (
-    {0x00, 0x41, 0x22, 0x1C, 0x00}, // )
-    {0x08, 0x2A, 0x1C, 0x2A, 0x08}, // *
-    {0x08, 0x08, 0x3E, 0x08, 0x08}, // +
-    {0x00, 0x50, 0x30, 0x00, 0x00}, // ,
-    {0x08, 0x08, 0x08, 0x08, 0x08}, // -
-    {0x00, 0x60, 0x60, 0x00, 0x00}, // .
-    {0x20, 0x10, 0x08, 0x04, 0x02}, // /
-    {0x3E, 0x51, 0x49, 0x45, 0x3E}, // 0
-    {0x00, 0x42, 0x7F, 0x40, 0x00}, // 1
-    {0x42, 0x61, 0x51, 0x49, 0x46}, // 2
-    {0x21, 0x41, 0x45, 0x4B, 0x31}, // 3
-    {0x18, 0x14, 0x12, 0x7F, 0x10}, // 4
-    {0x27, 0x45, 0x45, 0x45, 0x39}, // 5
-    {0x3C, 0x4A, 0x49, 0x49, 0x30}, // 6
-    {0x01, 0x71, 0x09, 0x05, 0x03}, // 7
-    {0x36, 0x49, 0x49, 0x49, 0x36}, // 8
-    {0x06, 0x49, 0x49, 0x29, 0x1E}, // 9
-    {0x00, 0x36, 0x36, 0x00, 0x00}, // :
-    {0x00, 0x56, 0x36, 0x00, 0x00}, // ;
-    {0x00, 0x08, 0x14, 0x22, 0x41}, // <
-    {0x14, 0x14, 0x14, 0x14, 0x14}, // =
-    {0x41, 0x22, 0x14, 0x08, 0x00}, // >
-    {0x02, 0x01, 0x51, 0x09, 0x06}, // ?
-    {0x32, 0x49, 0x79, 0x41, 0x3E}, // @
-    {0x7E, 0x11, 0x11, 0x11, 0x7E}, // A
-    {0x7F, 0x49, 0x49, 0x49, 0x36}, // B
-    {0x3E, 0x41, 0x41, 0x41, 0x22}, // C
-    {0x7F, 0x41, 0x41, 0x22, 0x1C}, // D
-    {0x7F, 0x49, 0x49, 0x49, 0x41}, // E
-    {0x7F, 0x09, 0x09, 0x01, 0x01}, // F
-    {0x3E, 0x41, 0x41, 0x51, 0x32}, // G
-    {0x7F, 0x08, 0x08, 0x08, 0x7F}, // H
-    {0x00, 0x41, 0x7F, 0x41, 0x00}, // I
-    {0x20, 0x40, 0x41, 0x3F, 0x01}, // J
-    {0x7F, 0x08, 0x14, 0x22, 0x41}, // K
-    {0x7F, 0x40, 0x40, 0x40, 0x40}, // L
-    {0x7F, 0x02, 0x04, 0x02, 0x7F}, // M
-    {0x7F, 0x04, 0x08, 0x10, 0x7F}, // N
-    {0x3E, 0x41, 0x41, 0x41, 0x3E}, // O
-    {0x7F, 0x09, 0x09, 0x09, 0x06}, // P
-    {0x3E, 0x41, 0x51, 0x21, 0x5E}, // Q
-    {0x7F, 0x09, 0x19, 0x29, 0x46}, // R
-    {0x46, 0x49, 0x49, 0x49, 0x31}, // S
-    {0x01, 0x01, 0x7F, 0x01, 0x01}, // T
-    {0x3F, 0x40, 0x40, 0x40, 0x3F}, // U
-    {0x1F, 0x20, 0x40, 0x20, 0x1F}, // V
-    {0x7F, 0x20, 0x18, 0x20, 0x7F}, // W
-    {0x63, 0x14, 0x08, 0x14, 0x63}, // X
-    {0x03, 0x04, 0x78, 0x04, 0x03}, // Y
-    {0x61, 0x51, 0x49, 0x45, 0x43}, // Z
-    {0x00, 0x00, 0x7F, 0x41, 0x41}, // [
-    {0x02, 0x04, 0x08, 0x10, 0x20}, // backslash
-    {0x41, 0x41, 0x7F, 0x00, 0x00}, // ]
-    {0x04, 0x02, 0x01, 0x02, 0x04}, // ^
-    {0x40, 0x40, 0x40, 0x40, 0x40}, // _
-    {0x00, 0x01, 0x02, 0x04, 0x00}, // `
-    {0x20, 0x54, 0x54, 0x54, 0x78}, // a
-    {0x7F, 0x48, 0x44, 0x44, 0x38}, // b
-    {0x38, 0x44, 0x44, 0x44, 0x20}, // c
-    {0x38, 0x44, 0x44, 0x48, 0x7F}, // d
-    {0x38, 0x54, 0x54, 0x54, 0x18}, // e
-    {0x08, 0x7E, 0x09, 0x01, 0x02}, // f
-    {0x08, 0x14, 0x54, 0x54, 0x3C}, // g
-    {0x7F, 0x08, 0x04, 0x04, 0x78}, // h
-    {0x00, 0x44, 0x7D, 0x40, 0x00}, // i
-    {0x20, 0x40, 0x44, 0x3D, 0x00}, // j
-    {0x00, 0x7F, 0x10, 0x28, 0x44}, // k
-    {0x00, 0x41, 0x7F, 0x40, 0x00}, // l
-    {0x7C, 0x04, 0x18, 0x04, 0x78}, // m
-    {0x7C, 0x08, 0x04, 0x04, 0x78}, // n
-    {0x38, 0x44, 0x44, 0x44, 0x38}, // o
-    {0x7C, 0x14, 0x14, 0x14, 0x08}, // p
-    {0x08, 0x14, 0x14, 0x18, 0x7C}, // q
-    {0x7C, 0x08, 0x04, 0x04, 0x08}, // r
-    {0x48, 0x54, 0x54, 0x54, 0x20}, // s
-    {0x04, 0x3F, 0x44, 0x40, 0x20}, // t
-    {0x3C, 0x40, 0x40, 0x20, 0x7C}, // u
-    {0x1C, 0x20, 0x40, 0x20, 0x1C}, // v
-    {0x3C, 0x40, 0x30, 0x40, 0x3C}, // w
-    {0x44, 0x28, 0x10, 0x28, 0x44}, // x
-    {0x0C, 0x50, 0x50, 0x50, 0x3C}, // y
-    {0x44, 0x64, 0x54, 0x4C, 0x44}, // z
-    {0x00, 0x08, 0x36, 0x41, 0x00}, // {
-    {0x00, 0x00, 0x7F, 0x00, 0x00}, // |
-    {0x00, 0x41, 0x36, 0x08, 0x00}, // }
-    {0x08, 0x08, 0x2A, 0x1C, 0x08}, // -> (126)
-    {0x08, 0x1C, 0x2A, 0x08, 0x08}, // <- (127)
-};
-
-// Character width (all 5 for this font, but kept for future variable-width)
-#define CHAR_WIDTH 5
-#define CHAR_SPACING 1
-
 MAX7219Driver::MAX7219Driver()
-    : _brightness(128), _cursorCol(0), _initialized(false), _rotated(false) {
-    memset(_framebuffer, 0, sizeof(_framebuffer));
+    : _brightness(128), _cursorCol(0), _initialized(false), _rotated(false),
+      _font(&FONT_5X7), _condensed(&FONT_NARROW), _align(MAX7219_TEXT_ALIGN),
+      _scrollSpeed(MAX7219_SCROLL_SPEED), _canvas(_canvasWords, MAX7219_TOTAL_COLS, MAX7219_ROWS),
+      _shadowValid(false), _bitOrder(ROW_BIT_ORDER[0]) {
+    memset(_rows, 0, sizeof(_rows));
+    memset(_shadow, 0, sizeof(_shadow));
 }
 
 void MAX7219Driver::begin() {
@@ -134,6 +35,7 @@ void MAX7219Driver::begin() {
     sendToAll(MAX7219_REG_SHUTDOWN, 0x01);     // Normal operation (not shutdown)
     
     setBrightness(_brightness);
+    invalidate();  // Digit registers are undefined after power-up
     clear();
     
     _initialized = true;
@@ -141,7 +43,8 @@ void MAX7219Driver::begin() {
 }
 
 void MAX7219Driver::clear() {
-    memset(_framebuffer, 0, sizeof(_framebuffer));
+    _marquee.stop();
+    memset(_rows, 0, sizeof(_rows));
     refresh();
     _cursorCol = 0;
 }
@@ -165,122 +68,223 @@ void MAX7219Driver::setCursor(uint8_t position) {
 }
 
 void MAX7219Driver::print(const char* text) {
-    clear();
-    _cursorCol = 0;
+    // Measured once per distinct string; the clock's text changes at most once a second
+    const TextFit& fit = _layouts.fit(text, *_font, _condensed, MAX7219_TOTAL_COLS, _align);
     
+    if (!fit.fits) {
+        // Scrolled in the primary font, which reads better in motion than the condensed one
+        if (!_marquee.isActive() || !_marquee.hasText(text, *_font)) {
+            _marquee.setText(text, *_font, MAX7219_TOTAL_COLS);
+            _marquee.start(micros(), _scrollSpeed, MAX7219_SCROLL_HOLD_MS);
+            drawScroll();
+        }
+        return;
+    }
+    _marquee.stop();
+    
+    // Compose the whole frame off-screen, then push it once
+    memset(_rows, 0, sizeof(_rows));
+    _cursorCol = fit.x;
+    
+    TextGlyph glyph;
     while (*text && _cursorCol < MAX7219_TOTAL_COLS) {
-        printChar(*text);
+        textGlyph(*fit.font, (uint8_t)*text, fit.narrowPunctuation, glyph);
+        drawGlyph(*fit.font, glyph);
         text++;
     }
     
     refresh();
 }
 
-void MAX7219Driver::printChar(char c) {
-    uint8_t width;
-    const uint8_t* glyph = getGlyph(c, width);
+bool MAX7219Driver::updateScroll() {
+    if (!_marquee.advance(micros())) {
+        return false;
+    }
     
-    // Copy glyph columns to framebuffer
-    for (uint8_t i = 0; i < width && _cursorCol < MAX7219_TOTAL_COLS; i++) {
-        _framebuffer[_cursorCol++] = pgm_read_byte(&glyph[i]);
+    drawScroll();
+    return true;
+}
+
+void MAX7219Driver::drawScroll() {
+    // The view is whole bytes of the canvas; refresh() sends only the rows that moved
+    for (uint8_t row = 0; row < MAX7219_ROWS; row++) {
+        _marquee.window(row, _rows[row], MAX7219_NUM_MODULES);
+    }
+    _cursorCol = MAX7219_TOTAL_COLS;
+    refresh();
+}
+
+void MAX7219Driver::present() {
+    if (!_canvas.isDirty()) {
+        return;
     }
     
-    // Add spacing between characters
-    if (_cursorCol < MAX7219_TOTAL_COLS) {
-        _framebuffer[_cursorCol++] = 0x00;
+    _marquee.stop();
+    
+    // Dirty columns of each module the region covers; refresh() then sends only the rows that changed
+    const CanvasRect& dirty = _canvas.getDirty();
+    uint8_t first = dirty.x / MAX7219_COLS_PER_MODULE;
+    uint8_t last = (dirty.x + dirty.width - 1) / MAX7219_COLS_PER_MODULE;
+    for (uint8_t module = first; module <= last; module++) {
+        int16_t left = module * MAX7219_COLS_PER_MODULE;
+        uint8_t mask = 0xFF;
+        if (dirty.x > left) {
+            mask >>= dirty.x - left;
+        }
+        if (dirty.x + dirty.width < left + MAX7219_COLS_PER_MODULE) {
+            mask &= (uint8_t)(0xFF << (left + MAX7219_COLS_PER_MODULE - dirty.x - dirty.width));
+        }
+        
+        for (int16_t row = dirty.y; row < dirty.y + dirty.height; row++) {
+            uint8_t bits = _canvas.readByte(left, row);
+            _rows[row][module] = (_rows[row][module] & ~mask) | (bits & mask);
+        }
     }
+    
+    _canvas.clearDirty();
+    refresh();
+}
+
+void MAX7219Driver::printChar(char c) {
+    if (_cursorCol >= MAX7219_TOTAL_COLS) {
+        return;
+    }
+    
+    // Characters the font lacks draw as its fallback glyph (space)
+    TextGlyph glyph;
+    textGlyph(*_font, (uint8_t)c, false, glyph);
+    drawGlyph(*_font, glyph);
+}
+
+void MAX7219Driver::drawGlyph(const Font& font, const TextGlyph& glyph) {
+    // The cell (glyph plus spacing) replaces what was there; columns past the edge drop off
+    uint8_t mask = (uint8_t)(0xFF << (8 - glyph.advance));
+    for (uint8_t row = 0; row < MAX7219_ROWS; row++) {
+        uint8_t bits = (uint8_t)(fontRow(font, glyph.glyph, row) << glyph.skip);
+        writeRowBits(row, _cursorCol, bits, mask);
+    }
+    
+    _cursorCol += glyph.advance;
 }
 
 void MAX7219Driver::setColumn(uint8_t col, uint8_t data) {
-    if (col < MAX7219_TOTAL_COLS) {
-        _framebuffer[col] = data;
+    if (col >= MAX7219_TOTAL_COLS) {
+        return;
+    }
+    
+    // Bit r of data is row r (LSB = top row)
+    for (uint8_t row = 0; row < MAX7219_ROWS; row++) {
+        writeRowBits(row, col, ((data >> row) & 1) ? 0x80 : 0x00, 0x80);
+    }
+}
+
+void MAX7219Driver::writeRowBits(uint8_t row, uint8_t col, uint8_t bits, uint8_t mask) {
+    uint8_t* line = _rows[row];
+    uint8_t module = col / MAX7219_COLS_PER_MODULE;
+    uint8_t shift = col % MAX7219_COLS_PER_MODULE;
+    
+    // A byte at an arbitrary column straddles at most two modules
+    line[module] = (line[module] & ~(mask >> shift)) | (bits >> shift);
+    if (shift && module + 1 < MAX7219_NUM_MODULES) {
+        uint8_t spill = 8 - shift;
+        line[module + 1] = (line[module + 1] & ~(uint8_t)(mask << spill)) | (uint8_t)(bits << spill);
     }
 }
 
 void MAX7219Driver::refresh() {
-    // Send framebuffer to display
-    // MAX7219 is organized by rows, but our framebuffer is by columns
-    // Need to transpose and send row by row
+    _stats.frames++;
     
-    for (uint8_t row = 0; row < 8; row++) {
-        SPI.beginTransaction(SPISettings(10000000, MSBFIRST, SPI_MODE0));
-        digitalWrite(MAX7219_PIN_CS, LOW);
+    // Register value of every module's rows, compared against what each is showing
+    // Flipped: modules and rows come in reverse order and each row byte is bit-reversed
+    uint8_t changedRows[MAX7219_NUM_MODULES];
+    uint8_t dirtyRows = 0;
+    
+    for (uint8_t module = 0; module < MAX7219_NUM_MODULES; module++) {
+        changedRows[module] = 0;
+        uint8_t srcModule = _rotated ? (MAX7219_NUM_MODULES - 1 - module) : module;
         
-        // When rotated 180 degrees, we invert row index and reverse bit order
-        uint8_t displayRow = _rotated ? (7 - row) : row;
+        for (uint8_t row = 0; row < MAX7219_ROWS; row++) {
+            uint8_t srcRow = _rotated ? (MAX7219_ROWS - 1 - row) : row;
+            uint8_t value = pgm_read_byte(&_bitOrder[_rows[srcRow][srcModule]]);
+            
+            if (!_shadowValid || value != _shadow[row][module]) {
+                _shadow[row][module] = value;
+                changedRows[module] |= (1 << row);
+            }
+        }
+        
+        dirtyRows |= changedRows[module];
+    }
+    
+    // One transaction per dirty row; modules whose row is unchanged get a NOOP
+    uint8_t chain[MAX7219_CHAIN_BYTES];
+    for (uint8_t row = 0; row < MAX7219_ROWS; row++) {
+        if (!(dirtyRows & (1 << row))) {
+            continue;
+        }
         
-        // Send data to each module in chain (last module first in data stream)
+        // Last module in the chain is shifted out first
+        uint8_t* p = chain;
         for (int8_t module = MAX7219_NUM_MODULES - 1; module >= 0; module--) {
-            uint8_t rowData = 0;
-            
-            // When rotated, reverse the module order
-            int8_t srcModule = _rotated ? (MAX7219_NUM_MODULES - 1 - module) : module;
-            
-            // Build row data from framebuffer columns
-            // Each module handles 8 columns
-            for (uint8_t col = 0; col < 8; col++) {
-                // When rotated, reverse column order within module
-                uint8_t srcCol = _rotated ? (7 - col) : col;
-                uint8_t fbCol = srcModule * 8 + srcCol;
-                
-                if (_framebuffer[fbCol] & (1 << displayRow)) {
-                    rowData |= (1 << (7 - col));  // Reverse bit order for display
-                }
+            if (changedRows[module] & (1 << row)) {
+                *p++ = MAX7219_REG_DIGIT0 + row;
+                *p++ = _shadow[row][module];
+            } else {
+                *p++ = MAX7219_REG_NOOP;
+                *p++ = 0;
             }
-            
-            SPI.transfer(MAX7219_REG_DIGIT0 + row);  // Row register
-            SPI.transfer(rowData);
         }
         
-        digitalWrite(MAX7219_PIN_CS, HIGH);
-        SPI.endTransaction();
+        writeChain(chain);
+    }
+    
+    _shadowValid = true;
+    
+    if (dirtyRows) {
+        _stats.framesPushed++;
     }
 }
 
+void MAX7219Driver::invalidate() {
+    _shadowValid = false;
+}
+
 void MAX7219Driver::setRotation(bool flipped) {
     _rotated = flipped;
+    _bitOrder = ROW_BIT_ORDER[flipped ? 1 : 0];
     refresh();  // Update display with new rotation
 }
 
 void MAX7219Driver::sendToAll(uint8_t reg, uint8_t data) {
-    SPI.beginTransaction(SPISettings(10000000, MSBFIRST, SPI_MODE0));
-    digitalWrite(MAX7219_PIN_CS, LOW);
-    
+    uint8_t chain[MAX7219_CHAIN_BYTES];
     for (uint8_t i = 0; i < MAX7219_NUM_MODULES; i++) {
-        SPI.transfer(reg);
-        SPI.transfer(data);
+        chain[2 * i] = reg;
+        chain[2 * i + 1] = data;
     }
-    
-    digitalWrite(MAX7219_PIN_CS, HIGH);
-    SPI.endTransaction();
+    writeChain(chain);
 }
 
 void MAX7219Driver::sendToModule(uint8_t module, uint8_t reg, uint8_t data) {
-    SPI.beginTransaction(SPISettings(10000000, MSBFIRST, SPI_MODE0));
-    digitalWrite(MAX7219_PIN_CS, LOW);
-    
+    uint8_t chain[MAX7219_CHAIN_BYTES];
     for (uint8_t i = 0; i < MAX7219_NUM_MODULES; i++) {
-        if (i == module) {
-            SPI.transfer(reg);
-            SPI.transfer(data);
-        } else {
-            SPI.transfer(MAX7219_REG_NOOP);
-            SPI.transfer(0);
-        }
+        chain[2 * i] = (i == module) ? reg : MAX7219_REG_NOOP;
+        chain[2 * i + 1] = (i == module) ? data : 0;
     }
-    
-    digitalWrite(MAX7219_PIN_CS, HIGH);
-    SPI.endTransaction();
+    writeChain(chain);
 }
 
-const uint8_t* MAX7219Driver::getGlyph(char c, uint8_t& width) {
-    width = CHAR_WIDTH;
+void MAX7219Driver::writeChain(const uint8_t* chain) {
+    SPI.beginTransaction(SPISettings(MAX7219_SPI_SPEED, MSBFIRST, SPI_MODE0));
+    digitalWrite(MAX7219_PIN_CS, LOW);
+    unsigned long start = micros();
     
-    // Map character to font index
-    if (c >= 32 && c <= 127) {
-        return FONT_5X7[c - 32];
-    }
+    // Whole chain goes through the hardware FIFO in one call
+    SPI.writeBytes(chain, MAX7219_CHAIN_BYTES);
+    
+    _stats.busMicros += micros() - start;
+    digitalWrite(MAX7219_PIN_CS, HIGH);
+    SPI.endTransaction();
     
-    // Return space for unknown characters
-    return FONT_5X7[0];
+    _stats.transactions++;
+    _stats.bytesSent += MAX7219_CHAIN_BYTES;
 }
@@ -3,6 +3,10 @@
  *
  * Driver for 4x 8x8 LED Dot Matrix Display with MAX7219 controller
  * Uses SPI interface, cascaded configuration
+ * The framebuffer is kept row-major, in the layout the row registers take
+ * print() lays text out through text_layout.h, so it fits the panel when it can,
+ * and scrolls it through a Marquee when it can't
+ * getCanvas() draws into a 32x8 Canvas that present() copies over the framebuffer
  */
 
 #ifndef MAX7219_DRIVER_H
@@ -10,6 +14,9 @@
 
 #include "config.h"
 #include "display_driver.h"
+#include "max7219_font.h"
+#include "text_layout.h"
+#include "marquee.h"
 #include <Arduino.h>
 #include <SPI.h>
 
@@ -34,10 +41,14 @@
 #define MAX7219_NUM_MODULES 4
 #endif
 
-// Each module is 8 columns wide
+// Each module is 8 columns wide and 8 rows tall
 #define MAX7219_COLS_PER_MODULE 8
+#define MAX7219_ROWS 8
 #define MAX7219_TOTAL_COLS (MAX7219_NUM_MODULES * MAX7219_COLS_PER_MODULE)
 
+// One register write (address + data) per module per transaction
+#define MAX7219_CHAIN_BYTES (2 * MAX7219_NUM_MODULES)
+
 class MAX7219Driver : public DisplayDriver {
 public:
     MAX7219Driver();
@@ -66,6 +77,9 @@ public:
     
     /**
      * Print a string to the display
+     * Falls back to narrow punctuation and the condensed font when the text is
+     * wider than the panel, then aligns it; text that still doesn't fit scrolls
+     * (see updateScroll()). Printing the text that is already scrolling leaves it be
      * @param text String to display
      */
     void print(const char* text) override;
@@ -82,6 +96,62 @@ public:
      */
     void printChar(char c) override;
     
+    /**
+     * Select the font later print()/printChar() calls draw with
+     * @param font One of the atlases in max7219_font.h (FONT_5X7 by default)
+     */
+    void setFont(const Font& font) { _font = &font; }
+    
+    /**
+     * Get the current font
+     */
+    const Font& getFont() const { return *_font; }
+    
+    /**
+     * Select the font print() falls back to for text too wide for the panel
+     * @param font Condensed font (FONT_NARROW by default), or nullptr for none
+     */
+    void setCondensedFont(const Font* font) { _condensed = font; }
+    
+    /**
+     * Set where print() places text that fits (MAX7219_TEXT_ALIGN by default)
+     */
+    void setAlign(TextAlign align) { _align = align; }
+    
+    /**
+     * Set how fast text wider than the panel scrolls
+     * @param columnsPerSecond Speed (MAX7219_SCROLL_SPEED by default)
+     */
+    void setScrollSpeed(uint16_t columnsPerSecond) { _scrollSpeed = columnsPerSecond; }
+    
+    /**
+     * Check if print() left text scrolling
+     */
+    bool isScrolling() const { return _marquee.isActive(); }
+    
+    /**
+     * Move scrolling text to where it should be now and push the rows that changed
+     * Call at the frame rate; the position follows micros(), not the call count
+     * @return true if the view moved
+     */
+    bool updateScroll();
+    
+    /**
+     * Get the layout cache (hit/miss counters)
+     */
+    const TextLayoutCache& getLayoutCache() const { return _layouts; }
+    
+    /**
+     * Get the 32x8 pixel canvas
+     */
+    Canvas* getCanvas() override { return &_canvas; }
+    
+    /**
+     * Copy the region the canvas changed into the framebuffer and refresh
+     * Stops any scrolling text, which would otherwise draw over it
+     */
+    void present() override;
+    
     /**
      * Set a specific column of LEDs
      * @param col Column index (0-31)
@@ -96,6 +166,7 @@ public:
     
     /**
      * Set display rotation
+     * Swaps the row bit-order table; the framebuffer itself is not touched
      * @param flipped true = 180 degree rotation
      */
     void setRotation(bool flipped) override;
@@ -105,15 +176,38 @@ public:
      * @return true if display is flipped 180 degrees
      */
     bool isRotated() const override { return _rotated; }
+    
+    /**
+     * Forget the shadow rows so the next refresh rewrites every row
+     */
+    void invalidate() override;
 
 private:
     uint8_t _brightness;
     uint8_t _cursorCol;
     bool _initialized;
     bool _rotated;
+    const Font* _font;
+    const Font* _condensed;
+    TextAlign _align;
+    TextLayoutCache _layouts;
+    Marquee _marquee;
+    uint16_t _scrollSpeed;
+    
+    // Framebuffer: 8 rows x 32 columns, one byte per module per row
+    // Leftmost column is the MSB of byte 0, as the row registers take it upright
+    uint8_t _rows[MAX7219_ROWS][MAX7219_NUM_MODULES];
+    
+    // Canvas storage must be declared ahead of the canvas that clears it
+    uint32_t _canvasWords[MAX7219_ROWS * CANVAS_STRIDE(MAX7219_TOTAL_COLS)];
+    Canvas _canvas;
     
-    // Framebuffer: 8 rows x 32 columns (4 modules)
-    uint8_t _framebuffer[MAX7219_TOTAL_COLS];
+    // Register values the modules are showing (chain order), used to skip unchanged rows
+    uint8_t _shadow[MAX7219_ROWS][MAX7219_NUM_MODULES];
+    bool _shadowValid;
+    
+    // Row byte -> register value for the current orientation (PROGMEM table)
+    const uint8_t* _bitOrder;
     
     /**
      * Send command to all modules
@@ -131,12 +225,28 @@ private:
     void sendToModule(uint8_t module, uint8_t reg, uint8_t data);
     
     /**
-     * Get character glyph from font
-     * @param c Character
-     * @param width Output: width of character
-     * @return Pointer to glyph data
+     * Clock one register write per module out in a single burst
+     * @param chain MAX7219_CHAIN_BYTES bytes, last module in the chain first
+     */
+    void writeChain(const uint8_t* chain);
+    
+    /**
+     * Replace the masked bits of a framebuffer row, starting at a column
+     * @param bits Row bits, leftmost column in the MSB
+     * @param mask Bits to replace, same alignment
      */
-    const uint8_t* getGlyph(char c, uint8_t& width);
+    void writeRowBits(uint8_t row, uint8_t col, uint8_t bits, uint8_t mask);
+    
+    /**
+     * Draw a glyph at the cursor and advance past it
+     */
+    void drawGlyph(const Font& font, const TextGlyph& glyph);
+    
+    /**
+     * Copy the marquee's view into the framebuffer and refresh
+     */
+    void drawScroll();
+
 };
 
 #endif // MAX7219_DRIVER_H
@@ -0,0 +1,170 @@
+/**
+ * MAX7219 Fonts
+ *
+ * Generated by scripts/gen_font.py from fonts/fonts.json - do not edit
+ */
+
+#include "max7219_font.h"
+
+static const uint8_t FONT_5X7_BITMAP[] PROGMEM = {
+    0x00, 0x00, 0x00, 0x00, 0x04, 0x21, 0x08, 0x40, 0x11, 0x4A, 0x50, 0x00, 0x00, 0x29, 0x5F, 0x57,
+    0xD4, 0xA2, 0x3E, 0x8E, 0x2F, 0x89, 0x8C, 0x88, 0x88, 0x98, 0xD9, 0x2A, 0x22, 0xB2, 0x6B, 0x08,
+    0x80, 0x00, 0x00, 0x11, 0x10, 0x84, 0x10, 0x48, 0x20, 0x84, 0x22, 0x20, 0x0A, 0x27, 0xC8, 0xA0,
+    0x00, 0x84, 0xF9, 0x08, 0x00, 0x00, 0x00, 0x61, 0x10, 0x00, 0x03, 0xE0, 0x00, 0x00, 0x00, 0x00,
+    0x0C, 0x60, 0x02, 0x22, 0x22, 0x00, 0x74, 0x67, 0x5C, 0xC5, 0xC4, 0x61, 0x08, 0x42, 0x39, 0xD1,
+    0x08, 0x88, 0x8F, 0xFC, 0x44, 0x10, 0x62, 0xE1, 0x19, 0x52, 0xF8, 0x85, 0xF8, 0x78, 0x21, 0x8B,
+    0x8C, 0x88, 0x7A, 0x31, 0x77, 0xC2, 0x22, 0x21, 0x08, 0x74, 0x62, 0xE8, 0xC5, 0xCE, 0x8C, 0x5E,
+    0x11, 0x30, 0x0C, 0x60, 0x18, 0xC0, 0x01, 0x8C, 0x03, 0x08, 0x80, 0x88, 0x88, 0x20, 0x82, 0x00,
+    0x7C, 0x1F, 0x00, 0x20, 0x82, 0x08, 0x88, 0x83, 0xA2, 0x11, 0x10, 0x04, 0x74, 0x42, 0xDA, 0xD5,
+    0xCE, 0x8C, 0x63, 0xF8, 0xC7, 0xD1, 0x8F, 0xA3, 0x1F, 0x3A, 0x30, 0x84, 0x22, 0xEE, 0x4A, 0x31,
+    0x8C, 0xB9, 0xF8, 0x43, 0xD0, 0x87, 0xFF, 0x08, 0x72, 0x10, 0x83, 0xA3, 0x08, 0x4E, 0x2E, 0x8C,
+    0x63, 0xF8, 0xC6, 0x2E, 0x21, 0x08, 0x42, 0x38, 0xE2, 0x10, 0x85, 0x26, 0x46, 0x54, 0xC5, 0x25,
+    0x18, 0x42, 0x10, 0x84, 0x3F, 0x1D, 0xD6, 0x31, 0x8C, 0x63, 0x1C, 0xD6, 0x71, 0x8B, 0xA3, 0x18,
+    0xC6, 0x2E, 0xF4, 0x63, 0xE8, 0x42, 0x0E, 0x8C, 0x63, 0x59, 0x37, 0xD1, 0x8F, 0xA9, 0x28, 0xBE,
+    0x10, 0x70, 0x43, 0xEF, 0x90, 0x84, 0x21, 0x09, 0x18, 0xC6, 0x31, 0x8B, 0xA3, 0x18, 0xC6, 0x2A,
+    0x24, 0x63, 0x1A, 0xD7, 0x71, 0x8C, 0x54, 0x45, 0x46, 0x31, 0x8A, 0x88, 0x42, 0x13, 0xE1, 0x11,
+    0x11, 0x0F, 0x9C, 0x84, 0x21, 0x08, 0x70, 0x41, 0x04, 0x10, 0x41, 0xC2, 0x10, 0x84, 0x27, 0x08,
+    0xA8, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F, 0x41, 0x04, 0x00, 0x00, 0x00, 0x03, 0x82, 0xF8,
+    0xBE, 0x10, 0xB6, 0x63, 0x1F, 0x00, 0x0E, 0x84, 0x22, 0xE0, 0x85, 0xB3, 0x8C, 0x5E, 0x00, 0x3A,
+    0x3F, 0x83, 0x8C, 0x94, 0x71, 0x08, 0x40, 0x00, 0xF8, 0xBC, 0x26, 0x84, 0x2D, 0x98, 0xC6, 0x24,
+    0x03, 0x08, 0x42, 0x38, 0x40, 0x30, 0x85, 0x26, 0x21, 0x09, 0x53, 0x14, 0x96, 0x10, 0x84, 0x21,
+    0x1C, 0x00, 0x6A, 0xB5, 0x8C, 0x40, 0x0B, 0x66, 0x31, 0x88, 0x00, 0xE8, 0xC6, 0x2E, 0x00, 0x3D,
+    0x1F, 0x42, 0x00, 0x03, 0x66, 0xF0, 0x84, 0x00, 0xB6, 0x61, 0x08, 0x00, 0x0E, 0x83, 0x83, 0xE4,
+    0x23, 0x88, 0x42, 0x4C, 0x00, 0x46, 0x31, 0x9B, 0x40, 0x08, 0xC6, 0x2A, 0x20, 0x01, 0x18, 0xD6,
+    0xAA, 0x00, 0x22, 0xA2, 0x2A, 0x20, 0x04, 0x62, 0xF0, 0xB8, 0x00, 0xF8, 0x88, 0x8F, 0x88, 0x84,
+    0x41, 0x08, 0x22, 0x10, 0x84, 0x21, 0x08, 0x82, 0x10, 0x44, 0x22, 0x00, 0x41, 0x7C, 0x44, 0x00,
+    0x08, 0x8F, 0xA0, 0x80, 0x00,
+};
+static const FontRange FONT_5X7_RANGES[] PROGMEM = {
+    {32, 127, 0},
+};
+const Font FONT_5X7 = {FONT_5X7_BITMAP, nullptr, FONT_5X7_RANGES, 1, 7, 5, 6, 0};
+
+static const uint8_t FONT_NARROW_BITMAP[] PROGMEM = {
+    0xA5, 0x25, 0x28, 0x03, 0x80, 0x00, 0x92, 0x92, 0x93, 0xDB, 0x6D, 0xEB, 0x24, 0x97, 0xE4, 0xF9,
+    0x3F, 0x27, 0x93, 0xED, 0xBC, 0x93, 0xE4, 0xE4, 0xFF, 0x27, 0xB7, 0xF2, 0x4A, 0x4B, 0xDB, 0xED,
+    0xFE, 0xDE, 0x4F, 0x29, 0x89, 0x48, 0x25, 0x6F, 0xB6, 0xEB, 0x75, 0xB9, 0xC9, 0x24, 0x7A, 0xDB,
+    0x6E, 0xF2, 0x69, 0x3F, 0x93, 0x49, 0x1C, 0x96, 0xD7, 0x6D, 0xF6, 0xDE, 0x92, 0x4B, 0x92, 0x49,
+    0xAA, 0xDD, 0x35, 0xB2, 0x49, 0x27, 0x8E, 0xEB, 0x58, 0xC6, 0x33, 0xBB, 0x77, 0x32, 0xAD, 0xB6,
+    0xAD, 0x6E, 0x92, 0x2B, 0x6D, 0xCF, 0x5B, 0xB5, 0xAE, 0x44, 0x4E, 0xE9, 0x24, 0x95, 0xB6, 0xDB,
+    0xED, 0xB6, 0xA5, 0x18, 0xC6, 0xB5, 0xDC, 0x6D, 0x49, 0x5B, 0x6D, 0x49, 0x2E, 0x52, 0x53, 0x80,
+    0x00,
+};
+static const FontRange FONT_NARROW_RANGES[] PROGMEM = {
+    {32, 32, 0},
+    {37, 37, 1},
+    {45, 58, 2},
+    {63, 63, 16},
+    {65, 90, 17},
+};
+static const FontGlyph FONT_NARROW_GLYPHS[] PROGMEM = {
+    {0, 0, 2}, // space
+    {0, 3, 4}, // %
+    {21, 3, 4}, // -
+    {42, 1, 2}, // .
+    {49, 3, 4}, // /
+    {70, 3, 4}, // 0
+    {91, 3, 4}, // 1
+    {112, 3, 4}, // 2
+    {133, 3, 4}, // 3
+    {154, 3, 4}, // 4
+    {175, 3, 4}, // 5
+    {196, 3, 4}, // 6
+    {217, 3, 4}, // 7
+    {238, 3, 4}, // 8
+    {259, 3, 4}, // 9
+    {280, 1, 2}, // :
+    {287, 3, 4}, // ?
+    {308, 3, 4}, // A
+    {329, 3, 4}, // B
+    {350, 3, 4}, // C
+    {371, 3, 4}, // D
+    {392, 3, 4}, // E
+    {413, 3, 4}, // F
+    {434, 3, 4}, // G
+    {455, 3, 4}, // H
+    {476, 3, 4}, // I
+    {497, 3, 4}, // J
+    {518, 3, 4}, // K
+    {539, 3, 4}, // L
+    {560, 5, 6}, // M
+    {595, 4, 5}, // N
+    {623, 3, 4}, // O
+    {644, 3, 4}, // P
+    {665, 3, 4}, // Q
+    {686, 3, 4}, // R
+    {707, 3, 4}, // S
+    {728, 3, 4}, // T
+    {749, 3, 4}, // U
+    {770, 3, 4}, // V
+    {791, 5, 6}, // W
+    {826, 3, 4}, // X
+    {847, 3, 4}, // Y
+    {868, 3, 4}, // Z
+};
+const Font FONT_NARROW = {FONT_NARROW_BITMAP, FONT_NARROW_GLYPHS, FONT_NARROW_RANGES, 5, 7, 0, 0, 0};
+
+static const uint8_t FONT_CLOCK_BITMAP[] PROGMEM = {
+    0x76, 0xF7, 0xBD, 0xEF, 0x6E, 0x33, 0x8C, 0x63, 0x18, 0xCF, 0x76, 0xC6, 0x66, 0x63, 0x1F, 0x76,
+    0xC6, 0x61, 0x8F, 0x6E, 0x19, 0xD7, 0x3F, 0x8C, 0x63, 0xFE, 0x31, 0xE1, 0x8F, 0x6E, 0x76, 0x31,
+    0xED, 0xEF, 0x6E, 0xF8, 0xC6, 0x63, 0x31, 0x8C, 0x76, 0xF6, 0xED, 0xEF, 0x6E, 0x76, 0xF7, 0xB7,
+    0x8C, 0x6E, 0x0C, 0x30, 0x00,
+};
+static const FontRange FONT_CLOCK_RANGES[] PROGMEM = {
+    {32, 32, 0},
+    {48, 58, 1},
+};
+static const FontGlyph FONT_CLOCK_GLYPHS[] PROGMEM = {
+    {0, 0, 3}, // space
+    {0, 5, 6}, // 0
+    {40, 5, 6}, // 1
+    {80, 5, 6}, // 2
+    {120, 5, 6}, // 3
+    {160, 5, 6}, // 4
+    {200, 5, 6}, // 5
+    {240, 5, 6}, // 6
+    {280, 5, 6}, // 7
+    {320, 5, 6}, // 8
+    {360, 5, 6}, // 9
+    {400, 2, 3}, // :
+};
+const Font FONT_CLOCK = {FONT_CLOCK_BITMAP, FONT_CLOCK_GLYPHS, FONT_CLOCK_RANGES, 2, 8, 0, 0, 0};
+
+const uint8_t ROW_BIT_ORDER[2][256] PROGMEM = {
+    {
+        0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+        0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F,
+        0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F,
+        0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0x3E, 0x3F,
+        0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4A, 0x4B, 0x4C, 0x4D, 0x4E, 0x4F,
+        0x50, 0x51, 0x52, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5A, 0x5B, 0x5C, 0x5D, 0x5E, 0x5F,
+        0x60, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6A, 0x6B, 0x6C, 0x6D, 0x6E, 0x6F,
+        0x70, 0x71, 0x72, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7A, 0x7B, 0x7C, 0x7D, 0x7E, 0x7F,
+        0x80, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8A, 0x8B, 0x8C, 0x8D, 0x8E, 0x8F,
+        0x90, 0x91, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9A, 0x9B, 0x9C, 0x9D, 0x9E, 0x9F,
+        0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6, 0xA7, 0xA8, 0xA9, 0xAA, 0xAB, 0xAC, 0xAD, 0xAE, 0xAF,
+        0xB0, 0xB1, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6, 0xB7, 0xB8, 0xB9, 0xBA, 0xBB, 0xBC, 0xBD, 0xBE, 0xBF,
+        0xC0, 0xC1, 0xC2, 0xC3, 0xC4, 0xC5, 0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xCB, 0xCC, 0xCD, 0xCE, 0xCF,
+        0xD0, 0xD1, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7, 0xD8, 0xD9, 0xDA, 0xDB, 0xDC, 0xDD, 0xDE, 0xDF,
+        0xE0, 0xE1, 0xE2, 0xE3, 0xE4, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9, 0xEA, 0xEB, 0xEC, 0xED, 0xEE, 0xEF,
+        0xF0, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8, 0xF9, 0xFA, 0xFB, 0xFC, 0xFD, 0xFE, 0xFF,
+    },
+    {
+        0x00, 0x80, 0x40, 0xC0, 0x20, 0xA0, 0x60, 0xE0, 0x10, 0x90, 0x50, 0xD0, 0x30, 0xB0, 0x70, 0xF0,
+        0x08, 0x88, 0x48, 0xC8, 0x28, 0xA8, 0x68, 0xE8, 0x18, 0x98, 0x58, 0xD8, 0x38, 0xB8, 0x78, 0xF8,
+        0x04, 0x84, 0x44, 0xC4, 0x24, 0xA4, 0x64, 0xE4, 0x14, 0x94, 0x54, 0xD4, 0x34, 0xB4, 0x74, 0xF4,
+        0x0C, 0x8C, 0x4C, 0xCC, 0x2C, 0xAC, 0x6C, 0xEC, 0x1C, 0x9C, 0x5C, 0xDC, 0x3C, 0xBC, 0x7C, 0xFC,
+        0x02, 0x82, 0x42, 0xC2, 0x22, 0xA2, 0x62, 0xE2, 0x12, 0x92, 0x52, 0xD2, 0x32, 0xB2, 0x72, 0xF2,
+        0x0A, 0x8A, 0x4A, 0xCA, 0x2A, 0xAA, 0x6A, 0xEA, 0x1A, 0x9A, 0x5A, 0xDA, 0x3A, 0xBA, 0x7A, 0xFA,
+        0x06, 0x86, 0x46, 0xC6, 0x26, 0xA6, 0x66, 0xE6, 0x16, 0x96, 0x56, 0xD6, 0x36, 0xB6, 0x76, 0xF6,
+        0x0E, 0x8E, 0x4E, 0xCE, 0x2E, 0xAE, 0x6E, 0xEE, 0x1E, 0x9E, 0x5E, 0xDE, 0x3E, 0xBE, 0x7E, 0xFE,
+        0x01, 0x81, 0x41, 0xC1, 0x21, 0xA1, 0x61, 0xE1, 0x11, 0x91, 0x51, 0xD1, 0x31, 0xB1, 0x71, 0xF1,
+        0x09, 0x89, 0x49, 0xC9, 0x29, 0xA9, 0x69, 0xE9, 0x19, 0x99, 0x59, 0xD9, 0x39, 0xB9, 0x79, 0xF9,
+        0x05, 0x85, 0x45, 0xC5, 0x25, 0xA5, 0x65, 0xE5, 0x15, 0x95, 0x55, 0xD5, 0x35, 0xB5, 0x75, 0xF5,
+        0x0D, 0x8D, 0x4D, 0xCD, 0x2D, 0xAD, 0x6D, 0xED, 0x1D, 0x9D, 0x5D, 0xDD, 0x3D, 0xBD, 0x7D, 0xFD,
+        0x03, 0x83, 0x43, 0xC3, 0x23, 0xA3, 0x63, 0xE3, 0x13, 0x93, 0x53, 0xD3, 0x33, 0xB3, 0x73, 0xF3,
+        0x0B, 0x8B, 0x4B, 0xCB, 0x2B, 0xAB, 0x6B, 0xEB, 0x1B, 0x9B, 0x5B, 0xDB, 0x3B, 0xBB, 0x7B, 0xFB,
+        0x07, 0x87, 0x47, 0xC7, 0x27, 0xA7, 0x67, 0xE7, 0x17, 0x97, 0x57, 0xD7, 0x37, 0xB7, 0x77, 0xF7,
+        0x0F, 0x8F, 0x4F, 0xCF, 0x2F, 0xAF, 0x6F, 0xEF, 0x1F, 0x9F, 0x5F, 0xDF, 0x3F, 0xBF, 0x7F, 0xFF,
+    },
+};
@@ -0,0 +1,20 @@
+/**
+ * MAX7219 Fonts
+ *
+ * Generated by scripts/gen_font.py from fonts/fonts.json - do not edit
+ * Packed glyph atlases (layout in font.h) and the row bit-order tables
+ */
+
+#ifndef MAX7219_FONT_H
+#define MAX7219_FONT_H
+
+#include "font.h"
+
+extern const Font FONT_5X7;    // 5x7.bdf, 96 glyphs, 5x7 cells, 424 bytes
+extern const Font FONT_NARROW; // narrow_3x7.bdf, 43 glyphs, 7 rows, variable width, 300 bytes
+extern const Font FONT_CLOCK;  // clock_5x8.bdf, 12 glyphs, 8 rows, variable width, 107 bytes
+
+// Row byte as written to the chip: [0] upright, [1] flipped (bit order reversed)
+extern const uint8_t ROW_BIT_ORDER[2][256];
+
+#endif // MAX7219_FONT_H
@@ -0,0 +1,224 @@
+/**
+ * NTP Math Implementation
+ *
+ * All arithmetic in signed 64-bit milliseconds
+ */
+
+#include "ntp_math.h"
+
+#include <math.h>
+
+uint64_t ntpReadTimestampMs(const uint8_t* p) {
+    uint32_t seconds = ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+                       ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+    uint32_t fraction = ((uint32_t)p[4] << 24) | ((uint32_t)p[5] << 16) |
+                        ((uint32_t)p[6] << 8) | (uint32_t)p[7];
+
+    if (seconds == 0 && fraction == 0) {
+        return 0;
+    }
+
+    // Era 0 ends in 2036; smaller values belong to era 1
+    uint64_t ntpSeconds = seconds;
+    if (ntpSeconds < NTP_UNIX_OFFSET) {
+        ntpSeconds += 0x100000000ULL;
+    }
+
+    uint64_t fractionMs = ((uint64_t)fraction * 1000ULL) >> 32;
+    return (ntpSeconds - NTP_UNIX_OFFSET) * 1000ULL + fractionMs;
+}
+
+void ntpWriteTimestampMs(uint64_t unixMs, uint8_t* p) {
+    uint32_t seconds = (uint32_t)(unixMs / 1000ULL + NTP_UNIX_OFFSET);
+    uint32_t fraction = (uint32_t)(((unixMs % 1000ULL) << 32) / 1000ULL);
+
+    p[0] = seconds >> 24;
+    p[1] = seconds >> 16;
+    p[2] = seconds >> 8;
+    p[3] = seconds;
+    p[4] = fraction >> 24;
+    p[5] = fraction >> 16;
+    p[6] = fraction >> 8;
+    p[7] = fraction;
+}
+
+NtpSample ntpComputeSample(int64_t t1, int64_t t2, int64_t t3, int64_t t4) {
+    NtpSample s;
+    s.offsetMs = ((t2 - t1) + (t3 - t4)) / 2;
+
+    int64_t delay = (t4 - t1) - (t3 - t2);
+    if (delay < 0) delay = 0;  // Clock resolution can make tiny delays negative
+    if (delay > 0x7FFFFFFF) delay = 0x7FFFFFFF;
+    s.delayMs = (int32_t)delay;
+
+    s.takenAt = 0;
+    return s;
+}
+
+uint32_t ntpReadShortMs(const uint8_t* p) {
+    uint32_t v = ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+                 ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+    return (uint32_t)(((uint64_t)v * 1000ULL) >> 16);
+}
+
+bool ntpSelectSources(const NtpCandidate* c, uint8_t n, NtpSelection& out) {
+    out.truechimers = 0;
+    out.trueMask = 0;
+    out.offsetMs = 0;
+    out.delayMs = 0;
+    out.lowMs = 0;
+    out.highMs = 0;
+
+    if (n == 0 || n > NTP_MAX_SERVERS) return false;
+
+    // Interval endpoints: type -1 opens an interval, +1 closes it
+    struct Edge {
+        int64_t at;
+        int8_t type;
+    };
+    Edge edges[2 * NTP_MAX_SERVERS];
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < n; i++) {
+        edges[count].at = c[i].offsetMs - (int64_t)c[i].rootDistanceMs;
+        edges[count++].type = -1;
+        edges[count].at = c[i].offsetMs + (int64_t)c[i].rootDistanceMs;
+        edges[count++].type = +1;
+    }
+
+    // Insertion sort (at most 8 edges); opens sort before closes at equal
+    // offsets so touching intervals count as overlapping
+    for (uint8_t i = 1; i < count; i++) {
+        Edge e = edges[i];
+        int8_t j = i - 1;
+        while (j >= 0 && (edges[j].at > e.at || (edges[j].at == e.at && edges[j].type > e.type))) {
+            edges[j + 1] = edges[j];
+            j--;
+        }
+        edges[j + 1] = e;
+    }
+
+    // Sweep for the point covered by the most intervals
+    int8_t depth = 0;
+    int8_t bestDepth = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        depth -= edges[i].type;
+        if (depth > bestDepth) {
+            bestDepth = depth;
+            out.lowMs = edges[i].at;
+            out.highMs = edges[i + 1].at;  // An open is always followed by another edge
+        }
+    }
+
+    // A majority must agree, otherwise we can't tell truechimers from falsetickers
+    if (bestDepth * 2 <= n) {
+        return false;
+    }
+
+    double weightSum = 0;
+    double offsetSum = 0;
+    for (uint8_t i = 0; i < n; i++) {
+        int64_t low = c[i].offsetMs - (int64_t)c[i].rootDistanceMs;
+        int64_t high = c[i].offsetMs + (int64_t)c[i].rootDistanceMs;
+        if (low > out.highMs || high < out.lowMs) {
+            continue;  // Falseticker
+        }
+
+        out.trueMask |= (1 << i);
+        out.truechimers++;
+        if (out.truechimers == 1 || c[i].delayMs < out.delayMs) {
+            out.delayMs = c[i].delayMs;
+        }
+
+        double weight = 1.0 / (c[i].rootDistanceMs > 0 ? c[i].rootDistanceMs : 1);
+        weightSum += weight;
+        offsetSum += weight * (double)c[i].offsetMs;
+    }
+
+    out.offsetMs = (int64_t)(offsetSum / weightSum + (offsetSum >= 0 ? 0.5 : -0.5));
+    return true;
+}
+
+NtpClockFilter::NtpClockFilter() {
+    clear();
+}
+
+bool NtpClockFilter::add(const NtpSample& sample) {
+    if (sample.delayMs > NTP_MAX_DELAY_MS) {
+        _rejected++;
+        return false;
+    }
+
+    const NtpSample* b = best();
+    if (b) {
+        int32_t limit = b->delayMs * NTP_DELAY_REJECT_FACTOR + NTP_DELAY_REJECT_SLACK_MS;
+        if (sample.delayMs > limit && ++_spikeRun < NTP_FILTER_SIZE) {
+            _rejected++;
+            return false;
+        }
+    }
+    _spikeRun = 0;
+
+    _samples[_next] = sample;
+    _used[_next] = false;
+    _next = (_next + 1) % NTP_FILTER_SIZE;
+    _newestAt = sample.takenAt;
+    if (_count < NTP_FILTER_SIZE) {
+        _count++;
+    }
+    return true;
+}
+
+uint64_t NtpClockFilter::distanceUs(const NtpSample& sample) const {
+    uint32_t ageMs = _newestAt - sample.takenAt;
+    return (uint64_t)sample.delayMs * 500 + (uint64_t)ageMs * NTP_PHI_PPM / 1000;
+}
+
+const NtpSample* NtpClockFilter::select(bool freshOnly) const {
+    const NtpSample* b = nullptr;
+    uint64_t bestDistance = 0;
+    for (uint8_t i = 0; i < _count; i++) {
+        if (freshOnly && _used[i]) continue;
+
+        uint64_t distance = distanceUs(_samples[i]);
+        if (!b || distance < bestDistance) {
+            b = &_samples[i];
+            bestDistance = distance;
+        }
+    }
+    return b;
+}
+
+const NtpSample* NtpClockFilter::best() const {
+    return select(false);
+}
+
+const NtpSample* NtpClockFilter::freshBest() const {
+    return select(true);
+}
+
+uint32_t NtpClockFilter::jitterMs() const {
+    const NtpSample* b = best();
+    if (!b || _count < 2) return 0;
+
+    double sum = 0;
+    for (uint8_t i = 0; i < _count; i++) {
+        double d = (double)(_samples[i].offsetMs - b->offsetMs);
+        sum += d * d;
+    }
+    return (uint32_t)sqrt(sum / (_count - 1));
+}
+
+void NtpClockFilter::applyCorrection(int64_t correctionMs) {
+    for (uint8_t i = 0; i < _count; i++) {
+        _samples[i].offsetMs -= correctionMs;
+        _used[i] = true;
+    }
+}
+
+void NtpClockFilter::clear() {
+    _count = 0;
+    _next = 0;
+    _spikeRun = 0;
+    _rejected = 0;
+    _newestAt = 0;
+}
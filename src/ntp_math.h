@@ -0,0 +1,189 @@
+/**
+ * NTP Math Header
+ *
+ * On-wire timestamp conversion and RFC 5905 offset/delay arithmetic
+ */
+
+#ifndef NTP_MATH_H
+#define NTP_MATH_H
+
+#include <stdint.h>
+
+// Seconds from 1900-01-01 (NTP era 0) to 1970-01-01 (Unix epoch)
+#define NTP_UNIX_OFFSET 2208988800ULL
+
+// Number of samples kept by the clock filter
+#ifndef NTP_FILTER_SIZE
+#define NTP_FILTER_SIZE 8
+#endif
+
+// Samples slower than this are never used
+#ifndef NTP_MAX_DELAY_MS
+#define NTP_MAX_DELAY_MS 1000
+#endif
+
+// Dispersion growth of a held sample (RFC 5905 PHI): 15 us per second of age
+#define NTP_PHI_PPM 15
+
+// Reject samples whose delay exceeds factor * best delay + slack
+#define NTP_DELAY_REJECT_FACTOR 3
+#define NTP_DELAY_REJECT_SLACK_MS 20
+
+// Most servers queried in one round
+#ifndef NTP_MAX_SERVERS
+#define NTP_MAX_SERVERS 4
+#endif
+
+/**
+ * Read a 64-bit NTP timestamp (big-endian seconds + fraction)
+ * Timestamps before 1970 are taken to be in era 1 (after 2036)
+ * @param p 8 bytes from the packet
+ * @return Unix time in ms, or 0 for an unset (all-zero) timestamp
+ */
+uint64_t ntpReadTimestampMs(const uint8_t* p);
+
+/**
+ * Write a Unix time in ms as a 64-bit NTP timestamp
+ * @param unixMs Unix time in ms
+ * @param p 8 bytes of packet to fill
+ */
+void ntpWriteTimestampMs(uint64_t unixMs, uint8_t* p);
+
+/**
+ * One client/server exchange
+ */
+struct NtpSample {
+    int64_t offsetMs;    // Server time minus local clock
+    int32_t delayMs;     // Round-trip delay excluding server processing
+    uint32_t takenAt;    // millis() when the reply arrived
+};
+
+/**
+ * Compute offset and delay from the four timestamps (RFC 5905)
+ * T1/T4 are local clock readings, T2/T3 come from the server
+ *
+ *   offset = ((T2 - T1) + (T3 - T4)) / 2
+ *   delay  =  (T4 - T1) - (T3 - T2)
+ *
+ * @return Sample with negative delays clamped to 0
+ */
+NtpSample ntpComputeSample(int64_t t1, int64_t t2, int64_t t3, int64_t t4);
+
+/**
+ * Read a 32-bit NTP short format value (16.16 seconds) as ms
+ * Used for root delay and root dispersion
+ */
+uint32_t ntpReadShortMs(const uint8_t* p);
+
+/**
+ * One server's answer in a multi-server round
+ */
+struct NtpCandidate {
+    int64_t offsetMs;        // Server time minus local clock
+    int32_t delayMs;         // Round-trip delay to the server
+    uint32_t rootDistanceMs; // Error bound: delay/2 + server's root delay/2 + root dispersion
+};
+
+/**
+ * Result of source selection
+ */
+struct NtpSelection {
+    uint8_t truechimers;     // Candidates agreeing on the intersection
+    uint8_t trueMask;        // Bit i set if candidate i is a truechimer
+    int64_t offsetMs;        // Combined offset of the truechimers
+    int32_t delayMs;         // Lowest delay among the truechimers
+    int64_t lowMs;           // Intersection interval
+    int64_t highMs;
+};
+
+/**
+ * Marzullo intersection over [offset - rootDistance, offset + rootDistance]
+ * Finds the interval shared by the most candidates; candidates overlapping it
+ * are truechimers and their offsets are averaged weighted by 1/rootDistance
+ * @param c Candidates
+ * @param n Number of candidates (at most NTP_MAX_SERVERS)
+ * @param out Selection result
+ * @return false if no majority of candidates agrees
+ */
+bool ntpSelectSources(const NtpCandidate* c, uint8_t n, NtpSelection& out);
+
+/**
+ * Clock filter over the last NTP_FILTER_SIZE accepted samples
+ * Picks the sample with the smallest error bound: half its delay plus
+ * NTP_PHI_PPM of its age, measured from the newest sample held
+ */
+class NtpClockFilter {
+public:
+    NtpClockFilter();
+
+    /**
+     * Offer a new sample
+     * Rejects samples above NTP_MAX_DELAY_MS and delay spikes relative
+     * to the best sample held; a run of NTP_FILTER_SIZE consecutive
+     * spikes is accepted so a lasting path change can't lock us out
+     * @return true if the sample was stored
+     */
+    bool add(const NtpSample& sample);
+
+    /**
+     * Sample with the smallest age-weighted distance
+     * @return nullptr if the filter is empty
+     */
+    const NtpSample* best() const;
+
+    /**
+     * Best sample among those added since the last applyCorrection()
+     * Once the clock has been corrected by a sample its offset is ~0 and says
+     * nothing about drift since, so each sample drives at most one correction
+     * @return nullptr if no sample is newer than the last correction
+     */
+    const NtpSample* freshBest() const;
+
+    /**
+     * RMS difference of the held offsets from the best offset (ms)
+     */
+    uint32_t jitterMs() const;
+
+    /**
+     * Re-express stored offsets after the clock was corrected
+     * Every sample held is marked used (see freshBest())
+     * @param correctionMs Amount added to the local clock
+     */
+    void applyCorrection(int64_t correctionMs);
+
+    /**
+     * Number of samples held
+     */
+    uint8_t count() const { return _count; }
+
+    /**
+     * Number of samples rejected since the last clear()
+     */
+    uint32_t rejected() const { return _rejected; }
+
+    /**
+     * Drop all samples
+     */
+    void clear();
+
+private:
+    NtpSample _samples[NTP_FILTER_SIZE];
+    bool _used[NTP_FILTER_SIZE];  // Held when the clock was last corrected
+    uint8_t _count;
+    uint8_t _next;             // Ring position for the next sample
+    uint8_t _spikeRun;         // Consecutive delay spikes
+    uint32_t _newestAt;        // takenAt of the latest sample, ages are measured from it
+    uint32_t _rejected;
+
+    /**
+     * Half the delay plus dispersion grown with age, in us
+     */
+    uint64_t distanceUs(const NtpSample& sample) const;
+
+    /**
+     * Lowest-distance sample, optionally skipping used ones
+     */
+    const NtpSample* select(bool freshOnly) const;
+};
+
+#endif // NTP_MATH_H
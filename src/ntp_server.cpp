@@ -0,0 +1,114 @@
+/**
+ * NTP Server Implementation
+ *
+ * Reply layout follows RFC 5905: origin = client's transmit timestamp,
+ * receive/transmit from our clock, version and poll echoed from the request
+ */
+
+#include "ntp_server.h"
+#include "ntp_math.h"
+
+#include <string.h>
+
+void ntpWriteShortMs(uint32_t ms, uint8_t* p) {
+    uint64_t v = (((uint64_t)ms << 16) + 999ULL) / 1000ULL;  // Round up: error bounds must not shrink
+    if (v > 0xFFFFFFFFULL) v = 0xFFFFFFFFULL;
+
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+NtpServer::NtpServer() {
+    reset();
+}
+
+NtpServeResult NtpServer::handle(uint8_t* packet, uint16_t len, uint32_t clientAddr,
+                                 uint32_t nowMs, uint64_t receiveMs, const NtpServerInfo& info) {
+    if (len < NTP_PACKET_SIZE) return NTP_SERVE_IGNORED;
+
+    uint8_t version = (packet[0] >> 3) & 0x07;
+    uint8_t mode = packet[0] & 0x07;
+    if (mode != 3 || version < 1 || version > 4) return NTP_SERVE_IGNORED;
+
+    if (!admit(clientAddr, nowMs)) {
+        _limited++;
+        return NTP_SERVE_LIMITED;
+    }
+
+    // Origin (T1) is the client's transmit timestamp, byte for byte
+    uint8_t origin[8];
+    memcpy(origin, &packet[40], sizeof(origin));
+    uint8_t poll = packet[2];
+
+    memset(packet, 0, NTP_PACKET_SIZE);
+    uint8_t leap = info.synced ? 0 : 3;
+    packet[0] = (uint8_t)((leap << 6) | (version << 3) | 4);  // Mode 4 (server)
+    packet[1] = info.synced ? info.stratum : 16;
+    packet[2] = poll;
+    packet[3] = (uint8_t)NTP_SERVE_PRECISION;
+
+    if (info.synced) {
+        // Dispersion grows with the time since our last sync
+        uint64_t age = receiveMs > info.refTimeMs ? receiveMs - info.refTimeMs : 0;
+        uint64_t dispersion = info.rootDispersionMs + age * NTP_SERVE_PHI_PPM / 1000000ULL;
+        ntpWriteShortMs(info.rootDelayMs, &packet[4]);
+        ntpWriteShortMs(dispersion > 0xFFFFFFFFULL ? 0xFFFFFFFFUL : (uint32_t)dispersion, &packet[8]);
+        memcpy(&packet[12], info.refId, 4);
+        ntpWriteTimestampMs(info.refTimeMs, &packet[16]);
+    } else {
+        ntpWriteShortMs(0xFFFFFFFFUL, &packet[8]);
+    }
+
+    memcpy(&packet[24], origin, sizeof(origin));
+    ntpWriteTimestampMs(receiveMs, &packet[32]);
+
+    _served++;
+    return NTP_SERVE_REPLY;
+}
+
+void NtpServer::stampTransmit(uint8_t* packet, uint64_t transmitMs) {
+    ntpWriteTimestampMs(transmitMs, &packet[40]);
+}
+
+bool NtpServer::admit(uint32_t addr, uint32_t nowMs) {
+    Client* client = nullptr;
+    Client* oldest = &_clients[0];
+    for (uint8_t i = 0; i < NTP_SERVE_CLIENTS; i++) {
+        Client& c = _clients[i];
+        if (c.used && c.addr == addr) {
+            client = &c;
+            break;
+        }
+        if (!c.used) {
+            oldest = &c;
+        } else if (oldest->used && (int32_t)(c.lastMs - oldest->lastMs) < 0) {
+            oldest = &c;
+        }
+    }
+
+    if (!client) {
+        client = oldest;
+        client->addr = addr;
+        client->lastMs = nowMs;
+        client->debtMs = 0;
+        client->used = true;
+    }
+
+    uint32_t elapsed = nowMs - client->lastMs;
+    client->debtMs = client->debtMs > elapsed ? client->debtMs - elapsed : 0;
+    client->lastMs = nowMs;
+
+    if (client->debtMs + NTP_SERVE_MIN_INTERVAL_MS > (uint32_t)NTP_SERVE_BURST * NTP_SERVE_MIN_INTERVAL_MS) {
+        return false;
+    }
+    client->debtMs += NTP_SERVE_MIN_INTERVAL_MS;
+    return true;
+}
+
+void NtpServer::reset() {
+    memset(_clients, 0, sizeof(_clients));
+    _served = 0;
+    _limited = 0;
+}
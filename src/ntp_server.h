@@ -0,0 +1,115 @@
+/**
+ * NTP Server Header
+ *
+ * Answers NTP client (mode 3) requests from the LAN with the disciplined clock
+ * Replies are built in place in the request buffer, so serving allocates nothing
+ * Each client gets a leaky-bucket allowance; requests beyond it are dropped
+ * The socket stays with TimeManager, which shares it with its own sync traffic
+ */
+
+#ifndef NTP_SERVER_H
+#define NTP_SERVER_H
+
+#include <stdint.h>
+
+// NTP header size (no extension fields or MAC)
+#define NTP_PACKET_SIZE 48
+
+// Clients tracked by the rate limiter; the least recently seen is replaced
+#ifndef NTP_SERVE_CLIENTS
+#define NTP_SERVE_CLIENTS 16
+#endif
+
+// Sustained rate allowed per client, and how many requests may come back to back
+// (ntpd's "average 1" with a burst deep enough for iburst and ntpdate -q)
+#ifndef NTP_SERVE_MIN_INTERVAL_MS
+#define NTP_SERVE_MIN_INTERVAL_MS 2000
+#endif
+#ifndef NTP_SERVE_BURST
+#define NTP_SERVE_BURST 8
+#endif
+
+// Advertised clock precision: 2^-10 s, the millisecond resolution of our timestamps
+#define NTP_SERVE_PRECISION -10
+
+// Dispersion growth since the last sync (RFC 5905 PHI, 15 ppm)
+#define NTP_SERVE_PHI_PPM 15
+
+/**
+ * What the server says about its own synchronization
+ */
+struct NtpServerInfo {
+    bool synced;                // False: replies carry LI=3 / stratum 16 so clients ignore them
+    uint8_t stratum;            // Upstream stratum + 1
+    uint8_t refId[4];           // IPv4 address of the upstream server
+    uint64_t refTimeMs;         // UTC time of the last sync
+    uint32_t rootDelayMs;       // Round trip to the primary reference
+    uint32_t rootDispersionMs;  // Error bound accumulated up to us
+};
+
+/**
+ * Outcome of one request
+ */
+enum NtpServeResult {
+    NTP_SERVE_REPLY,            // Packet now holds the reply (stamp the transmit time and send)
+    NTP_SERVE_IGNORED,          // Not an NTP client request
+    NTP_SERVE_LIMITED           // Client over its allowance, drop silently
+};
+
+/**
+ * Write ms as a 32-bit NTP short format value (16.16 seconds)
+ * Saturates at 65535 s
+ */
+void ntpWriteShortMs(uint32_t ms, uint8_t* p);
+
+class NtpServer {
+public:
+    NtpServer();
+
+    /**
+     * Turn a request into a reply in the same buffer
+     * Everything but the transmit timestamp is filled in; write it with
+     * stampTransmit() as close to sending as possible
+     * @param packet Request, NTP_PACKET_SIZE bytes (rewritten on NTP_SERVE_REPLY)
+     * @param len Bytes received
+     * @param clientAddr Source IPv4 address (any fixed byte order)
+     * @param nowMs millis() when the request arrived
+     * @param receiveMs UTC time the request arrived (T2)
+     * @param info Current synchronization state
+     */
+    NtpServeResult handle(uint8_t* packet, uint16_t len, uint32_t clientAddr,
+                          uint32_t nowMs, uint64_t receiveMs, const NtpServerInfo& info);
+
+    /**
+     * Write the transmit timestamp (T3) into a reply
+     */
+    static void stampTransmit(uint8_t* packet, uint64_t transmitMs);
+
+    uint32_t getServed() const { return _served; }
+    uint32_t getLimited() const { return _limited; }
+
+    /**
+     * Forget all clients and counters
+     */
+    void reset();
+
+private:
+    // Leaky bucket per client: each request adds one interval of debt, time drains it
+    struct Client {
+        uint32_t addr;
+        uint32_t lastMs;
+        uint32_t debtMs;
+        bool used;
+    };
+    Client _clients[NTP_SERVE_CLIENTS];
+    uint32_t _served;
+    uint32_t _limited;
+
+    /**
+     * Charge a request to the client's allowance
+     * @return false if the client is over it
+     */
+    bool admit(uint32_t addr, uint32_t nowMs);
+};
+
+#endif // NTP_SERVER_H
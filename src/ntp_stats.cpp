@@ -0,0 +1,97 @@
+/**
+ * NTP Statistics Implementation
+ *
+ * The ring is small, so the summary is recomputed in full on each add()
+ */
+
+#include "ntp_stats.h"
+
+#include <math.h>
+#include <string.h>
+
+static const char* const OUTCOME_NAMES[NTP_SYNC_OUTCOME_COUNT] = {
+    "ok", "timeout", "bad_reply", "kod", "no_majority", "dns_failed", "send_failed"
+};
+
+static const char* const CORRECTION_NAMES[] = {
+    "none", "slew", "step", "set", "held"
+};
+
+NtpStats::NtpStats() {
+    reset();
+}
+
+void NtpStats::add(const NtpSyncRecord& record) {
+    _records[_next] = record;
+    _next = (_next + 1) % NTP_STATS_HISTORY;
+    if (_count < NTP_STATS_HISTORY) _count++;
+
+    _total++;
+    if (record.outcome < NTP_SYNC_OUTCOME_COUNT) {
+        _outcomes[record.outcome]++;
+    }
+    summarize();
+}
+
+const NtpSyncRecord& NtpStats::get(uint8_t age) const {
+    if (age >= _count) age = _count ? _count - 1 : 0;
+    return _records[(_next + NTP_STATS_HISTORY - 1 - age) % NTP_STATS_HISTORY];
+}
+
+uint32_t NtpStats::getOutcomeCount(uint8_t outcome) const {
+    return outcome < NTP_SYNC_OUTCOME_COUNT ? _outcomes[outcome] : 0;
+}
+
+const char* NtpStats::outcomeName(uint8_t outcome) {
+    return outcome < NTP_SYNC_OUTCOME_COUNT ? OUTCOME_NAMES[outcome] : "?";
+}
+
+const char* NtpStats::correctionName(uint8_t correction) {
+    return correction <= NTP_CORRECTION_HELD ? CORRECTION_NAMES[correction] : "?";
+}
+
+void NtpStats::reset() {
+    memset(_records, 0, sizeof(_records));
+    memset(_outcomes, 0, sizeof(_outcomes));
+    _next = 0;
+    _count = 0;
+    _total = 0;
+    _jitterMs = 0;
+    _availability = 0;
+    _meanDelayMs = 0;
+    _maxDelayMs = 0;
+}
+
+void NtpStats::summarize() {
+    uint8_t ok = 0;
+    int64_t delaySum = 0;
+    int32_t delayMax = 0;
+
+    // Oldest to newest, so differences follow the order the syncs happened
+    double sum = 0;
+    uint8_t diffs = 0;
+    bool havePrev = false;
+    int32_t prev = 0;
+    for (int16_t age = _count - 1; age >= 0; age--) {
+        const NtpSyncRecord& r = get((uint8_t)age);
+        if (r.outcome != NTP_SYNC_OK) continue;
+
+        ok++;
+        delaySum += r.delayMs;
+        if (r.delayMs > delayMax) delayMax = r.delayMs;
+
+        if (r.correction != NTP_CORRECTION_SLEW && r.correction != NTP_CORRECTION_STEP) continue;
+        if (havePrev) {
+            double d = (double)r.offsetMs - prev;
+            sum += d * d;
+            diffs++;
+        }
+        prev = r.offsetMs;
+        havePrev = true;
+    }
+
+    _availability = _count ? (uint8_t)((ok * 100U + _count / 2) / _count) : 0;
+    _meanDelayMs = ok ? (int32_t)(delaySum / ok) : 0;
+    _maxDelayMs = delayMax;
+    _jitterMs = diffs ? (uint32_t)sqrt(sum / diffs) : 0;
+}
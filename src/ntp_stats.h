@@ -0,0 +1,127 @@
+/**
+ * NTP Statistics Header
+ *
+ * Ring of recent sync results with rolling quality figures
+ * (jitter between syncs, availability, delay), for tuning poll
+ * intervals and spotting bad upstream servers
+ */
+
+#ifndef NTP_STATS_H
+#define NTP_STATS_H
+
+#include <stdint.h>
+
+// Syncs kept in the ring (~20 bytes each)
+#ifndef NTP_STATS_HISTORY
+#define NTP_STATS_HISTORY 32
+#endif
+
+/**
+ * How a sync ended
+ */
+enum NtpSyncOutcome : uint8_t {
+    NTP_SYNC_OK,            // Clock corrected (or set)
+    NTP_SYNC_TIMEOUT,       // No server answered
+    NTP_SYNC_BAD_REPLY,     // Replies came back unusable (unsynchronized server, missing timestamps)
+    NTP_SYNC_KOD,           // A server sent a kiss-o'-death (e.g. RATE)
+    NTP_SYNC_NO_MAJORITY,   // Replies disagreed, or the filter rejected every sample
+    NTP_SYNC_DNS_FAILED,    // No server address resolved
+    NTP_SYNC_SEND_FAILED,   // Requests couldn't be sent
+    NTP_SYNC_OUTCOME_COUNT
+};
+
+/**
+ * How the clock was corrected
+ */
+enum NtpCorrection : uint8_t {
+    NTP_CORRECTION_NONE,
+    NTP_CORRECTION_SLEW,    // Offset slewed in gradually
+    NTP_CORRECTION_STEP,    // Clock jumped by the offset
+    NTP_CORRECTION_SET,     // Clock had no time yet and was set outright
+    NTP_CORRECTION_HELD     // RTC left to build up error for its calibration (offset is the total)
+};
+
+/**
+ * One sync
+ */
+struct NtpSyncRecord {
+    uint32_t utc;           // UTC seconds when the sync ended (0 = clock not set)
+    int32_t offsetMs;       // Offset corrected (server - local), 0 unless slewed or stepped
+    int32_t delayMs;        // Round trip of the sample used
+    uint8_t server[4];      // IPv4 of the system peer, or of the server that sent the KoD
+    NtpSyncOutcome outcome;
+    NtpCorrection correction;
+    uint8_t replies;        // Usable replies across the sync's rounds
+    uint8_t pollExponent;   // Poll interval that followed (2^n s)
+};
+
+class NtpStats {
+public:
+    NtpStats();
+
+    /**
+     * Record a sync, replacing the oldest once the ring is full
+     */
+    void add(const NtpSyncRecord& record);
+
+    /**
+     * Records held (up to NTP_STATS_HISTORY)
+     */
+    uint8_t count() const { return _count; }
+
+    /**
+     * A recorded sync
+     * @param age 0 = newest, up to count() - 1
+     */
+    const NtpSyncRecord& get(uint8_t age) const;
+
+    /**
+     * Syncs since boot, in total and by outcome (not limited to the ring)
+     */
+    uint32_t getTotal() const { return _total; }
+    uint32_t getOutcomeCount(uint8_t outcome) const;
+
+    /**
+     * RMS of the change in offset between consecutive slewed/stepped syncs in the ring (ms)
+     */
+    uint32_t jitterMs() const { return _jitterMs; }
+
+    /**
+     * Share of the syncs in the ring that ended NTP_SYNC_OK (percent, 0 when empty)
+     */
+    uint8_t availabilityPercent() const { return _availability; }
+
+    /**
+     * Mean and largest round trip of the successful syncs in the ring (ms)
+     */
+    int32_t meanDelayMs() const { return _meanDelayMs; }
+    int32_t maxDelayMs() const { return _maxDelayMs; }
+
+    /**
+     * Short names for logs and JSON
+     */
+    static const char* outcomeName(uint8_t outcome);
+    static const char* correctionName(uint8_t correction);
+
+    /**
+     * Forget all records and counters
+     */
+    void reset();
+
+private:
+    NtpSyncRecord _records[NTP_STATS_HISTORY];
+    uint8_t _next;           // Slot the next record goes in
+    uint8_t _count;
+    uint32_t _total;
+    uint32_t _outcomes[NTP_SYNC_OUTCOME_COUNT];
+
+    // Recomputed on each add()
+    uint32_t _jitterMs;
+    uint8_t _availability;
+    int32_t _meanDelayMs;
+    int32_t _maxDelayMs;
+
+    void summarize();
+};
+
+#endif // NTP_STATS_H
@@ -0,0 +1,140 @@
+/**
+ * Radio Duty Cycle Implementation
+ *
+ * Times are millis() values compared by signed difference, so they
+ * survive the 49-day wrap
+ */
+
+#include "radio_duty.h"
+
+#include <string.h>
+
+static bool reached(uint32_t nowMs, uint32_t t) {
+    return (int32_t)(nowMs - t) >= 0;
+}
+
+RadioDutyCycle::RadioDutyCycle()
+    : _enabled(false), _awake(true), _openedAt(0), _holdUntil(0), _holding(false),
+      _hour(0), _hoursRecorded(0), _hourStart(0), _lastUpdate(0), _started(false) {
+    memset(_jobs, 0, sizeof(_jobs));
+    memset(_hours, 0, sizeof(_hours));
+}
+
+void RadioDutyCycle::setEnabled(bool enabled, uint32_t nowMs) {
+    account(nowMs);
+    _enabled = enabled;
+    if (!enabled && !_awake) {
+        open(nowMs);
+    }
+    _openedAt = nowMs;  // Whatever is awake now counts as one window
+}
+
+void RadioDutyCycle::request(uint8_t job, uint32_t earliestMs, uint32_t deadlineMs) {
+    if (job >= RADIO_JOB_COUNT) return;
+    Job& j = _jobs[job];
+    j.earliestMs = earliestMs;
+    j.deadlineMs = deadlineMs;
+    j.requested = true;
+}
+
+void RadioDutyCycle::cancel(uint8_t job) {
+    if (job >= RADIO_JOB_COUNT) return;
+    _jobs[job].requested = false;
+}
+
+bool RadioDutyCycle::mayStart(uint8_t job, uint32_t nowMs) {
+    if (job >= RADIO_JOB_COUNT) return false;
+    Job& j = _jobs[job];
+    if (!j.requested) return false;
+
+    // Without duty cycling every job keeps its own schedule
+    bool go = _enabled ? (_awake && reached(nowMs, j.earliestMs)) : reached(nowMs, j.deadlineMs);
+    if (!go) return false;
+
+    j.requested = false;
+    j.busy = true;
+    return true;
+}
+
+void RadioDutyCycle::setBusy(uint8_t job, bool busy) {
+    if (job >= RADIO_JOB_COUNT) return;
+    _jobs[job].busy = busy;
+}
+
+void RadioDutyCycle::holdAwake(uint32_t nowMs, uint32_t durationMs) {
+    uint32_t until = nowMs + durationMs;
+    if (!_holding || reached(until, _holdUntil)) {
+        _holdUntil = until;
+    }
+    _holding = true;
+}
+
+bool RadioDutyCycle::update(uint32_t nowMs) {
+    account(nowMs);
+
+    if (_holding && reached(nowMs, _holdUntil)) {
+        _holding = false;
+    }
+
+    if (!_enabled) return false;
+
+    bool due = false;
+    bool runnable = false;
+    bool busy = false;
+    for (uint8_t i = 0; i < RADIO_JOB_COUNT; i++) {
+        const Job& j = _jobs[i];
+        if (j.requested && reached(nowMs, j.deadlineMs)) due = true;
+        if (j.requested && reached(nowMs, j.earliestMs)) runnable = true;
+        if (j.busy) busy = true;
+    }
+
+    if (!_awake) {
+        if (due || _holding) {
+            open(nowMs);
+            return true;
+        }
+        return false;
+    }
+
+    // Close once every job that could use this window has run
+    if (!busy && !runnable && !_holding && nowMs - _openedAt >= RADIO_MIN_WINDOW_MS) {
+        _awake = false;
+        return true;
+    }
+    return false;
+}
+
+const RadioHourStats& RadioDutyCycle::getHour(uint8_t hoursAgo) const {
+    if (hoursAgo >= RADIO_HISTORY_HOURS) hoursAgo = RADIO_HISTORY_HOURS - 1;
+    return _hours[(_hour + RADIO_HISTORY_HOURS - hoursAgo) % RADIO_HISTORY_HOURS];
+}
+
+void RadioDutyCycle::open(uint32_t nowMs) {
+    _awake = true;
+    _openedAt = nowMs;
+    _hours[_hour].windows++;
+}
+
+void RadioDutyCycle::account(uint32_t nowMs) {
+    // Hours count from the first call, not from millis() zero
+    if (!_started) {
+        _hourStart = nowMs;
+        _lastUpdate = nowMs;
+        _started = true;
+    }
+
+    // Split the elapsed time at hour boundaries
+    while (nowMs - _hourStart >= RADIO_HOUR_MS) {
+        uint32_t hourEnd = _hourStart + RADIO_HOUR_MS;
+        if (_awake) _hours[_hour].awakeMs += hourEnd - _lastUpdate;
+        _lastUpdate = hourEnd;
+        _hourStart = hourEnd;
+
+        _hour = (_hour + 1) % RADIO_HISTORY_HOURS;
+        memset(&_hours[_hour], 0, sizeof(_hours[_hour]));
+        if (_hoursRecorded < RADIO_HISTORY_HOURS - 1) _hoursRecorded++;
+    }
+
+    if (_awake) _hours[_hour].awakeMs += nowMs - _lastUpdate;
+    _lastUpdate = nowMs;
+}
@@ -0,0 +1,136 @@
+/**
+ * Radio Duty Cycle Header
+ *
+ * Groups outbound network jobs (NTP syncs, weather fetches) into shared
+ * wake windows. Each job asks for a run between an earliest time and a
+ * deadline; the first deadline opens a window and every job whose
+ * earliest time has passed runs in it. Between windows the caller puts
+ * the modem to sleep, which keeps the station associated so the web
+ * portal stays reachable, only with beacon-interval latency.
+ */
+
+#ifndef RADIO_DUTY_H
+#define RADIO_DUTY_H
+
+#include <stdint.h>
+
+// Windows stay open at least this long (lets replies and TCP teardown through)
+#ifndef RADIO_MIN_WINDOW_MS
+#define RADIO_MIN_WINDOW_MS 500
+#endif
+
+// Hours of radio-on time kept for reporting
+#ifndef RADIO_HISTORY_HOURS
+#define RADIO_HISTORY_HOURS 24
+#endif
+
+#define RADIO_HOUR_MS 3600000UL
+
+/**
+ * Jobs that share the radio
+ */
+enum RadioJobId : uint8_t {
+    RADIO_JOB_NTP,
+    RADIO_JOB_WEATHER,
+    RADIO_JOB_COUNT
+};
+
+/**
+ * Radio use during one hour of uptime
+ */
+struct RadioHourStats {
+    uint32_t awakeMs;   // Time with power saving off
+    uint16_t windows;   // Windows opened
+};
+
+class RadioDutyCycle {
+public:
+    RadioDutyCycle();
+
+    /**
+     * Turn duty cycling on or off; while off the radio counts as always awake
+     * and jobs run at their deadlines, as if there were no coordinator
+     */
+    void setEnabled(bool enabled, uint32_t nowMs);
+    bool isEnabled() const { return _enabled; }
+
+    /**
+     * Ask for a run of a job; replaces any earlier request for it
+     * @param earliestMs Soonest the job may run if a window is open anyway
+     * @param deadlineMs When the job must run (opens a window if none is)
+     */
+    void request(uint8_t job, uint32_t earliestMs, uint32_t deadlineMs);
+
+    /**
+     * Withdraw a job's request
+     */
+    void cancel(uint8_t job);
+
+    /**
+     * Check whether a requested job should start now
+     * A true result consumes the request and marks the job busy
+     */
+    bool mayStart(uint8_t job, uint32_t nowMs);
+
+    /**
+     * Report whether a job still has traffic in flight
+     * The window stays open until every job is idle
+     */
+    void setBusy(uint8_t job, bool busy);
+
+    /**
+     * Keep the radio awake for a while (e.g. after a web portal request)
+     */
+    void holdAwake(uint32_t nowMs, uint32_t durationMs);
+
+    /**
+     * Open or close the window and account radio-on time
+     * @return true if isAwake() changed
+     */
+    bool update(uint32_t nowMs);
+
+    bool isAwake() const { return _awake; }
+
+    /**
+     * Radio use for an hour of uptime
+     * @param hoursAgo 0 = the current (partial) hour, up to RADIO_HISTORY_HOURS - 1
+     */
+    const RadioHourStats& getHour(uint8_t hoursAgo) const;
+
+    /**
+     * Time elapsed in the current hour (ms)
+     */
+    uint32_t getHourElapsedMs(uint32_t nowMs) const { return nowMs - _hourStart; }
+
+    /**
+     * Completed hours held in the history
+     */
+    uint8_t getHoursRecorded() const { return _hoursRecorded; }
+
+private:
+    struct Job {
+        uint32_t earliestMs;
+        uint32_t deadlineMs;
+        bool requested;
+        bool busy;
+    };
+    Job _jobs[RADIO_JOB_COUNT];
+    bool _enabled;
+    bool _awake;
+    uint32_t _openedAt;
+    uint32_t _holdUntil;
+    bool _holding;
+
+    // Ring of hourly totals, _hour is the current one
+    RadioHourStats _hours[RADIO_HISTORY_HOURS];
+    uint8_t _hour;
+    uint8_t _hoursRecorded;
+    uint32_t _hourStart;
+    uint32_t _lastUpdate;
+    bool _started;
+
+    void open(uint32_t nowMs);
+    void account(uint32_t nowMs);
+};
+
+#endif // RADIO_DUTY_H
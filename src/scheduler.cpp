@@ -0,0 +1,213 @@
+/**
+ * Task Scheduler Implementation
+ *
+ * Binary min-heap of deadlines over a fixed task table
+ * All time comparisons are wrap-safe for the 49-day millis() rollover
+ */
+
+#include "scheduler.h"
+
+TaskScheduler::TaskScheduler() : _count(0), _heapSize(0) {
+    for (uint8_t i = 0; i < SCHEDULER_MAX_TASKS; i++) {
+        _tasks[i].callback = nullptr;
+        _tasks[i].period = 0;
+        _tasks[i].deadline = 0;
+        _tasks[i].missed = 0;
+        _tasks[i].policy = CATCH_UP_SKIP;
+        _tasks[i].heapPos = SCHEDULER_NOT_ARMED;
+        _heap[i] = 0;
+    }
+}
+
+int8_t TaskScheduler::addTask(TaskCallback callback, uint32_t periodMs, uint32_t now,
+                              TaskCatchUp policy, uint32_t firstDelayMs) {
+    int8_t id = registerTask(callback, periodMs, policy);
+    if (id >= 0) {
+        runAt(id, now + firstDelayMs);
+    }
+    return id;
+}
+
+int8_t TaskScheduler::addOneShot(TaskCallback callback) {
+    return registerTask(callback, 0, CATCH_UP_SKIP);
+}
+
+int8_t TaskScheduler::registerTask(TaskCallback callback, uint32_t periodMs, TaskCatchUp policy) {
+    if (_count >= SCHEDULER_MAX_TASKS || callback == nullptr) {
+        return -1;
+    }
+
+    uint8_t id = _count++;
+    Task& task = _tasks[id];
+    task.callback = callback;
+    task.period = periodMs;
+    task.deadline = 0;
+    task.missed = 0;
+    task.policy = policy;
+    task.heapPos = SCHEDULER_NOT_ARMED;
+
+    return id;
+}
+
+void TaskScheduler::setPeriod(int8_t id, uint32_t periodMs) {
+    if (id < 0 || id >= _count) return;
+    _tasks[id].period = periodMs;
+}
+
+uint32_t TaskScheduler::getPeriod(int8_t id) const {
+    if (id < 0 || id >= _count) return 0;
+    return _tasks[id].period;
+}
+
+void TaskScheduler::runAt(int8_t id, uint32_t when) {
+    if (id < 0 || id >= _count) return;
+
+    Task& task = _tasks[id];
+    if (task.heapPos == SCHEDULER_NOT_ARMED) {
+        task.deadline = when;
+        arm(id);
+        return;
+    }
+
+    bool moveUp = (int32_t)(when - task.deadline) < 0;
+    task.deadline = when;
+
+    if (moveUp) {
+        siftUp(task.heapPos);
+    } else {
+        siftDown(task.heapPos);
+    }
+}
+
+void TaskScheduler::cancel(int8_t id) {
+    if (id < 0 || id >= _count) return;
+    disarm(id);
+}
+
+bool TaskScheduler::isArmed(int8_t id) const {
+    if (id < 0 || id >= _count) return false;
+    return _tasks[id].heapPos != SCHEDULER_NOT_ARMED;
+}
+
+uint8_t TaskScheduler::run(uint32_t now) {
+    uint8_t executed = 0;
+
+    // Bound the work done in one pass so a slow task can't starve loop()
+    uint16_t budget = (uint16_t)_count * (SCHEDULER_MAX_CATCH_UP + 1);
+
+    while (_heapSize > 0 && budget-- > 0) {
+        uint8_t id = _heap[0];
+        Task& task = _tasks[id];
+
+        int32_t late = (int32_t)(now - task.deadline);
+        if (late < 0) {
+            break;  // Earliest deadline is still in the future
+        }
+
+        // Advance the deadline before running so the callback may reschedule itself
+        if (task.period == 0) {
+            disarm(id);
+        } else {
+            uint32_t missedPeriods = (uint32_t)late / task.period;
+            if (missedPeriods == 0) {
+                task.deadline += task.period;
+            } else if (task.policy == CATCH_UP_ALL && missedPeriods < SCHEDULER_MAX_CATCH_UP) {
+                // Next deadline is already due and will run on the next iteration
+                task.missed++;
+                task.deadline += task.period;
+            } else {
+                // Drop the missed slots and stay on the original period grid
+                task.missed += missedPeriods;
+                task.deadline += (missedPeriods + 1) * task.period;
+            }
+            siftDown(task.heapPos);
+        }
+
+        task.callback();
+        executed++;
+    }
+
+    return executed;
+}
+
+uint32_t TaskScheduler::timeUntilNext(uint32_t now) const {
+    if (_heapSize == 0) {
+        return (uint32_t)-1;
+    }
+
+    int32_t remaining = (int32_t)(_tasks[_heap[0]].deadline - now);
+    return remaining > 0 ? (uint32_t)remaining : 0;
+}
+
+uint32_t TaskScheduler::getMissedCount(int8_t id) const {
+    if (id < 0 || id >= _count) return 0;
+    return _tasks[id].missed;
+}
+
+void TaskScheduler::arm(uint8_t id) {
+    uint8_t pos = _heapSize++;
+    _heap[pos] = id;
+    _tasks[id].heapPos = pos;
+    siftUp(pos);
+}
+
+void TaskScheduler::disarm(uint8_t id) {
+    uint8_t pos = _tasks[id].heapPos;
+    if (pos == SCHEDULER_NOT_ARMED) return;
+
+    uint8_t last = --_heapSize;
+    if (pos != last) {
+        swapNodes(pos, last);
+    }
+    _tasks[id].heapPos = SCHEDULER_NOT_ARMED;
+
+    if (pos < _heapSize) {
+        // The node moved into the hole may need to go either way
+        uint8_t moved = _heap[pos];
+        siftUp(pos);
+        siftDown(_tasks[moved].heapPos);
+    }
+}
+
+bool TaskScheduler::earlier(uint8_t a, uint8_t b) const {
+    return (int32_t)(_tasks[a].deadline - _tasks[b].deadline) < 0;
+}
+
+void TaskScheduler::swapNodes(uint8_t a, uint8_t b) {
+    uint8_t tmp = _heap[a];
+    _heap[a] = _heap[b];
+    _heap[b] = tmp;
+    _tasks[_heap[a]].heapPos = a;
+    _tasks[_heap[b]].heapPos = b;
+}
+
+void TaskScheduler::siftUp(uint8_t pos) {
+    while (pos > 0) {
+        uint8_t parent = (pos - 1) / 2;
+        if (!earlier(_heap[pos], _heap[parent])) {
+            break;
+        }
+        swapNodes(pos, parent);
+        pos = parent;
+    }
+}
+
+void TaskScheduler::siftDown(uint8_t pos) {
+    while (true) {
+        uint8_t left = 2 * pos + 1;
+        uint8_t right = left + 1;
+        uint8_t smallest = pos;
+
+        if (left < _heapSize && earlier(_heap[left], _heap[smallest])) {
+            smallest = left;
+        }
+        if (right < _heapSize && earlier(_heap[right], _heap[smallest])) {
+            smallest = right;
+        }
+        if (smallest == pos) {
+            break;
+        }
+        swapNodes(pos, smallest);
+        pos = smallest;
+    }
+}
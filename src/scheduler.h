@@ -0,0 +1,136 @@
+/**
+ * Task Scheduler Header
+ *
+ * Deadline-driven cooperative scheduler for the main loop
+ * Keeps a min-heap of task deadlines so loop() only runs what is due
+ * and can idle until the next deadline instead of polling every subsystem
+ */
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdint.h>
+
+// Maximum number of tasks (fixed storage, no heap allocation)
+#ifndef SCHEDULER_MAX_TASKS
+#define SCHEDULER_MAX_TASKS 12
+#endif
+
+// Upper bound on back-to-back catch-up runs for a single task per run() call
+#define SCHEDULER_MAX_CATCH_UP 4
+
+// Heap position of a task that is not currently armed
+#define SCHEDULER_NOT_ARMED 0xFF
+
+typedef void (*TaskCallback)();
+
+// What to do when a deadline was missed by more than one period
+enum TaskCatchUp {
+    CATCH_UP_SKIP,  // Run once, then realign to the next deadline on the period grid
+    CATCH_UP_ALL    // Run once per missed period (bounded by SCHEDULER_MAX_CATCH_UP)
+};
+
+class TaskScheduler {
+public:
+    TaskScheduler();
+
+    /**
+     * Register a periodic task
+     * @param callback Function to run when the task is due
+     * @param periodMs Period in milliseconds (0 = one-shot, runs once per arming)
+     * @param now Current time in ms (millis())
+     * @param policy Catch-up behaviour for missed deadlines
+     * @param firstDelayMs Delay before the first run (0 = run on next pass)
+     * @return Task id, or -1 if the task table is full
+     */
+    int8_t addTask(TaskCallback callback, uint32_t periodMs, uint32_t now,
+                   TaskCatchUp policy = CATCH_UP_SKIP, uint32_t firstDelayMs = 0);
+
+    /**
+     * Register a one-shot task that stays idle until armed with runAt()
+     * @param callback Function to run when the task is due
+     * @return Task id, or -1 if the task table is full
+     */
+    int8_t addOneShot(TaskCallback callback);
+
+    /**
+     * Change a task's period (takes effect after its next run)
+     */
+    void setPeriod(int8_t id, uint32_t periodMs);
+
+    /**
+     * Get a task's period
+     */
+    uint32_t getPeriod(int8_t id) const;
+
+    /**
+     * Move a task's next deadline to an absolute time (arms idle tasks)
+     * @param id Task id
+     * @param when Time in ms (millis() domain)
+     */
+    void runAt(int8_t id, uint32_t when);
+
+    /**
+     * Disarm a task until the next runAt()
+     */
+    void cancel(int8_t id);
+
+    /**
+     * Check if a task has a pending deadline
+     */
+    bool isArmed(int8_t id) const;
+
+    /**
+     * Run every task whose deadline has passed
+     * @param now Current time in ms (millis())
+     * @return Number of task callbacks executed
+     */
+    uint8_t run(uint32_t now);
+
+    /**
+     * Time until the earliest deadline
+     * @param now Current time in ms
+     * @return Milliseconds to wait (0 if a task is already due)
+     */
+    uint32_t timeUntilNext(uint32_t now) const;
+
+    /**
+     * Number of deadlines a task has missed by a full period or more
+     */
+    uint32_t getMissedCount(int8_t id) const;
+
+    /**
+     * Number of registered tasks
+     */
+    uint8_t getTaskCount() const { return _count; }
+
+private:
+    struct Task {
+        TaskCallback callback;
+        uint32_t period;
+        uint32_t deadline;
+        uint32_t missed;
+        TaskCatchUp policy;
+        uint8_t heapPos;
+    };
+
+    Task _tasks[SCHEDULER_MAX_TASKS];
+    uint8_t _heap[SCHEDULER_MAX_TASKS];  // Armed task ids ordered by deadline
+    uint8_t _count;                      // Registered tasks
+    uint8_t _heapSize;                   // Armed tasks
+
+    int8_t registerTask(TaskCallback callback, uint32_t periodMs, TaskCatchUp policy);
+    void arm(uint8_t id);
+    void disarm(uint8_t id);
+
+    /**
+     * Wrap-safe deadline comparison (true if a is earlier than b)
+     */
+    bool earlier(uint8_t a, uint8_t b) const;
+
+    void siftUp(uint8_t pos);
+    void siftDown(uint8_t pos);
+    void swapNodes(uint8_t a, uint8_t b);
+};
+
+#endif // SCHEDULER_H
@@ -0,0 +1,142 @@
+/**
+ * Text Layout Implementation
+ *
+ * Measuring is a walk over the string's glyph records; only narrowed
+ * punctuation reads bitmap rows (to find its ink)
+ */
+
+#include "text_layout.h"
+
+#include <string.h>
+
+static bool isAlnum(uint8_t c) {
+    return (c >= '0' && c <= '9') || (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z');
+}
+
+bool textGlyph(const Font& font, uint8_t c, bool narrowPunctuation, TextGlyph& glyph) {
+    bool found = fontGlyph(font, c, glyph.glyph);
+    glyph.skip = 0;
+    glyph.width = glyph.glyph.width;
+    glyph.advance = glyph.glyph.advance;
+
+    if (!narrowPunctuation || font.glyphs || isAlnum(c)) {
+        return found;
+    }
+
+    uint8_t ink = 0;
+    for (uint8_t row = 0; row < font.height; row++) {
+        ink |= fontRow(font, glyph.glyph, row);
+    }
+
+    uint8_t spacing = glyph.glyph.advance - glyph.glyph.width;
+    if (ink == 0) {
+        // Blank cell (space): half its advance
+        glyph.width = 0;
+        glyph.advance = (glyph.glyph.advance + 1) / 2;
+        return found;
+    }
+
+    uint8_t first = 0;
+    while (!(ink & (0x80 >> first))) first++;
+    uint8_t last = glyph.glyph.width - 1;
+    while (!(ink & (0x80 >> last))) last--;
+
+    glyph.skip = first;
+    glyph.width = last - first + 1;
+    glyph.advance = glyph.width + spacing;
+    return found;
+}
+
+uint16_t textMeasure(const Font& font, const char* text, bool narrowPunctuation, bool& covered) {
+    uint16_t width = 0;
+    uint8_t trailing = 0;
+    TextGlyph glyph;
+
+    covered = true;
+    while (*text) {
+        if (!textGlyph(font, (uint8_t)*text++, narrowPunctuation, glyph)) {
+            covered = false;
+        }
+        width += glyph.advance;
+        trailing = glyph.advance - glyph.width;
+    }
+    return width - trailing;
+}
+
+TextFit textFit(const char* text, const Font& font, const Font* condensed,
+                uint16_t width, TextAlign align) {
+    TextFit best;
+    best.font = nullptr;
+    best.width = 0;
+
+    // Roomiest first; the primary font is used even if it lacks characters
+    for (uint8_t attempt = 0; attempt < 4; attempt++) {
+        const Font* candidate = attempt < 2 ? &font : condensed;
+        bool narrow = attempt & 1;
+        if (!candidate) break;
+
+        bool covered;
+        uint16_t measured = textMeasure(*candidate, text, narrow, covered);
+        if (candidate != &font && !covered) break;
+
+        if (!best.font || measured < best.width) {
+            best.font = candidate;
+            best.narrowPunctuation = narrow;
+            best.width = measured;
+        }
+        if (measured <= width) break;
+    }
+
+    best.fits = best.width <= width;
+    best.x = 0;
+    if (best.fits && align == TEXT_ALIGN_CENTER) {
+        best.x = (uint8_t)((width - best.width) / 2);
+    } else if (best.fits && align == TEXT_ALIGN_RIGHT) {
+        best.x = (uint8_t)(width - best.width);
+    }
+    return best;
+}
+
+TextLayoutCache::TextLayoutCache() {
+    clear();
+}
+
+const TextFit& TextLayoutCache::fit(const char* text, const Font& font, const Font* condensed,
+                                    uint16_t width, TextAlign align) {
+    size_t length = strlen(text);
+    if (length > TEXT_LAYOUT_MAX_CHARS) {
+        _misses++;
+        _uncached = textFit(text, font, condensed, width, align);
+        return _uncached;
+    }
+
+    for (uint8_t i = 0; i < _used; i++) {
+        Entry& e = _entries[i];
+        if (e.font == &font && e.condensed == condensed && e.width == width &&
+            e.align == align && strcmp(e.text, text) == 0) {
+            _hits++;
+            return e.fit;
+        }
+    }
+
+    _misses++;
+    Entry& e = _entries[_next];
+    _next = (_next + 1) % TEXT_LAYOUT_CACHE_SIZE;
+    if (_used < TEXT_LAYOUT_CACHE_SIZE) _used++;
+
+    memcpy(e.text, text, length + 1);
+    e.font = &font;
+    e.condensed = condensed;
+    e.width = width;
+    e.align = align;
+    e.fit = textFit(text, font, condensed, width, align);
+    return e.fit;
+}
+
+void TextLayoutCache::clear() {
+    memset(_entries, 0, sizeof(_entries));
+    _used = 0;
+    _next = 0;
+    _hits = 0;
+    _misses = 0;
+}
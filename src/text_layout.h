@@ -0,0 +1,113 @@
+/**
+ * Text Layout Header
+ *
+ * Measures strings in the font atlases and fits them to a panel width:
+ * the primary font first, then with punctuation cropped to its ink, then
+ * a condensed font, and positions the result by alignment. Layouts are
+ * cached per string in a small fixed table, so static text isn't measured
+ * again every frame and nothing is allocated on the heap
+ */
+
+#ifndef TEXT_LAYOUT_H
+#define TEXT_LAYOUT_H
+
+#include <stdint.h>
+#include "font.h"
+
+// Layouts remembered (~50 bytes each)
+#ifndef TEXT_LAYOUT_CACHE_SIZE
+#define TEXT_LAYOUT_CACHE_SIZE 4
+#endif
+
+// Longest string the cache holds; longer ones are laid out on every call
+#ifndef TEXT_LAYOUT_MAX_CHARS
+#define TEXT_LAYOUT_MAX_CHARS 23
+#endif
+
+enum TextAlign : uint8_t {
+    TEXT_ALIGN_LEFT,
+    TEXT_ALIGN_CENTER,
+    TEXT_ALIGN_RIGHT
+};
+
+/**
+ * A glyph as placed by the layout
+ */
+struct TextGlyph {
+    FontGlyph glyph;
+    uint8_t skip;       // Blank columns cropped from the left of each row
+    uint8_t width;      // Columns drawn
+    uint8_t advance;    // Columns to the next glyph
+};
+
+/**
+ * How a string is drawn
+ */
+struct TextFit {
+    const Font* font;
+    bool narrowPunctuation;
+    bool fits;          // false: clipped at the right edge
+    uint8_t x;          // Column of the first glyph
+    uint16_t width;     // Columns from the first glyph to the last one drawn
+};
+
+/**
+ * Look up a character for layout
+ * Narrow punctuation crops punctuation and spaces in monospace fonts to their ink
+ * (a 5x7 colon takes 2 columns instead of 5); letters and digits keep their cells
+ * so changing digits never move the text. Variable-width fonts are already cropped
+ * @return false if the font doesn't have the character
+ */
+bool textGlyph(const Font& font, uint8_t c, bool narrowPunctuation, TextGlyph& glyph);
+
+/**
+ * Columns a string takes, without the spacing after the last glyph
+ * @param covered Output: false if the font lacks any of the characters
+ */
+uint16_t textMeasure(const Font& font, const char* text, bool narrowPunctuation, bool& covered);
+
+/**
+ * Choose font, punctuation and position for a string
+ * Tries the font, the font with narrow punctuation, then the same with the condensed
+ * font (only if it has every character). Text that fits nowhere is drawn left-aligned
+ * in whichever of those is narrowest
+ * @param condensed Fallback font, or nullptr
+ */
+TextFit textFit(const char* text, const Font& font, const Font* condensed,
+                uint16_t width, TextAlign align);
+
+class TextLayoutCache {
+public:
+    TextLayoutCache();
+
+    /**
+     * textFit(), answered from the cache when the same string was laid out
+     * with the same fonts, width and alignment
+     */
+    const TextFit& fit(const char* text, const Font& font, const Font* condensed,
+                       uint16_t width, TextAlign align);
+
+    void clear();
+
+    uint32_t getHits() const { return _hits; }
+    uint32_t getMisses() const { return _misses; }
+
+private:
+    struct Entry {
+        char text[TEXT_LAYOUT_MAX_CHARS + 1];
+        const Font* font;
+        const Font* condensed;
+        uint16_t width;
+        TextAlign align;
+        TextFit fit;
+    };
+
+    Entry _entries[TEXT_LAYOUT_CACHE_SIZE];
+    uint8_t _used;
+    uint8_t _next;      // Entry replaced next (oldest first)
+    TextFit _uncached;  // Result for strings too long to cache
+    uint32_t _hits;
+    uint32_t _misses;
+};
+
+#endif // TEXT_LAYOUT_H
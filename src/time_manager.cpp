@@ -13,21 +13,46 @@ static const int NTP_PORT = 123;
 
 TimeManager::TimeManager()
     : _lastSyncTime(0),
-      _timezoneOffset(UTC_OFFSET_SECONDS), _clockSource(nullptr),
-      _syncState(NTP_IDLE), _syncStartTime(0),
-      _lastTimeInfoUpdate(0) {
-    memset(&_timeInfo, 0, sizeof(_timeInfo));
+      _clockSource(nullptr),
+      _syncState(NTP_IDLE), _syncStartTime(0), _roundStart(0),
+      _roundsDone(0), _burstSize(1), _gotSample(false), _roundOnClock(false),
+      _peerCount(0), _resolveIndex(0), _pollsSinceFullRound(0), _lastReplies(0), _lastTruechimers(0), _systemPeer(-1),
+      _syncReplies(0), _syncKisses(0), _syncBadReplies(0), _kissPeer(-1),
+      _syncCorrection(NTP_CORRECTION_NONE),
+      _lastOffsetMs(0), _lastDelayMs(0),
+      _lastCorrectionMillis(0), _haveCorrection(false), _stepCount(0),
+      _lastDriftSave(0), _driftSaved(false), _rtcTrimmed(false),
+      _poll(NTP_MIN_POLL, NTP_MAX_POLL, NTP_UNLOCKED_MAX_POLL), _nextPollMillis(0),
+      _radio(nullptr), _serving(false) {
     memset(_ntpPacketBuffer, 0, LOCAL_NTP_PACKET_SIZE);
+    memset(&_serverInfo, 0, sizeof(_serverInfo));
+    _timezone.parse(TIMEZONE);
+    takeSnapshot();
 }
 
 void TimeManager::begin() {
     _udp.begin(NTP_PORT);
     Serial.println("TimeManager initialized (non-blocking)");
-    Serial.printf("Timezone offset: %ld seconds\n", _timezoneOffset);
+    Serial.printf("Timezone offset: %ld seconds (%s)\n", getTimezoneOffset(), getTimezoneAbbreviation());
     
     if (_clockSource) {
         _clockSource->begin();
         Serial.printf("Clock source: %s\n", _clockSource->getName());
+        
+        // Start from the drift learned before the last reboot
+        _discipline.setFrequencyPpb(configManager.getClockDriftPpb());
+        _clockSource->setFrequencyPpb(_discipline.getFrequencyPpb());
+        Serial.printf("Clock drift correction: %.3f ppm\n", _discipline.getFrequencyPpb() / 1000.0f);
+        
+        if (_clockSource->hasAgingTrim()) {
+            const ClockConfig& cfg = configManager.getConfig();
+            _rtcTrimmed = cfg.rtcCalTime != 0;
+            int8_t aging;
+            if (_clockSource->getAgingOffset(aging)) {
+                Serial.printf("RTC aging offset: %d (%s)\n", aging,
+                              _rtcTrimmed ? "calibrated" : "not calibrated");
+            }
+        }
     } else {
         Serial.println("WARNING: No clock source set!");
     }
@@ -38,15 +63,41 @@ void TimeManager::begin() {
 
 void TimeManager::setClockSource(ClockSource* source) {
     _clockSource = source;
+    
+    // A different oscillator needs a fresh frequency estimate and close polling
+    _discipline.reset();
+    _calibrator.reset();
+    _haveCorrection = false;
+    _poll.reset();
+    _nextPollMillis = millis() + _poll.getIntervalMs();
+    _serverInfo.synced = false;  // Not vouching for the new clock until it has synced
     if (_clockSource) {
         Serial.printf("TimeManager: Clock source set to %s\n", _clockSource->getName());
     }
 }
 
 void TimeManager::update() {
+    // Replies and LAN requests share the socket, so it is read even between syncs
+    receivePackets();
+    
     // Process NTP state machine
     if (_syncState != NTP_IDLE) {
         processNtpState();
+    } else if (_radio) {
+        unsigned long early = _poll.getIntervalMs() / RADIO_EARLY_DIVISOR;
+        _radio->request(RADIO_JOB_NTP, _nextPollMillis - early, _nextPollMillis);
+        if (_radio->mayStart(RADIO_JOB_NTP, millis())) {
+            Serial.printf("NTP: Poll in radio window (%ld s before due)\n",
+                          (long)(_nextPollMillis - millis()) / 1000);
+            startSync();
+        }
+    } else if ((long)(millis() - _nextPollMillis) >= 0) {
+        Serial.printf("NTP: Poll due (interval %lu s)\n", (unsigned long)(_poll.getIntervalMs() / 1000));
+        startSync();
+    }
+    
+    if (_radio) {
+        _radio->setBusy(RADIO_JOB_NTP, _syncState != NTP_IDLE);
     }
     
     // Update clock source
@@ -60,62 +111,110 @@ void TimeManager::startSync() {
         return;  // Already syncing
     }
     
+    // Retry at the shortest interval unless the sync succeeds; set before the
+    // Wi-Fi check so an offline poll waits out the interval instead of every pass
+    _nextPollMillis = millis() + (1000UL << NTP_MIN_POLL);
+    
     if (WiFi.status() != WL_CONNECTED) {
         Serial.println("NTP: WiFi not connected");
         return;
     }
     
     Serial.println("NTP: Starting non-blocking sync...");
-    _syncState = NTP_SENDING;
+    
     _syncStartTime = millis();
+    _roundsDone = 0;
+    _gotSample = false;
+    _syncReplies = 0;
+    _syncKisses = 0;
+    _syncBadReplies = 0;
+    _kissPeer = -1;
+    _syncCorrection = NTP_CORRECTION_NONE;
+    
+    // Once the filter holds a burst, most polls only ask the server the last sync
+    // selected; a full round re-checks it against the others every
+    // NTP_FULL_ROUND_POLLS polls, and after any failed sync (no system peer)
+    if (_systemPeer >= 0 && _filter.count() >= NTP_BURST_SAMPLES &&
+        _pollsSinceFullRound + 1 < NTP_FULL_ROUND_POLLS) {
+        _peers[0].address = _peers[_systemPeer].address;
+        _peers[0].pending = false;
+        _peers[0].answered = false;
+        _peerCount = 1;
+        _pollsSinceFullRound++;
+        _syncState = NTP_SENDING;
+    } else {
+        _peerCount = 0;
+        _resolveIndex = 0;
+        _pollsSinceFullRound = 0;
+        _syncState = NTP_RESOLVING;
+    }
+    _systemPeer = -1;
+    
+    // Burst while the filter is filling (like ntpd's iburst), single round after
+    _burstSize = _filter.count() < NTP_BURST_SAMPLES ? NTP_BURST_SAMPLES : 1;
 }
 
 void TimeManager::setTime(unsigned long epoch) {
     if (_clockSource) {
-        // Apply timezone to get local time
-        _clockSource->setEpochTime(epoch + _timezoneOffset);
+        _clockSource->setEpochTime(epoch);
     }
-    updateTimeInfo();
 }
 
 bool TimeManager::isSyncing() const {
     return _syncState != NTP_IDLE;
 }
 
+unsigned long TimeManager::getMillisUntilPoll() const {
+    long left = (long)(_nextPollMillis - millis());
+    return left > 0 ? (unsigned long)left : 0;
+}
+
 void TimeManager::processNtpState() {
-    // Check for timeout
-    if (millis() - _syncStartTime > NTP_TIMEOUT) {
-        Serial.println("NTP: Sync timeout");
-        _syncState = NTP_IDLE;
-        return;
-    }
-    
     switch (_syncState) {
+        case NTP_RESOLVING:
+            if (!resolveNextPeer()) {
+                break;  // More names to look up on the next pass
+            }
+            if (_peerCount == 0) {
+                Serial.println("NTP: Could not resolve any server");
+                _syncState = NTP_IDLE;
+                recordSync(NTP_SYNC_DNS_FAILED);
+            } else {
+                _syncState = NTP_SENDING;
+            }
+            break;
+            
         case NTP_SENDING:
-            if (sendNtpPacket()) {
+            if (sendRound()) {
                 _syncState = NTP_WAITING;
             } else {
                 Serial.println("NTP: Failed to send packet");
                 _syncState = NTP_IDLE;
+                recordSync(NTP_SYNC_SEND_FAILED);
             }
             break;
             
-        case NTP_WAITING:
-            if (_udp.parsePacket() >= LOCAL_NTP_PACKET_SIZE) {
+        case NTP_WAITING: {
+            // Replies were read by receivePackets()
+            uint8_t answered = 0;
+            uint8_t pending = 0;
+            for (uint8_t i = 0; i < _peerCount; i++) {
+                if (_peers[i].answered) answered++;
+                if (_peers[i].pending) pending++;
+            }
+            
+            // Done as soon as a quorum answers; stragglers are not waited for
+            uint8_t quorum = _peerCount < NTP_QUORUM ? _peerCount : NTP_QUORUM;
+            if (answered >= quorum || pending == 0 ||
+                millis() - _roundStart > NTP_REQUEST_TIMEOUT) {
                 _syncState = NTP_RECEIVED;
             }
-            // Stay in waiting state until packet arrives or timeout
             break;
+        }
             
         case NTP_RECEIVED:
-            if (parseNtpResponse()) {
-                _lastSyncTime = millis();
-                Serial.printf("NTP: Synced - %02d:%02d:%02d\n", 
-                              getHours(), getMinutes(), getSeconds());
-            } else {
-                Serial.println("NTP: Failed to parse response");
-            }
-            _syncState = NTP_IDLE;
+            finishRound();
+            nextRound();
             break;
             
         case NTP_ERROR:
@@ -126,81 +225,515 @@ void TimeManager::processNtpState() {
     }
 }
 
-bool TimeManager::sendNtpPacket() {
-    // Initialize NTP packet
-    memset(_ntpPacketBuffer, 0, LOCAL_NTP_PACKET_SIZE);
+void TimeManager::receivePackets() {
+    uint8_t served = 0;
+    int size;
+    while (served < NTP_SERVE_PER_PASS && (size = _udp.parsePacket()) > 0) {
+        unsigned long arrival = millis();
+        if (size >= LOCAL_NTP_PACKET_SIZE) {
+            _udp.read(_ntpPacketBuffer, LOCAL_NTP_PACKET_SIZE);
+            
+            uint8_t mode = _ntpPacketBuffer[0] & 0x07;
+            if (mode == 3) {
+                if (_serving) {
+                    serveRequest();
+                    served++;
+                }
+            } else if (_syncState == NTP_WAITING) {
+                handleReply(arrival);
+            }
+        }
+        _udp.flush();
+    }
+}
+
+void TimeManager::serveRequest() {
+    if (!isTimeValid()) return;
+    
+    // T2 is taken when the packet is read, up to NTP_SERVE_POLL_INTERVAL after it arrived
+    // (plus whatever task was running then)
+    IPAddress client = _udp.remoteIP();
+    uint16_t port = _udp.remotePort();
+    NtpServeResult result = _server.handle(_ntpPacketBuffer, LOCAL_NTP_PACKET_SIZE, (uint32_t)client,
+                                           millis(), getUtcMillis(), _serverInfo);
+    if (result != NTP_SERVE_REPLY) return;
+    
+    if (_udp.beginPacket(client, port) == 0) return;
+    NtpServer::stampTransmit(_ntpPacketBuffer, getUtcMillis());
+    _udp.write(_ntpPacketBuffer, LOCAL_NTP_PACKET_SIZE);
+    _udp.endPacket();
+}
+
+void TimeManager::setServeEnabled(bool enabled) {
+    if (enabled == _serving) return;
+    _serving = enabled;
+    _server.reset();
+    Serial.printf("NTP: Serving time to the LAN %s\n", enabled ? "enabled" : "disabled");
+}
+
+void TimeManager::updateServerInfo() {
+    if (_systemPeer < 0 || !isTimeValid()) return;
+    
+    const NtpPeer& peer = _peers[_systemPeer];
+    _serverInfo.stratum = peer.stratum < 15 ? peer.stratum + 1 : 15;
+    for (uint8_t i = 0; i < 4; i++) {
+        _serverInfo.refId[i] = peer.address[i];
+    }
+    _serverInfo.refTimeMs = getUtcMillis();
     
-    // Set NTP header values
-    _ntpPacketBuffer[0] = 0b11100011;  // LI=3, Version=4, Mode=3 (client)
-    _ntpPacketBuffer[1] = 0;           // Stratum
-    _ntpPacketBuffer[2] = 6;           // Polling interval
-    _ntpPacketBuffer[3] = 0xEC;        // Precision
-    // 8 bytes of zero (Root Delay, Root Dispersion)
-    _ntpPacketBuffer[12] = 49;         // Reference ID "1"
-    _ntpPacketBuffer[13] = 0x4E;       // "N"
-    _ntpPacketBuffer[14] = 49;         // "1"
-    _ntpPacketBuffer[15] = 52;         // "4"
-    
-    // Get NTP server from config
+    // Our distance from the primary reference: theirs plus the path and jitter to them
+    _serverInfo.rootDelayMs = peer.rootDelayMs + (uint32_t)peer.result.delayMs;
+    _serverInfo.rootDispersionMs = peer.rootDispersionMs + _filter.jitterMs() + 1;
+    _serverInfo.synced = true;
+}
+
+bool TimeManager::resolveNextPeer() {
     const char* server = configManager.getNtpServer();
     
-    // Send packet
-    if (_udp.beginPacket(server, NTP_PORT) == 0) {
-        return false;
+    // Bare pool names expand to the numbered zones, which resolve to distinct members
+    size_t len = strlen(server);
+    bool isPool = len >= 12 && strcmp(server + len - 12, "pool.ntp.org") == 0 &&
+                  !(server[0] >= '0' && server[0] <= '9' && server[1] == '.');
+    
+    uint8_t names = isPool ? NTP_MAX_SERVERS : 1;
+    if (_resolveIndex >= names) {
+        return true;
     }
     
-    _udp.write(_ntpPacketBuffer, LOCAL_NTP_PACKET_SIZE);
+    char host[72];
+    if (isPool) {
+        snprintf(host, sizeof(host), "%u.%s", _resolveIndex, server);
+    } else {
+        strlcpy(host, server, sizeof(host));
+    }
+    _resolveIndex++;
     
-    return _udp.endPacket() == 1;
+    IPAddress ip;
+    if (WiFi.hostByName(host, ip, NTP_DNS_TIMEOUT) == 1) {
+        // Skip duplicates (zones can overlap)
+        bool duplicate = false;
+        for (uint8_t i = 0; i < _peerCount; i++) {
+            if (_peers[i].address == ip) duplicate = true;
+        }
+        if (!duplicate) {
+            _peers[_peerCount].address = ip;
+            _peers[_peerCount].pending = false;
+            _peers[_peerCount].answered = false;
+            _peerCount++;
+        }
+    }
+    
+    return _resolveIndex >= names;
+}
+
+bool TimeManager::sendRound() {
+    _roundOnClock = isTimeValid();
+    _roundStart = millis();
+    bool sent = false;
+    
+    for (uint8_t i = 0; i < _peerCount; i++) {
+        NtpPeer& peer = _peers[i];
+        peer.pending = false;
+        peer.answered = false;
+        
+        // Initialize NTP packet
+        memset(_ntpPacketBuffer, 0, LOCAL_NTP_PACKET_SIZE);
+        
+        // Set NTP header values
+        _ntpPacketBuffer[0] = 0b11100011;  // LI=3, Version=4, Mode=3 (client)
+        _ntpPacketBuffer[1] = 0;           // Stratum
+        _ntpPacketBuffer[2] = 6;           // Polling interval
+        _ntpPacketBuffer[3] = 0xEC;        // Precision
+        // 8 bytes of zero (Root Delay, Root Dispersion)
+        _ntpPacketBuffer[12] = 49;         // Reference ID "1"
+        _ntpPacketBuffer[13] = 0x4E;       // "N"
+        _ntpPacketBuffer[14] = 49;         // "1"
+        _ntpPacketBuffer[15] = 52;         // "4"
+        
+        if (_udp.beginPacket(peer.address, NTP_PORT) == 0) {
+            continue;
+        }
+        
+        // Transmit timestamp (T1): the server echoes it back as the origin timestamp
+        // The lowest fraction bits (well below 1 ms) make it unique per peer
+        peer.sentMillis = millis();
+        ntpWriteTimestampMs(getLocalMillis(), &_ntpPacketBuffer[40]);
+        _ntpPacketBuffer[46] = (uint8_t)random(256);
+        _ntpPacketBuffer[47] = i;
+        memcpy(peer.origin, &_ntpPacketBuffer[40], sizeof(peer.origin));
+        
+        _udp.write(_ntpPacketBuffer, LOCAL_NTP_PACKET_SIZE);
+        if (_udp.endPacket() == 1) {
+            peer.pending = true;
+            sent = true;
+        }
+    }
+    
+    return sent;
 }
 
-bool TimeManager::parseNtpResponse() {
-    // Read packet into buffer
-    _udp.read(_ntpPacketBuffer, LOCAL_NTP_PACKET_SIZE);
+void TimeManager::handleReply(unsigned long arrival) {
+    // Must be a server reply (mode 4) to a request still outstanding
+    if ((_ntpPacketBuffer[0] & 0x07) != 4) return;
+    
+    NtpPeer* peer = nullptr;
+    for (uint8_t i = 0; i < _peerCount; i++) {
+        if (_peers[i].pending &&
+            memcmp(&_ntpPacketBuffer[24], _peers[i].origin, sizeof(_peers[i].origin)) == 0) {
+            peer = &_peers[i];
+        }
+    }
+    if (!peer) {
+        Serial.println("NTP: Ignoring unexpected packet");
+        return;
+    }
+    peer->pending = false;
+    
+    // Stratum 0 is a kiss-o'-death, 16 is unsynchronized
+    uint8_t stratum = _ntpPacketBuffer[1];
+    if (stratum == 0 || stratum >= 16) {
+        Serial.printf("NTP: %s not usable (stratum %u)\n",
+                      peer->address.toString().c_str(), stratum);
+        if (stratum == 0) {
+            _syncKisses++;
+            _kissPeer = (int8_t)(peer - _peers);
+        } else {
+            _syncBadReplies++;
+        }
+        return;
+    }
+    
+    // Receive (T2, bytes 32-39) and transmit (T3, bytes 40-47) timestamps
+    uint64_t t2 = ntpReadTimestampMs(&_ntpPacketBuffer[32]);
+    uint64_t t3 = ntpReadTimestampMs(&_ntpPacketBuffer[40]);
+    if (t2 == 0 || t3 == 0) {
+        _syncBadReplies++;
+        return;
+    }
     
-    // Extract transmit timestamp (bytes 40-43)
-    // NTP timestamp is seconds since 1900, we need Unix epoch (since 1970)
-    unsigned long highWord = word(_ntpPacketBuffer[40], _ntpPacketBuffer[41]);
-    unsigned long lowWord = word(_ntpPacketBuffer[42], _ntpPacketBuffer[43]);
+    // Local timestamps T1/T4 on the round's timescale, spaced by millis()
+    int64_t t4 = (int64_t)getLocalMillis() - (int64_t)(millis() - arrival);
+    int64_t t1 = t4 - (int64_t)(arrival - peer->sentMillis);
+    NtpSample sample = ntpComputeSample(t1, (int64_t)t2, (int64_t)t3, t4);
     
-    // Combine into seconds since 1900
-    unsigned long secsSince1900 = (highWord << 16) | lowWord;
+    // Error bound includes the server's own distance from its reference
+    uint32_t rootDelay = ntpReadShortMs(&_ntpPacketBuffer[4]);
+    uint32_t rootDispersion = ntpReadShortMs(&_ntpPacketBuffer[8]);
     
-    // Unix epoch starts 1970-01-01, NTP starts 1900-01-01
-    // Difference is 70 years = 2208988800 seconds
-    const unsigned long seventyYears = 2208988800UL;
+    peer->result.offsetMs = sample.offsetMs;
+    peer->result.delayMs = sample.delayMs;
+    peer->result.rootDistanceMs = sample.delayMs / 2 + rootDelay / 2 + rootDispersion + 1;
+    peer->stratum = stratum;
+    peer->rootDelayMs = rootDelay;
+    peer->rootDispersionMs = rootDispersion;
+    peer->answered = true;
+}
+
+void TimeManager::finishRound() {
+    NtpCandidate candidates[NTP_MAX_SERVERS];
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < _peerCount; i++) {
+        if (_peers[i].answered) {
+            candidates[n++] = _peers[i].result;
+        }
+        _peers[i].pending = false;
+    }
+    _lastReplies = n;
+    _syncReplies += n;
     
-    if (secsSince1900 < seventyYears) {
-        return false;  // Invalid response
+    NtpSelection selection;
+    if (!ntpSelectSources(candidates, n, selection)) {
+        _lastTruechimers = 0;
+        Serial.printf("NTP: %u/%u replies, no majority agrees\n", n, _peerCount);
+        return;
     }
+    _lastTruechimers = selection.truechimers;
     
-    // Convert to Unix epoch and apply timezone
-    unsigned long epochTime = secsSince1900 - seventyYears + _timezoneOffset;
+    // The lowest-delay truechimer is our reference when serving time
+    uint8_t k = 0;
+    _systemPeer = -1;
+    for (uint8_t i = 0; i < _peerCount; i++) {
+        if (!_peers[i].answered) continue;
+        if ((selection.trueMask & (1 << k)) &&
+            (_systemPeer < 0 || _peers[i].result.delayMs < _peers[_systemPeer].result.delayMs)) {
+            _systemPeer = (int8_t)i;
+        }
+        k++;
+    }
     
-    // Update clock source
-    if (_clockSource) {
-        _clockSource->setEpochTime(epochTime);
+    if (!_roundOnClock) {
+        // Measured against millis(): set the clock directly, the filter starts over
+        setUtcMillis((uint64_t)((int64_t)millis() + selection.offsetMs));
+        _filter.clear();
+        _lastCorrectionMillis = millis();
+        _haveCorrection = true;
+        _gotSample = true;
+        _syncCorrection = NTP_CORRECTION_SET;
+        return;
     }
     
-    return true;
+    NtpSample sample;
+    sample.offsetMs = selection.offsetMs;
+    sample.delayMs = selection.delayMs;
+    sample.takenAt = millis();
+    
+    if (_filter.add(sample)) {
+        _gotSample = true;
+    } else {
+        Serial.printf("NTP: Rejected sample (delay %ld ms)\n", (long)sample.delayMs);
+    }
 }
 
-void TimeManager::updateTimeInfo() const {
+void TimeManager::nextRound() {
+    _roundsDone++;
+    if (_roundsDone < _burstSize) {
+        _syncState = NTP_SENDING;
+    } else {
+        finishSync();
+        _syncState = NTP_IDLE;
+    }
+}
+
+void TimeManager::finishSync() {
+    if (!_gotSample) {
+        Serial.println("NTP: Sync failed, no usable replies");
+        if (_syncKisses > 0) {
+            recordSync(NTP_SYNC_KOD);
+        } else if (_syncReplies > 0) {
+            recordSync(NTP_SYNC_NO_MAJORITY);
+        } else if (_syncBadReplies > 0) {
+            recordSync(NTP_SYNC_BAD_REPLY);
+        } else {
+            recordSync(NTP_SYNC_TIMEOUT);
+        }
+        return;
+    }
+    
+    // Samples that already drove a correction would only report it back as ~0
+    const NtpSample* best = _filter.freshBest();
+    if (best && isTimeValid()) {
+        // Correct the clock by the best offset measured since the last correction
+        _lastOffsetMs = (int32_t)best->offsetMs;
+        _lastDelayMs = best->delayMs;
+        applyCorrection(best->offsetMs, best->takenAt);
+    }
+    
+    _lastSyncTime = millis();
+    _nextPollMillis = _lastSyncTime + _poll.getIntervalMs();
+    updateServerInfo();
+    recordSync(NTP_SYNC_OK);
+    Serial.printf("NTP: Synced - %02d:%02d:%02d (offset %ld ms, delay %ld ms, jitter %u ms, %u/%u servers, drift %.3f ppm, next in %lu s)\n",
+                  getHours(), getMinutes(), getSeconds(),
+                  (long)_lastOffsetMs, (long)_lastDelayMs, (unsigned)_filter.jitterMs(),
+                  _lastTruechimers, _peerCount, _discipline.getFrequencyPpb() / 1000.0f,
+                  (unsigned long)(_poll.getIntervalMs() / 1000));
+}
+
+void TimeManager::recordSync(NtpSyncOutcome outcome) {
+    NtpSyncRecord r;
+    memset(&r, 0, sizeof(r));
+    r.utc = isTimeValid() ? getEpochTime() : 0;
+    r.outcome = outcome;
+    r.correction = outcome == NTP_SYNC_OK ? _syncCorrection : NTP_CORRECTION_NONE;
+    r.replies = _syncReplies;
+    r.pollExponent = _poll.getExponent();
+    
+    if (r.correction == NTP_CORRECTION_SLEW || r.correction == NTP_CORRECTION_STEP ||
+        r.correction == NTP_CORRECTION_HELD) {
+        r.offsetMs = _lastOffsetMs;
+        r.delayMs = _lastDelayMs;
+    } else if (r.correction == NTP_CORRECTION_SET && _systemPeer >= 0) {
+        r.delayMs = _peers[_systemPeer].result.delayMs;
+    }
+    
+    // The server that answered for us, or the one that told us to go away
+    int8_t peer = outcome == NTP_SYNC_KOD ? _kissPeer : (outcome == NTP_SYNC_OK ? _systemPeer : -1);
+    if (peer >= 0) {
+        for (uint8_t i = 0; i < 4; i++) {
+            r.server[i] = _peers[peer].address[i];
+        }
+    }
+    
+    _stats.add(r);
+}
+
+void TimeManager::applyCorrection(int64_t offsetMs, uint32_t takenAt) {
+    uint32_t interval = _haveCorrection ? millis() - _lastCorrectionMillis : 0;
+    bool trimmed = _clockSource->hasAgingTrim();
+    
+    // Drift is measured up to when the offset was taken; an offset from before the
+    // last correction already went into it and must not count again
+    int32_t measured = (int32_t)(takenAt - (uint32_t)_lastCorrectionMillis);
+    uint32_t fllInterval = _haveCorrection && measured > 0 ? (uint32_t)measured : 0;
+    
+    // A hardware oscillator's rate can't follow every sync; it is trimmed over long baselines
+    DisciplineResult result = _discipline.sample(offsetMs, _clockSource->getPendingSlewMs(),
+                                                 trimmed ? 0 : fllInterval);
+    bool hold = false;
+    if (trimmed) {
+        // Small errors stay in the RTC so write lag isn't measured as drift
+        bool ready = _calibrator.sample(offsetMs, interval);
+        hold = !_calibrator.needsWrite();
+        if (ready) {
+            calibrateRtc();
+        }
+    } else {
+        _clockSource->setFrequencyPpb(result.freqPpb);
+    }
+    
+    if (result.step) {
+        Serial.printf("NTP: Stepping clock by %ld ms\n", (long)offsetMs);
+        setUtcMillis(getUtcMillis() + offsetMs);
+        _stepCount++;
+        _syncCorrection = NTP_CORRECTION_STEP;
+    } else if (hold) {
+        _syncCorrection = NTP_CORRECTION_HELD;
+    } else {
+        // Small offsets are slewed in so the display never jumps or repeats a second
+        _clockSource->slew((int32_t)offsetMs);
+        _syncCorrection = NTP_CORRECTION_SLEW;
+    }
+    
+    _filter.applyCorrection(hold ? 0 : offsetMs);
+    _lastCorrectionMillis = millis();
+    _haveCorrection = true;
+    
+    // A held RTC's offset is its accumulated error; the latest change is what a
+    // correction every sync would have been
+    int64_t pollOffset = hold ? _calibrator.getChangeMs() : offsetMs;
+    _poll.update(pollOffset, _filter.jitterMs(), result.step, isDisciplined());
+    
+    if (!trimmed) {
+        persistDrift();
+    }
+}
+
+bool TimeManager::isDisciplined() const {
+    if (_clockSource && _clockSource->hasAgingTrim()) {
+        return _rtcTrimmed;
+    }
+    return _discipline.isLocked();
+}
+
+void TimeManager::calibrateRtc() {
+    // Without the trim in effect there is nothing to adjust or record;
+    // the baseline keeps growing and the next sync tries again
+    int8_t before;
+    if (!_clockSource->getAgingOffset(before)) {
+        Serial.println("RTC: Aging offset unreadable, calibration postponed");
+        return;
+    }
+    
+    int32_t drift = _calibrator.getDriftPpb();
+    int8_t after = _calibrator.agingFor(before);
+    unsigned long hours = (unsigned long)(_calibrator.getBaselineMs() / 3600000ULL);
+    _calibrator.reset();
+    
+    ClockConfig& cfg = configManager.getConfig();
+    
+    // The previous write is judged by the drift over the baseline that followed it
+    if (cfg.rtcCalTime != 0 && !cfg.rtcCalVerified) {
+        cfg.rtcDriftAfterPpb = drift;
+        cfg.rtcCalVerified = true;
+        Serial.printf("RTC: Aging %d -> %d changed drift from %.2f to %.2f ppm\n",
+                      cfg.rtcAgingBefore, cfg.rtcAgingAfter,
+                      cfg.rtcDriftBeforePpb / 1000.0f, drift / 1000.0f);
+    }
+    
+    _rtcTrimmed = after == before;
+    if (after != before) {
+        Serial.printf("RTC: Drift %.2f ppm over %lu h, aging offset %d -> %d\n",
+                      drift / 1000.0f, hours, before, after);
+        // A failed write leaves the old trim, which the next baseline measures again
+        if (_clockSource->setAgingOffset(after)) {
+            cfg.rtcCalTime = (uint32_t)(getUtcMillis() / 1000ULL);
+            cfg.rtcAgingBefore = before;
+            cfg.rtcAgingAfter = after;
+            cfg.rtcDriftBeforePpb = drift;
+            cfg.rtcDriftAfterPpb = 0;
+            cfg.rtcCalVerified = false;
+        }
+    } else {
+        Serial.printf("RTC: Drift %.2f ppm, aging offset %d is within one step\n",
+                      drift / 1000.0f, before);
+    }
+    
+    configManager.save();
+}
+
+void TimeManager::persistDrift() {
+    if (!_discipline.isLocked()) return;
+    
+    int32_t freq = _discipline.getFrequencyPpb();
+    int32_t change = freq - configManager.getClockDriftPpb();
+    if (change < CLOCK_LOCK_TOLERANCE_PPB && change > -CLOCK_LOCK_TOLERANCE_PPB) return;
+    
+    // Limit flash wear: once per boot, then at most every NTP_DRIFT_SAVE_INTERVAL
+    if (_driftSaved && millis() - _lastDriftSave < NTP_DRIFT_SAVE_INTERVAL) return;
+    
+    configManager.setClockDriftPpb(freq);
+    if (configManager.save()) {
+        _lastDriftSave = millis();
+        _driftSaved = true;
+        Serial.printf("NTP: Saved clock drift %.3f ppm\n", freq / 1000.0f);
+    }
+}
+
+uint64_t TimeManager::getUtcMillis() const {
+    if (!_clockSource) return 0;
+    return _clockSource->getEpochMillis();
+}
+
+void TimeManager::setUtcMillis(uint64_t utcMs) {
     if (!_clockSource) return;
+    _clockSource->setEpochMillis(utcMs);
+}
+
+uint64_t TimeManager::getLocalMillis() const {
+    return _roundOnClock ? getUtcMillis() : (uint64_t)millis();
+}
+
+const CivilDate& TimeManager::getLocalDate() const {
+    return _dateMemo.get(getLocalEpochTime());
+}
+
+void TimeManager::takeSnapshot() {
+    TimeSnapshot& s = _snapshot;
+    s.valid = isTimeValid();
     
-    unsigned long now = millis();
-    if (now - _lastTimeInfoUpdate < 100) {
-        return;  // Don't update too frequently
+    // The only clock read of the tick
+    unsigned long local = 0;
+    if (s.valid) {
+        s.utcMillis = _clockSource->getEpochMillis();
+        unsigned long utc = (unsigned long)(s.utcMillis / 1000ULL);
+        s.dst = _timezone.isDst(utc);
+        s.utcOffset = s.dst ? _timezone.getDstOffset() : _timezone.getStdOffset();
+        s.zone = _timezone.getAbbreviation(utc);
+        local = utc + s.utcOffset;
+    } else {
+        s.utcMillis = 0;
+        s.dst = false;
+        s.utcOffset = 0;
+        s.zone = "UTC";
     }
-    _lastTimeInfoUpdate = now;
     
-    time_t t = _clockSource->getEpochTime();
-    gmtime_r(&t, &_timeInfo);
+    const CivilDate& date = _dateMemo.get(local);
+    s.year = date.year;
+    s.month = date.month;
+    s.day = date.day;
+    s.dayOfWeek = date.weekday;
+    
+    unsigned long secondOfDay = local % SECONDS_PER_DAY;
+    s.hours = secondOfDay / 3600;
+    s.minutes = (secondOfDay / 60) % 60;
+    s.seconds = secondOfDay % 60;
+    s.millis = (uint16_t)(s.utcMillis % 1000ULL);
+    s.pm = s.hours >= 12;
 }
 
 int TimeManager::getHours() const {
     if (!_clockSource || !_clockSource->isValid()) return 0;
-    return (_clockSource->getEpochTime() % 86400) / 3600;
+    return (getLocalEpochTime() % 86400) / 3600;
 }
 
 int TimeManager::getHours12() const {
@@ -216,32 +749,28 @@ bool TimeManager::isPM() const {
 
 int TimeManager::getMinutes() const {
     if (!_clockSource || !_clockSource->isValid()) return 0;
-    return (_clockSource->getEpochTime() % 3600) / 60;
+    return (getLocalEpochTime() % 3600) / 60;
 }
 
 int TimeManager::getSeconds() const {
     if (!_clockSource || !_clockSource->isValid()) return 0;
-    return _clockSource->getEpochTime() % 60;
+    return getLocalEpochTime() % 60;
 }
 
 int TimeManager::getYear() const {
-    updateTimeInfo();
-    return _timeInfo.tm_year + 1900;
+    return getLocalDate().year;
 }
 
 int TimeManager::getMonth() const {
-    updateTimeInfo();
-    return _timeInfo.tm_mon + 1;
+    return getLocalDate().month;
 }
 
 int TimeManager::getDay() const {
-    updateTimeInfo();
-    return _timeInfo.tm_mday;
+    return getLocalDate().day;
 }
 
 int TimeManager::getDayOfWeek() const {
-    updateTimeInfo();
-    return _timeInfo.tm_wday;
+    return getLocalDate().weekday;
 }
 
 bool TimeManager::isTimeValid() const {
@@ -253,13 +782,40 @@ unsigned long TimeManager::getEpochTime() const {
     return _clockSource->getEpochTime();
 }
 
-void TimeManager::setTimezoneOffset(long offset) {
-    // Adjust epoch time for the offset change
-    if (_clockSource && _clockSource->isValid()) {
-        unsigned long currentEpoch = _clockSource->getEpochTime();
-        _clockSource->setEpochTime(currentEpoch - _timezoneOffset + offset);
+uint64_t TimeManager::getEpochMillis() const {
+    if (!_clockSource) return 0;
+    return _clockSource->getEpochMillis();
+}
+
+unsigned long TimeManager::getMillisToNextSecond() const {
+    if (!isTimeValid()) return 1000;
+    return 1000 - (unsigned long)(getEpochMillis() % 1000ULL);
+}
+
+unsigned long TimeManager::getLocalEpochTime() const {
+    if (!_clockSource) return 0;
+    unsigned long utc = _clockSource->getEpochTime();
+    return utc + _timezone.offsetAt(utc);
+}
+
+bool TimeManager::setTimezone(const char* posix) {
+    if (!_timezone.parse(posix)) {
+        Serial.printf("TimeManager: Invalid timezone \"%s\", keeping previous\n", posix ? posix : "");
+        return false;
     }
-    _timezoneOffset = offset;
+    return true;
+}
+
+long TimeManager::getTimezoneOffset() const {
+    return _timezone.offsetAt(getEpochTime());
+}
+
+bool TimeManager::isDst() const {
+    return _timezone.isDst(getEpochTime());
+}
+
+const char* TimeManager::getTimezoneAbbreviation() const {
+    return _timezone.getAbbreviation(getEpochTime());
 }
 
 // Legacy blocking sync
@@ -267,10 +823,12 @@ bool TimeManager::sync() {
     startSync();
     
     unsigned long start = millis();
-    while (_syncState != NTP_IDLE && millis() - start < NTP_TIMEOUT) {
+    unsigned long limit = (unsigned long)_burstSize * NTP_REQUEST_TIMEOUT;
+    while (_syncState != NTP_IDLE && millis() - start <= limit) {
+        receivePackets();
         processNtpState();
         yield();
     }
     
-    return isTimeValid() && (millis() - _lastSyncTime < 5000);
+    return isTimeValid() && (millis() - _lastSyncTime <= limit);
 }
@@ -4,6 +4,7 @@
  * Handles NTP synchronization and time tracking
  * Uses non-blocking UDP for NTP requests
  * Delegates time storage to ClockSource implementations
+ * Clocks hold UTC; the timezone is applied when time is read
  */
 
 #ifndef TIME_MANAGER_H
@@ -11,20 +12,50 @@
 
 #include "config.h"
 #include "clock_source.h"
+#include "ntp_math.h"
+#include "clock_discipline.h"
+#include "ntp_server.h"
+#include "ntp_stats.h"
+#include "radio_duty.h"
+#include "timezone.h"
+#include "civil_time.h"
 #include <Arduino.h>
 #include <ESP8266WiFi.h>
 #include <WiFiUdp.h>
-#include <time.h>
 
 // NTP sync states for non-blocking operation
 enum NtpSyncState {
     NTP_IDLE,
+    NTP_RESOLVING,
     NTP_SENDING,
     NTP_WAITING,
     NTP_RECEIVED,
     NTP_ERROR
 };
 
+/**
+ * Local time broken down from a single clock read
+ * Every field describes the same instant, so a frame can't mix two seconds
+ */
+struct TimeSnapshot {
+    uint64_t utcMillis;     // Instant the fields describe (UTC ms)
+    int32_t utcOffset;      // Seconds east of UTC, daylight saving included
+    const char* zone;       // Abbreviation in effect (e.g. "PDT")
+    int32_t year;
+    uint8_t month;          // 1-12
+    uint8_t day;            // 1-31
+    uint8_t dayOfWeek;      // 0 = Sunday
+    uint8_t hours;          // 0-23
+    uint8_t minutes;
+    uint8_t seconds;
+    uint16_t millis;
+    bool pm;
+    bool dst;
+    bool valid;             // False until a clock source has the time (fields then read 1970-01-01 00:00)
+
+    uint8_t hours12() const { return hours == 0 ? 12 : (hours > 12 ? hours - 12 : hours); }
+};
+
 class TimeManager {
 public:
     TimeManager();
@@ -40,6 +71,14 @@ public:
      */
     void update();
 
+    /**
+     * Read queued packets: replies go to the sync in progress, requests to the server
+     * At most NTP_SERVE_PER_PASS requests are answered per call. update() calls it
+     * too; while serving, call it every NTP_SERVE_POLL_INTERVAL ms so requests are
+     * stamped (T2) close to when they arrived
+     */
+    void receivePackets();
+
     /**
      * Set the clock source to use
      * @param source Pointer to a ClockSource implementation
@@ -65,6 +104,7 @@ public:
 
     /**
      * Manually set the time (useful for testing/debugging)
+     * @param epoch Unix time (UTC)
      */
     void setTime(unsigned long epoch);
 
@@ -88,6 +128,17 @@ public:
      */
     bool isPM() const;
 
+    /**
+     * Read the clock once and break it down into local time
+     * Call once per loop iteration; everything that runs in it shares the result
+     */
+    void takeSnapshot();
+    
+    /**
+     * Local time as of the last takeSnapshot()
+     */
+    const TimeSnapshot& snapshot() const { return _snapshot; }
+
     /**
      * Get current minute (0-59)
      */
@@ -124,24 +175,133 @@ public:
     bool isTimeValid() const;
 
     /**
-     * Get epoch time
+     * Get epoch time (UTC)
      */
     unsigned long getEpochTime() const;
 
     /**
-     * Set timezone offset in seconds from UTC
+     * Get epoch time with millisecond resolution (UTC)
+     */
+    uint64_t getEpochMillis() const;
+
+    /**
+     * Get local time as seconds since 1970-01-01 00:00:00 local
+     */
+    unsigned long getLocalEpochTime() const;
+
+    /**
+     * Milliseconds until the displayed second next changes
+     * @return 1-1000 (1000 if time is not valid)
+     */
+    unsigned long getMillisToNextSecond() const;
+
+    /**
+     * Set the timezone from a POSIX TZ string (e.g. "PST8PDT,M3.2.0,M11.1.0")
+     * @return false (timezone unchanged) if the string is malformed
+     */
+    bool setTimezone(const char* posix);
+
+    /**
+     * Current offset from UTC in seconds (daylight saving included)
+     */
+    long getTimezoneOffset() const;
+
+    /**
+     * Check if daylight saving time is in effect
+     */
+    bool isDst() const;
+
+    /**
+     * Current zone abbreviation (e.g. "PDT")
+     */
+    const char* getTimezoneAbbreviation() const;
+
+    /**
+     * Offset of the best filtered sample at the last sync (server - local, ms)
+     */
+    int32_t getLastOffsetMs() const { return _lastOffsetMs; }
+
+    /**
+     * Round-trip delay of the best filtered sample at the last sync (ms)
+     */
+    int32_t getLastDelayMs() const { return _lastDelayMs; }
+
+    /**
+     * RMS spread of the offsets in the clock filter (ms)
+     */
+    uint32_t getJitterMs() const { return _filter.jitterMs(); }
+
+    /**
+     * Servers that answered / were selected in the last round
+     */
+    uint8_t getLastReplies() const { return _lastReplies; }
+    uint8_t getLastTruechimers() const { return _lastTruechimers; }
+
+    /**
+     * Frequency correction learned by the clock discipline (ppb)
+     */
+    int32_t getFrequencyPpb() const { return _discipline.getFrequencyPpb(); }
+
+    /**
+     * True once the frequency estimate has settled
+     * (for a DS3231: once its aging offset has been calibrated)
+     */
+    bool isDisciplined() const;
+
+    /**
+     * Baseline collected toward the next DS3231 aging calibration (ms)
+     */
+    uint64_t getRtcCalBaselineMs() const { return _calibrator.getBaselineMs(); }
+
+    /**
+     * Number of corrections that were stepped rather than slewed
+     */
+    uint32_t getStepCount() const { return _stepCount; }
+
+    /**
+     * Current poll exponent (interval is 2^exponent seconds)
      */
-    void setTimezoneOffset(long offset);
+    uint8_t getPollExponent() const { return _poll.getExponent(); }
 
     /**
-     * Get current timezone offset
+     * Current poll interval in ms
      */
-    long getTimezoneOffset() const { return _timezoneOffset; }
+    unsigned long getPollIntervalMs() const { return _poll.getIntervalMs(); }
+
+    /**
+     * Time until the next poll is due in ms (0 if it already is)
+     */
+    unsigned long getMillisUntilPoll() const;
+
+    /**
+     * Results of recent syncs with jitter and availability figures
+     */
+    const NtpStats& getStats() const { return _stats; }
+
+    /**
+     * Answer NTP client requests from the LAN on the NTP port
+     * Replies advertise the upstream stratum + 1 once a sync has succeeded
+     */
+    void setServeEnabled(bool enabled);
+    bool isServing() const { return _serving; }
+
+    /**
+     * Requests answered / dropped by the per-client rate limit
+     */
+    uint32_t getServedCount() const { return _server.getServed(); }
+    uint32_t getRateLimitedCount() const { return _server.getLimited(); }
+
+    /**
+     * Run polls through the radio duty cycle instead of on their own schedule
+     * A poll may then start up to 1/RADIO_EARLY_DIVISOR of the interval early
+     * @param radio Coordinator, or nullptr to poll independently
+     */
+    void setRadio(RadioDutyCycle* radio) { _radio = radio; }
 
 private:
     WiFiUDP _udp;
     unsigned long _lastSyncTime;
-    long _timezoneOffset;
+    mutable TimeZone _timezone;  // Caches the year's transitions on lookup
     
     // Clock source (delegates time storage)
     ClockSource* _clockSource;
@@ -149,13 +309,72 @@ private:
     // Non-blocking NTP state
     NtpSyncState _syncState;
     unsigned long _syncStartTime;
-    static const unsigned long NTP_TIMEOUT = 5000;  // 5 seconds
+    unsigned long _roundStart;           // millis() when the current round was sent
+    uint8_t _roundsDone;                 // Rounds completed in the current sync
+    uint8_t _burstSize;                  // Rounds planned for the current sync
+    bool _gotSample;                     // Any usable round in the current sync
+    bool _roundOnClock;                  // Round measured against the clock (else millis())
     static const int LOCAL_NTP_PACKET_SIZE = 48;
     uint8_t _ntpPacketBuffer[48];
+
+    // Servers queried concurrently in each round
+    struct NtpPeer {
+        IPAddress address;
+        uint8_t origin[8];               // Transmit timestamp we sent, echoed back as origin
+        unsigned long sentMillis;        // T1 in the millis() domain
+        bool pending;
+        bool answered;
+        NtpCandidate result;
+        uint8_t stratum;
+        uint32_t rootDelayMs;
+        uint32_t rootDispersionMs;
+    };
+    NtpPeer _peers[NTP_MAX_SERVERS];
+    uint8_t _peerCount;
+    uint8_t _resolveIndex;               // Next server name to look up
+    uint8_t _pollsSinceFullRound;        // Syncs that asked only the system peer
+    uint8_t _lastReplies;
+    uint8_t _lastTruechimers;
+    int8_t _systemPeer;                  // Lowest-delay truechimer of the last good round (-1 = none)
+    
+    // What happened during the current sync, recorded in _stats when it ends
+    NtpStats _stats;
+    uint8_t _syncReplies;                // Usable replies across rounds
+    uint8_t _syncKisses;                 // Kiss-o'-death replies
+    uint8_t _syncBadReplies;             // Unsynchronized or malformed replies
+    int8_t _kissPeer;                    // Peer that sent the last KoD (-1 = none)
+    NtpCorrection _syncCorrection;
+
+    // Clock filter and last sync result
+    NtpClockFilter _filter;
+    int32_t _lastOffsetMs;
+    int32_t _lastDelayMs;
+    
+    // Frequency discipline
+    ClockDiscipline _discipline;
+    unsigned long _lastCorrectionMillis;  // millis() of the last applied correction
+    bool _haveCorrection;
+    uint32_t _stepCount;
+    unsigned long _lastDriftSave;
+    bool _driftSaved;
+    
+    // Aging offset calibration for clocks with a hardware trim (DS3231)
+    AgingCalibrator _calibrator;
+    bool _rtcTrimmed;
+    
+    // Adaptive poll interval (syncs are started from update())
+    PollController _poll;
+    unsigned long _nextPollMillis;
+    RadioDutyCycle* _radio;
+    
+    // SNTP server sharing the client socket
+    NtpServer _server;
+    NtpServerInfo _serverInfo;
+    bool _serving;
     
-    // Cached time components
-    mutable struct tm _timeInfo;
-    mutable unsigned long _lastTimeInfoUpdate;
+    // Local date, recomputed once per day
+    mutable CivilDateMemo _dateMemo;
+    TimeSnapshot _snapshot;
 
     /**
      * Process the NTP state machine
@@ -163,19 +382,86 @@ private:
     void processNtpState();
     
     /**
-     * Send NTP request packet
+     * Answer the client request in _ntpPacketBuffer
+     */
+    void serveRequest();
+    
+    /**
+     * Take the server's stratum and error bounds from the system peer after a sync
+     */
+    void updateServerInfo();
+    
+    /**
+     * Resolve the next name of the configured server into a peer address
+     * "pool.ntp.org"-style names expand to up to NTP_MAX_SERVERS numbered pool zones;
+     * one name is looked up per update() pass so slow DNS can't stall the loop for long
+     * @return true once every name has been tried
+     */
+    bool resolveNextPeer();
+    
+    /**
+     * Send one request to every peer
+     * @return true if at least one request went out
+     */
+    bool sendRound();
+    
+    /**
+     * Match a reply to its peer by origin timestamp and record the candidate
+     * @param arrival millis() when the packet was read (T4)
      */
-    bool sendNtpPacket();
+    void handleReply(unsigned long arrival);
     
     /**
-     * Parse NTP response and update time
+     * Select truechimers from the round's replies and feed the filter
+     */
+    void finishRound();
+
+    /**
+     * Start the next burst round or finish the sync
+     */
+    void nextRound();
+
+    /**
+     * Apply the best filtered sample to the clock source
+     */
+    void finishSync();
+
+    /**
+     * Add the sync that just ended to the statistics ring
+     */
+    void recordSync(NtpSyncOutcome outcome);
+
+    /**
+     * Step or slew the clock by an offset and update its frequency
+     * @param takenAt millis() when the offset was measured
+     */
+    void applyCorrection(int64_t offsetMs, uint32_t takenAt);
+
+    /**
+     * Save the learned frequency once it has settled
+     */
+    void persistDrift();
+
+    /**
+     * Write a new aging offset from a completed calibration baseline
+     */
+    void calibrateRtc();
+
+    /**
+     * Clock source time in UTC
+     */
+    uint64_t getUtcMillis() const;
+    void setUtcMillis(uint64_t utcMs);
+
+    /**
+     * Local timescale for T1/T4: UTC clock if valid at round start, else millis()
      */
-    bool parseNtpResponse();
+    uint64_t getLocalMillis() const;
     
     /**
-     * Update cached time info struct
+     * Local date for the current time
      */
-    void updateTimeInfo() const;
+    const CivilDate& getLocalDate() const;
 };
 
 #endif // TIME_MANAGER_H
@@ -0,0 +1,229 @@
+/**
+ * Timezone Implementation
+ *
+ * Date arithmetic comes from civil_time.h
+ */
+
+#include "timezone.h"
+#include "civil_time.h"
+
+#include <string.h>
+
+// Local midnight of the rule's day, as days since 1970-01-01
+static int64_t ruleDay(const TzRule& rule, int32_t year) {
+    int64_t jan1 = daysFromCivil(year, 1, 1);
+
+    switch (rule.type) {
+        case TzRule::JULIAN:
+            return jan1 + rule.day - 1 + ((isLeapYear(year) && rule.day >= 60) ? 1 : 0);
+        case TzRule::DAY_OF_YEAR:
+            return jan1 + rule.day;
+        case TzRule::MONTH_WEEK_DAY:
+        default: {
+            int64_t first = daysFromCivil(year, rule.month, 1);
+            int wdayFirst = civilFromDays((int32_t)first).weekday;
+            int mday = 1 + (rule.day - wdayFirst + 7) % 7 + (rule.week - 1) * 7;
+            while (mday > daysInMonth(year, rule.month)) {
+                mday -= 7;  // Week 5 means the last one
+            }
+            return first + mday - 1;
+        }
+    }
+}
+
+// [+-]hh[:mm[:ss]] in seconds; hours up to maxHours
+static bool parseTime(const char*& p, int32_t maxHours, int32_t& out) {
+    int sign = 1;
+    if (*p == '+' || *p == '-') {
+        if (*p == '-') sign = -1;
+        p++;
+    }
+    if (*p < '0' || *p > '9') return false;
+
+    int32_t parts[3] = {0, 0, 0};
+    for (int i = 0; i < 3; i++) {
+        if (i > 0) {
+            if (*p != ':') break;
+            p++;
+        }
+        if (*p < '0' || *p > '9') return false;
+        int32_t v = 0;
+        for (int digits = 0; *p >= '0' && *p <= '9'; digits++) {
+            if (digits == 3) return false;
+            v = v * 10 + (*p++ - '0');
+        }
+        parts[i] = v;
+    }
+
+    if (parts[0] > maxHours || parts[1] > 59 || parts[2] > 59) return false;
+    out = sign * (parts[0] * 3600 + parts[1] * 60 + parts[2]);
+    return true;
+}
+
+static bool parseNumber(const char*& p, uint16_t maxValue, uint16_t& out) {
+    if (*p < '0' || *p > '9') return false;
+    uint32_t v = 0;
+    while (*p >= '0' && *p <= '9') {
+        v = v * 10 + (*p++ - '0');
+        if (v > maxValue) return false;
+    }
+    out = (uint16_t)v;
+    return true;
+}
+
+// "EST" or quoted "<+0530>"
+static bool parseName(const char*& p, char* out) {
+    size_t len = 0;
+    if (*p == '<') {
+        p++;
+        while (*p && *p != '>') {
+            bool ok = (*p >= 'A' && *p <= 'Z') || (*p >= 'a' && *p <= 'z') ||
+                      (*p >= '0' && *p <= '9') || *p == '+' || *p == '-';
+            if (!ok || len + 1 >= TZ_NAME_MAX) return false;
+            out[len++] = *p++;
+        }
+        if (*p != '>') return false;
+        p++;
+    } else {
+        while ((*p >= 'A' && *p <= 'Z') || (*p >= 'a' && *p <= 'z')) {
+            if (len + 1 >= TZ_NAME_MAX) return false;
+            out[len++] = *p++;
+        }
+    }
+    out[len] = 0;
+    return len >= 3;
+}
+
+static bool parseRule(const char*& p, TzRule& rule) {
+    uint16_t v;
+    if (*p == 'M') {
+        p++;
+        rule.type = TzRule::MONTH_WEEK_DAY;
+        if (!parseNumber(p, 12, v) || v < 1) return false;
+        rule.month = (uint8_t)v;
+        if (*p++ != '.' || !parseNumber(p, 5, v) || v < 1) return false;
+        rule.week = (uint8_t)v;
+        if (*p++ != '.' || !parseNumber(p, 6, v)) return false;
+        rule.day = v;
+    } else if (*p == 'J') {
+        p++;
+        rule.type = TzRule::JULIAN;
+        if (!parseNumber(p, 365, v) || v < 1) return false;
+        rule.day = v;
+    } else {
+        rule.type = TzRule::DAY_OF_YEAR;
+        if (!parseNumber(p, 365, v)) return false;
+        rule.day = v;
+    }
+
+    rule.timeSec = 2 * 3600;  // Default transition time 02:00
+    if (*p == '/') {
+        p++;
+        if (!parseTime(p, 167, rule.timeSec)) return false;  // RFC 8536 extension
+    }
+    return true;
+}
+
+TimeZone::TimeZone()
+    : _stdOffset(0), _dstOffset(0), _hasDst(false),
+      _yearStart(0), _yearEnd(0), _dstStart(0), _dstEnd(0) {
+    strcpy(_stdName, "UTC");
+    strcpy(_dstName, "UTC");
+    memset(&_startRule, 0, sizeof(_startRule));
+    memset(&_endRule, 0, sizeof(_endRule));
+}
+
+bool TimeZone::parse(const char* posix) {
+    if (!posix) return false;
+
+    const char* p = posix;
+    char stdName[TZ_NAME_MAX];
+    char dstName[TZ_NAME_MAX];
+    int32_t stdWest;
+    TzRule startRule;
+    TzRule endRule;
+
+    if (!parseName(p, stdName)) return false;
+    if (!parseTime(p, 24, stdWest)) return false;
+
+    // POSIX offsets count west of Greenwich, ours count east
+    int32_t stdOffset = -stdWest;
+    int32_t dstOffset = stdOffset;
+    bool hasDst = *p != 0;
+
+    if (hasDst) {
+        if (!parseName(p, dstName)) return false;
+
+        dstOffset = stdOffset + 3600;
+        if (*p != ',' && *p != 0) {
+            int32_t dstWest;
+            if (!parseTime(p, 24, dstWest)) return false;
+            dstOffset = -dstWest;
+        }
+
+        if (*p == ',') {
+            p++;
+            if (!parseRule(p, startRule)) return false;
+            if (*p++ != ',') return false;
+            if (!parseRule(p, endRule)) return false;
+        } else {
+            const char* us = "M3.2.0,M11.1.0";
+            parseRule(us, startRule);
+            us++;
+            parseRule(us, endRule);
+        }
+        if (*p != 0) return false;
+    } else {
+        strcpy(dstName, stdName);
+    }
+
+    strcpy(_stdName, stdName);
+    strcpy(_dstName, dstName);
+    _stdOffset = stdOffset;
+    _dstOffset = dstOffset;
+    _hasDst = hasDst;
+    if (hasDst) {
+        _startRule = startRule;
+        _endRule = endRule;
+    }
+
+    // Force the transitions to be recomputed on the next lookup
+    _yearStart = 0;
+    _yearEnd = 0;
+    return true;
+}
+
+void TimeZone::computeYear(int64_t utc) {
+    const int64_t dayLength = SECONDS_PER_DAY;
+    int64_t days = utc >= 0 ? utc / dayLength : (utc - dayLength + 1) / dayLength;
+    int32_t year = civilFromDays((int32_t)days).year;
+
+    _yearStart = (int64_t)daysFromCivil(year, 1, 1) * dayLength;
+    _yearEnd = (int64_t)daysFromCivil(year + 1, 1, 1) * dayLength;
+
+    // Start is given in standard time, end in daylight time
+    _dstStart = ruleDay(_startRule, year) * dayLength + _startRule.timeSec - _stdOffset;
+    _dstEnd = ruleDay(_endRule, year) * dayLength + _endRule.timeSec - _dstOffset;
+}
+
+bool TimeZone::isDst(int64_t utc) {
+    if (!_hasDst) return false;
+
+    if (utc < _yearStart || utc >= _yearEnd) {
+        computeYear(utc);
+    }
+
+    if (_dstStart < _dstEnd) {
+        return utc >= _dstStart && utc < _dstEnd;
+    }
+    // Southern hemisphere: DST spans the new year
+    return utc < _dstEnd || utc >= _dstStart;
+}
+
+int32_t TimeZone::offsetAt(int64_t utc) {
+    return isDst(utc) ? _dstOffset : _stdOffset;
+}
+
+const char* TimeZone::getAbbreviation(int64_t utc) {
+    return isDst(utc) ? _dstName : _stdName;
+}
@@ -0,0 +1,99 @@
+/**
+ * Timezone Header
+ *
+ * POSIX TZ strings (e.g. "PST8PDT,M3.2.0,M11.1.0") with daylight saving
+ * The year's two transition instants are computed once, after which
+ * converting UTC to local time is a pair of comparisons
+ */
+
+#ifndef TIMEZONE_H
+#define TIMEZONE_H
+
+#include <stdint.h>
+
+// Longest zone abbreviation kept (POSIX requires at least 3 characters)
+#define TZ_NAME_MAX 16
+
+/**
+ * When a transition happens, in local time
+ */
+struct TzRule {
+    enum Type : uint8_t {
+        MONTH_WEEK_DAY,  // Mm.w.d: day d (0 = Sunday) of week w (5 = last) of month m
+        JULIAN,          // Jn: day n (1-365), February 29 is never counted
+        DAY_OF_YEAR      // n: day n (0-365), February 29 is counted
+    };
+    Type type;
+    uint8_t month;
+    uint8_t week;
+    uint16_t day;        // Weekday for MONTH_WEEK_DAY, day number otherwise
+    int32_t timeSec;     // Local time of day (may be negative or past 24 h)
+};
+
+class TimeZone {
+public:
+    /**
+     * UTC with no daylight saving
+     */
+    TimeZone();
+
+    /**
+     * Parse a POSIX TZ string
+     * Without rules after the DST name the US rules (M3.2.0,M11.1.0) apply
+     * @param posix e.g. "CET-1CEST,M3.5.0,M10.5.0/3" or "<+0530>-5:30"
+     * @return false (zone unchanged) if the string is malformed
+     */
+    bool parse(const char* posix);
+
+    /**
+     * Offset to add to UTC to get local time
+     * @param utc Unix time in seconds
+     * @return Seconds east of UTC
+     */
+    int32_t offsetAt(int64_t utc);
+
+    /**
+     * Check if daylight saving is in effect
+     * @param utc Unix time in seconds
+     */
+    bool isDst(int64_t utc);
+
+    /**
+     * Zone abbreviation in effect (e.g. "PST" or "PDT")
+     * @param utc Unix time in seconds
+     */
+    const char* getAbbreviation(int64_t utc);
+
+    bool hasDst() const { return _hasDst; }
+    int32_t getStdOffset() const { return _stdOffset; }
+    int32_t getDstOffset() const { return _dstOffset; }
+
+    /**
+     * Transition instants of the cached year (UTC seconds)
+     * Valid after a lookup in that year
+     */
+    int64_t getDstStart() const { return _dstStart; }
+    int64_t getDstEnd() const { return _dstEnd; }
+
+private:
+    int32_t _stdOffset;          // Seconds east of UTC
+    int32_t _dstOffset;
+    bool _hasDst;
+    TzRule _startRule;
+    TzRule _endRule;
+    char _stdName[TZ_NAME_MAX];
+    char _dstName[TZ_NAME_MAX];
+
+    // Transitions of the year [_yearStart, _yearEnd) in UTC
+    int64_t _yearStart;
+    int64_t _yearEnd;
+    int64_t _dstStart;
+    int64_t _dstEnd;
+
+    /**
+     * Compute the transitions for the UTC year containing utc
+     */
+    void computeYear(int64_t utc);
+};
+
+#endif // TIMEZONE_H
@@ -11,8 +11,23 @@
 
 #include "vfd_driver.h"
 
+#ifdef VFD_SPI_SOFT_LSB
+// Bit-reversed nibbles, used to send LSB-first bytes over an MSB-first bus
+static const uint8_t NIBBLE_REVERSE[16] = {
+    0x0, 0x8, 0x4, 0xC, 0x2, 0xA, 0x6, 0xE,
+    0x1, 0x9, 0x5, 0xD, 0x3, 0xB, 0x7, 0xF
+};
+
+static inline uint8_t reverseBits(uint8_t b) {
+  return (NIBBLE_REVERSE[b & 0x0F] << 4) | NIBBLE_REVERSE[b >> 4];
+}
+#endif
+
 VFDDriver::VFDDriver()
-    : _brightness(VFD_DEFAULT_BRIGHTNESS), _cursorPos(0), _initialized(false), _rotated(false) {}
+    : _brightness(VFD_DEFAULT_BRIGHTNESS), _cursorPos(0), _initialized(false), _rotated(false),
+      _canvas(_canvasWords, VFD_CANVAS_WIDTH, VFD_CELL_HEIGHT) {
+  invalidate();
+}
 
 void VFDDriver::begin() {
   // Configure pins
@@ -37,9 +52,10 @@ void VFDDriver::begin() {
 
   delay(100); // Wait for VFD to stabilize
 
-  // Initialize display
+  // Initialize display (digit RAM content is unknown after reset)
   wake();
   setBrightness(_brightness);
+  invalidate();
   clear();
 
   _initialized = true;
@@ -48,12 +64,10 @@ void VFDDriver::begin() {
 }
 
 void VFDDriver::clear() {
-  // Clear all digit positions
-  for (uint8_t i = 0; i < VFD_NUM_DIGITS; i++) {
-    setCursor(i);
-    sendData(' '); // Space character
-  }
-  setCursor(0);
+  // Blank all digit positions (only digits not already blank are sent)
+  char frame[VFD_NUM_DIGITS];
+  memset(frame, ' ', sizeof(frame));
+  pushFrame(frame);
 }
 
 void VFDDriver::setBrightness(uint8_t brightness) {
@@ -83,40 +97,105 @@ void VFDDriver::setCursor(uint8_t position) {
 }
 
 void VFDDriver::print(const char *text) {
-  setCursor(0);
-
-  // If rotated, we need to reverse the string
-  if (_rotated) {
-    // Calculate string length (up to display width)
-    uint8_t len = 0;
-    while (text[len] && len < VFD_NUM_DIGITS) len++;
-    
-    // Print in reverse order
-    uint8_t pos = 0;
-    for (int8_t i = len - 1; i >= 0; i--) {
-      printChar(text[i]);
-      pos++;
-    }
-    
-    // Pad with spaces
-    while (pos < VFD_NUM_DIGITS) {
-      printChar(' ');
-      pos++;
-    }
-  } else {
-    uint8_t pos = 0;
-    while (*text && pos < VFD_NUM_DIGITS) {
-      printChar(*text);
-      text++;
-      pos++;
+  // Compose the full line, padded with spaces
+  char frame[VFD_NUM_DIGITS];
+  memset(frame, ' ', sizeof(frame));
+
+  uint8_t len = 0;
+  while (text[len] && len < VFD_NUM_DIGITS) len++;
+
+  // If rotated, the string is shown in reverse order
+  for (uint8_t i = 0; i < len; i++) {
+    frame[i] = _rotated ? text[len - 1 - i] : text[i];
+  }
+
+  pushFrame(frame);
+}
+
+void VFDDriver::present() {
+  if (!_canvas.isDirty()) {
+    return;
+  }
+
+  // Digits outside the dirty columns keep what they show
+  char frame[VFD_NUM_DIGITS];
+  for (uint8_t pos = 0; pos < VFD_NUM_DIGITS; pos++) {
+    frame[pos] = _shadowValid[pos] ? _shadow[pos] : ' ';
+  }
+
+  const CanvasRect &dirty = _canvas.getDirty();
+  uint8_t first = dirty.x / VFD_CELL_WIDTH;
+  uint8_t last = (dirty.x + dirty.width - 1) / VFD_CELL_WIDTH;
+
+  for (uint8_t cell = first; cell <= last; cell++) {
+    // Column patterns, bit r = row r (LSB = top row)
+    // Flipped: the cell goes to the mirrored digit with columns and rows reversed
+    uint8_t pattern[VFD_CELL_WIDTH];
+    for (uint8_t col = 0; col < VFD_CELL_WIDTH; col++) {
+      uint8_t bits = 0;
+      for (uint8_t row = 0; row < VFD_CELL_HEIGHT; row++) {
+        if (_canvas.getPixel(cell * VFD_CELL_WIDTH + col, row)) {
+          bits |= 1 << (_rotated ? VFD_CELL_HEIGHT - 1 - row : row);
+        }
+      }
+      pattern[_rotated ? VFD_CELL_WIDTH - 1 - col : col] = bits;
     }
 
-    // Pad with spaces if string is shorter than display
-    while (pos < VFD_NUM_DIGITS) {
-      printChar(' ');
-      pos++;
+    uint8_t digit = _rotated ? VFD_NUM_DIGITS - 1 - cell : cell;
+    defineCustomChar(digit, pattern);
+    frame[digit] = (char)digit;
+  }
+
+  _canvas.clearDirty();
+  pushFrame(frame);
+}
+
+void VFDDriver::pushFrame(const char *frame) {
+  _stats.frames++;
+
+  // Find the span of digits that differ from the shadow
+  int8_t first = -1;
+  int8_t last = -1;
+  for (uint8_t pos = 0; pos < VFD_NUM_DIGITS; pos++) {
+    if (!_shadowValid[pos] || _shadow[pos] != frame[pos]) {
+      if (first < 0) first = pos;
+      last = pos;
     }
   }
+
+  if (first < 0) {
+    return;  // Hardware already shows this frame
+  }
+
+  // One burst covering the span is cheaper than a transaction per changed run
+  writeDcram(first, frame + first, last - first + 1);
+  _stats.framesPushed++;
+}
+
+void VFDDriver::writeDcram(uint8_t start, const char *data, uint8_t len) {
+  if (start >= VFD_NUM_DIGITS) return;
+  if (len > VFD_NUM_DIGITS - start) len = VFD_NUM_DIGITS - start;
+
+  // DCRAM write: low bits of the command select the start address,
+  // the PT6301 auto-increments the address after each data byte
+  uint8_t buf[VFD_NUM_DIGITS + 1];
+  buf[0] = VFD_CMD_WRITE_DATA | start;
+  memcpy(buf + 1, data, len);
+
+  beginTransaction();
+  transferBytes(buf, len + 1);
+  endTransaction();
+
+  memcpy(_shadow + start, data, len);
+  memset(_shadowValid + start, true, len);
+
+  // The controller's address has moved past the burst; printChar() follows on from it
+  _cursorPos = (start + len) % VFD_NUM_DIGITS;
+}
+
+void VFDDriver::invalidate() {
+  memset(_shadow, 0, sizeof(_shadow));
+  memset(_shadowValid, 0, sizeof(_shadowValid));
 }
 
 void VFDDriver::setRotation(bool flipped) {
@@ -129,6 +208,9 @@ void VFDDriver::printChar(char c) {
   transferByte(c);
   endTransaction();
 
+  _shadow[_cursorPos] = c;
+  _shadowValid[_cursorPos] = true;
+
   _cursorPos++;
   if (_cursorPos >= VFD_NUM_DIGITS) {
     _cursorPos = 0;
@@ -146,6 +228,9 @@ void VFDDriver::writeRaw(uint8_t position, uint16_t data) {
   transferByte(data & 0xFF);
   transferByte((data >> 8) & 0xFF);
   endTransaction();
+
+  // Raw segments don't correspond to a character
+  _shadowValid[position] = false;
 }
 
 void VFDDriver::standby() {
@@ -166,16 +251,22 @@ void VFDDriver::defineCustomChar(uint8_t slot, const uint8_t *pattern) {
   if (slot >= 8)
     return; // Only 8 custom character slots
 
-  // Custom character definition command
+  // Custom char definition command followed by the pattern
+  // (typically 5 bytes for 5x7 matrix)
+  uint8_t buf[6];
+  buf[0] = 0x80 | slot;
+  memcpy(buf + 1, pattern, 5);
+
   beginTransaction();
-  transferByte(0x80 | slot); // Custom char definition command
+  transferBytes(buf, sizeof(buf));
+  endTransaction();
 
-  // Send pattern data (typically 5 bytes for 5x7 matrix)
-  for (uint8_t i = 0; i < 5; i++) {
-    transferByte(pattern[i]);
+  // Digits showing this slot changed appearance
+  for (uint8_t i = 0; i < VFD_NUM_DIGITS; i++) {
+    if ((uint8_t)_shadow[i] == slot) {
+      _shadowValid[i] = false;
+    }
   }
-
-  endTransaction();
 }
 
 void VFDDriver::sendCommand(uint8_t cmd) {
@@ -193,9 +284,14 @@ void VFDDriver::sendData(uint8_t data) {
 
 void VFDDriver::beginTransaction() {
   // SPI Mode 3: CPOL=1, CPHA=1
+#ifdef VFD_SPI_SOFT_LSB
+  SPI.beginTransaction(SPISettings(VFD_SPI_SPEED, MSBFIRST, SPI_MODE3));
+#else
   SPI.beginTransaction(SPISettings(VFD_SPI_SPEED, LSBFIRST, SPI_MODE3));
+#endif
   digitalWrite(VFD_PIN_CS, LOW);
   delayMicroseconds(1);
+  _stats.transactions++;
 }
 
 void VFDDriver::endTransaction() {
@@ -204,4 +300,25 @@ void VFDDriver::endTransaction() {
   SPI.endTransaction();
 }
 
-void VFDDriver::transferByte(uint8_t data) { SPI.transfer(data); }
+void VFDDriver::transferByte(uint8_t data) {
+#ifdef VFD_SPI_SOFT_LSB
+  data = reverseBits(data);
+#endif
+  unsigned long start = micros();
+  SPI.transfer(data);
+  _stats.busMicros += micros() - start;
+  _stats.bytesSent++;
+}
+
+void VFDDriver::transferBytes(uint8_t *data, uint8_t len) {
+#ifdef VFD_SPI_SOFT_LSB
+  for (uint8_t i = 0; i < len; i++) {
+    data[i] = reverseBits(data[i]);
+  }
+#endif
+  // Whole buffer goes through the hardware FIFO in one call
+  unsigned long start = micros();
+  SPI.writeBytes(data, len);
+  _stats.busMicros += micros() - start;
+  _stats.bytesSent += len;
+}
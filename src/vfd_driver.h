@@ -3,6 +3,8 @@
  *
  * Driver for FUTABA 8-MD-06INKM Dot Matrix VFD Display
  * Uses PT6301 controller with SPI interface
+ * The canvas is the digits' 5x7 cells side by side (the gaps between digits
+ * are not pixels); present() shows cells through the eight CGRAM slots
  */
 
 #ifndef VFD_DRIVER_H
@@ -22,6 +24,11 @@
 #define VFD_CMD_WRITE_DATA 0x20
 #define VFD_CMD_CLEAR_DISPLAY 0x40
 
+// Each digit is a 5x7 dot cell
+#define VFD_CELL_WIDTH 5
+#define VFD_CELL_HEIGHT 7
+#define VFD_CANVAS_WIDTH (VFD_NUM_DIGITS * VFD_CELL_WIDTH)
+
 class VFDDriver : public DisplayDriver {
 public:
   VFDDriver();
@@ -91,6 +98,18 @@ public:
    */
   void defineCustomChar(uint8_t slot, const uint8_t *pattern);
 
+  /**
+   * Get the pixel canvas (VFD_CANVAS_WIDTH x 7, one 5-column cell per digit)
+   */
+  Canvas *getCanvas() override { return &_canvas; }
+
+  /**
+   * Show the digits the canvas changed
+   * Each changed digit gets its cell loaded into the CGRAM slot of the same
+   * number and then displays that slot
+   */
+  void present() override;
+
   /**
    * Set display rotation
    * @param flipped true = 180 degree rotation
@@ -103,12 +122,39 @@ public:
    */
   bool isRotated() const override { return _rotated; }
 
+  /**
+   * Forget the shadow copy so the next frame rewrites every digit
+   */
+  void invalidate() override;
+
 private:
   uint8_t _brightness;
   uint8_t _cursorPos;
   bool _initialized;
   bool _rotated;
 
+  // Shadow copy of the digit RAM, used to push only changed digits
+  char _shadow[VFD_NUM_DIGITS];
+  bool _shadowValid[VFD_NUM_DIGITS];
+
+  // Canvas storage must be declared ahead of the canvas that clears it
+  uint32_t _canvasWords[VFD_CELL_HEIGHT * CANVAS_STRIDE(VFD_CANVAS_WIDTH)];
+  Canvas _canvas;
+
+  /**
+   * Write a full line, sending only digits that differ from the shadow
+   * @param frame VFD_NUM_DIGITS characters (not null-terminated)
+   */
+  void pushFrame(const char *frame);
+
+  /**
+   * Burst-write consecutive digits in a single CS-low transaction
+   * @param start First digit address (0-7)
+   * @param data Characters to write
+   * @param len Number of digits
+   */
+  void writeDcram(uint8_t start, const char *data, uint8_t len);
+
   /**
    * Send a command to the VFD controller
    * @param cmd Command byte
@@ -136,6 +182,13 @@ private:
    * @param data Byte to transfer
    */
   void transferByte(uint8_t data);
+
+  /**
+   * Transfer a buffer via SPI in one FIFO burst
+   * @param data Bytes to transfer (bit-reversed in place with VFD_SPI_SOFT_LSB)
+   * @param len Number of bytes
+   */
+  void transferBytes(uint8_t *data, uint8_t len);
 };
 
 #endif // VFD_DRIVER_H
@@ -7,6 +7,7 @@
 #include "weather_manager.h"
 #include "config.h"
 #include "config_manager.h"
+#include "loop_profiler.h"
 
 #include <ESP8266WiFi.h>
 #include <ArduinoJson.h>
@@ -21,7 +22,13 @@ WeatherManager::WeatherManager()
       _lastUpdate(0),
       _valid(false),
       _fetchState(FETCH_IDLE),
-      _fetchStartTime(0) {
+      _fetchStartTime(0),
+      _lastAttempt(0),
+      _attempted(false),
+      _radio(nullptr),
+      _fetchRequested(false),
+      _requestedAt(0),
+      _requestDeadline(0) {
     strcpy(_conditionShort, "---");
 }
 
@@ -34,15 +41,54 @@ void WeatherManager::begin() {
 void WeatherManager::update() {
     // Process fetch state machine
     if (_fetchState != FETCH_IDLE) {
+        PROFILE_SCOPE(PROFILE_STAGE_WEATHER);
         processFetchState();
     }
     
     // Start periodic updates (only if not already fetching)
     if (_fetchState == FETCH_IDLE) {
-        if (millis() - _lastUpdate >= configManager.getWeatherUpdateInterval()) {
+        unsigned long due = nextFetchDue();
+        if (_radio) {
+            unsigned long interval = configManager.getWeatherUpdateInterval();
+            unsigned long earliest = due - interval / RADIO_EARLY_DIVISOR;
+            if (_fetchRequested && (long)(_requestDeadline - due) < 0) {
+                earliest = _requestedAt;
+                due = _requestDeadline;
+            }
+            _radio->request(RADIO_JOB_WEATHER, earliest, due);
+            if (_radio->mayStart(RADIO_JOB_WEATHER, millis())) {
+                _fetchRequested = false;
+                startFetch();
+            }
+        } else if ((long)(millis() - due) >= 0) {
             startFetch();
         }
     }
+    
+    if (_radio) {
+        _radio->setBusy(RADIO_JOB_WEATHER, _fetchState != FETCH_IDLE);
+    }
+}
+
+unsigned long WeatherManager::nextFetchDue() const {
+    unsigned long due = _lastUpdate + configManager.getWeatherUpdateInterval();
+    
+    // A failing server or network shouldn't be retried every pass
+    if (_attempted && (long)(_lastAttempt + WEATHER_RETRY_INTERVAL - due) > 0) {
+        due = _lastAttempt + WEATHER_RETRY_INTERVAL;
+    }
+    return due;
+}
+
+void WeatherManager::requestFetch(unsigned long slackMs) {
+    if (!_radio || !_radio->isEnabled()) {
+        startFetch();
+        return;
+    }
+    
+    _fetchRequested = true;
+    _requestedAt = millis();
+    _requestDeadline = _requestedAt + slackMs;
 }
 
 void WeatherManager::startFetch() {
@@ -58,6 +104,8 @@ void WeatherManager::startFetch() {
     Serial.println("Weather: Starting non-blocking fetch...");
     _fetchState = FETCH_CONNECTING;
     _fetchStartTime = millis();
+    _lastAttempt = _fetchStartTime;
+    _attempted = true;
     _responseBuffer = "";
 }
 
@@ -11,6 +11,7 @@
 #include <Arduino.h>
 #include <WiFiClient.h>
 #include "weather_parser.h"
+#include "radio_duty.h"
 
 // Fetch states for non-blocking operation
 enum WeatherFetchState {
@@ -45,6 +46,17 @@ public:
      */
     void startFetch();
     
+    /**
+     * Fetch soon: right away, or in the next radio window within slackMs
+     */
+    void requestFetch(unsigned long slackMs);
+    
+    /**
+     * Run fetches through the radio duty cycle instead of on their own schedule
+     * @param radio Coordinator, or nullptr to fetch independently
+     */
+    void setRadio(RadioDutyCycle* radio) { _radio = radio; }
+    
     /**
      * Check if a fetch is in progress
      */
@@ -101,12 +113,25 @@ private:
     String _responseBuffer;
     unsigned long _fetchStartTime;
     static const unsigned long FETCH_TIMEOUT = 10000;  // 10 seconds
+    unsigned long _lastAttempt;
+    bool _attempted;
+    
+    // Radio coordination (pre-display fetch requested through requestFetch())
+    RadioDutyCycle* _radio;
+    bool _fetchRequested;
+    unsigned long _requestedAt;
+    unsigned long _requestDeadline;
     
     /**
      * Process the state machine for non-blocking fetch
      */
     void processFetchState();
     
+    /**
+     * Time the next periodic fetch is due (retries wait WEATHER_RETRY_INTERVAL)
+     */
+    unsigned long nextFetchDue() const;
+    
     /**
      * Build the API request string
      */
@@ -6,21 +6,28 @@
 
 #include "web_server.h"
 #include "config_manager.h"
+#include "loop_profiler.h"
+#include "timezone.h"
 
 #include <ArduinoJson.h>
 
 // Global instance
 WebPortal webPortal;
 
-WebPortal::WebPortal() : _server(80) {}
+WebPortal::WebPortal() : _server(80), _display(nullptr), _timeManager(nullptr),
+                         _radio(nullptr), _lastRequestMillis(0) {}
 
 void WebPortal::begin() {
     // Setup routes
-    _server.on("/", HTTP_GET, [this]() { handleRoot(); });
-    _server.on("/api/config", HTTP_GET, [this]() { handleGetConfig(); });
-    _server.on("/api/config", HTTP_POST, [this]() { handlePostConfig(); });
-    _server.on("/api/restart", HTTP_POST, [this]() { handleRestart(); });
-    _server.onNotFound([this]() { handleNotFound(); });
+    _server.on("/", HTTP_GET, [this]() { noteRequest(); handleRoot(); });
+    _server.on("/api/config", HTTP_GET, [this]() { noteRequest(); handleGetConfig(); });
+    _server.on("/api/config", HTTP_POST, [this]() { noteRequest(); handlePostConfig(); });
+    _server.on("/api/restart", HTTP_POST, [this]() { noteRequest(); handleRestart(); });
+    _server.on("/api/metrics/loop", HTTP_GET, [this]() { noteRequest(); handleLoopMetrics(); });
+    _server.on("/api/time", HTTP_GET, [this]() { noteRequest(); handleGetTime(); });
+    _server.on("/api/time/stats", HTTP_GET, [this]() { noteRequest(); handleTimeStats(); });
+    _server.on("/api/metrics/radio", HTTP_GET, [this]() { noteRequest(); handleRadioMetrics(); });
+    _server.onNotFound([this]() { noteRequest(); handleNotFound(); });
     
     _server.begin();
     Serial.println("WebPortal: Server started on port 80");
@@ -30,6 +37,10 @@ void WebPortal::handleClient() {
     _server.handleClient();
 }
 
+void WebPortal::noteRequest() {
+    _lastRequestMillis = millis();
+}
+
 void WebPortal::handleRoot() {
     _server.send(200, "text/html", generateHtml());
 }
@@ -42,7 +53,8 @@ void WebPortal::handleGetConfig() {
     doc["wifiSsid"] = cfg.wifiSsid;
     // Don't send password for security
     doc["ntpServer"] = cfg.ntpServer;
-    doc["timezoneOffset"] = cfg.timezoneOffset;
+    doc["timezone"] = cfg.timezone;
+    doc["ntpServe"] = cfg.ntpServe;
     doc["brightness"] = cfg.brightness;
     doc["showSeconds"] = cfg.showSeconds;
     doc["showActivityIndicators"] = cfg.showActivityIndicators;
@@ -55,8 +67,20 @@ void WebPortal::handleGetConfig() {
     doc["weatherDurationMin"] = cfg.weatherDurationMin;
     doc["weatherDurationMax"] = cfg.weatherDurationMax;
     doc["clockSource"] = cfg.clockSource;
+    doc["clockDriftPpb"] = cfg.clockDriftPpb;  // Read-only, learned from NTP
+    
+    // Read-only DS3231 calibration record
+    JsonObject rtcCal = doc["rtcCalibration"].to<JsonObject>();
+    rtcCal["time"] = cfg.rtcCalTime;
+    rtcCal["agingBefore"] = cfg.rtcAgingBefore;
+    rtcCal["agingAfter"] = cfg.rtcAgingAfter;
+    rtcCal["driftBeforePpb"] = cfg.rtcDriftBeforePpb;
+    if (cfg.rtcCalVerified) {
+        rtcCal["driftAfterPpb"] = cfg.rtcDriftAfterPpb;
+    }
     doc["tiltSensorPin"] = cfg.tiltSensorPin;
     doc["autoRotate"] = cfg.autoRotate;
+    doc["radioSleep"] = cfg.radioSleep;
     
     String response;
     serializeJson(doc, response);
@@ -93,8 +117,16 @@ void WebPortal::handlePostConfig() {
     if (doc["ntpServer"].is<const char*>()) {
         strlcpy(cfg.ntpServer, doc["ntpServer"].as<const char*>(), sizeof(cfg.ntpServer));
     }
-    if (doc["timezoneOffset"].is<long>()) {
-        cfg.timezoneOffset = doc["timezoneOffset"].as<long>();
+    if (doc["timezone"].is<const char*>()) {
+        TimeZone tz;
+        if (!tz.parse(doc["timezone"].as<const char*>())) {
+            _server.send(400, "application/json", "{\"error\":\"Invalid timezone\"}");
+            return;
+        }
+        strlcpy(cfg.timezone, doc["timezone"].as<const char*>(), sizeof(cfg.timezone));
+    }
+    if (doc["ntpServe"].is<bool>()) {
+        cfg.ntpServe = doc["ntpServe"].as<bool>();
     }
     if (doc["brightness"].is<int>()) {
         cfg.brightness = doc["brightness"].as<uint8_t>();
@@ -138,6 +170,9 @@ void WebPortal::handlePostConfig() {
     if (doc["autoRotate"].is<bool>()) {
         cfg.autoRotate = doc["autoRotate"].as<bool>();
     }
+    if (doc["radioSleep"].is<bool>()) {
+        cfg.radioSleep = doc["radioSleep"].as<bool>();
+    }
     
     // Save to flash
     if (configManager.save()) {
@@ -153,6 +188,160 @@ void WebPortal::handleRestart() {
     ESP.restart();
 }
 
+void WebPortal::handleLoopMetrics() {
+    JsonDocument doc;
+    
+    doc["loopsPerSecond"] = loopProfiler.getLoopsPerSecond();
+    doc["cpuMHz"] = loopProfiler.getCpuMHz();
+    
+    JsonObject stages = doc["stages"].to<JsonObject>();
+    for (uint8_t i = 0; i < PROFILE_STAGE_COUNT; i++) {
+        const StageStats& s = loopProfiler.getStats(i);
+        JsonObject stage = stages[LoopProfiler::stageName(i)].to<JsonObject>();
+        stage["count"] = s.count;
+        if (s.count == 0) continue;
+        
+        // All durations in microseconds
+        stage["min"] = loopProfiler.cyclesToMicros(s.minCycles);
+        stage["max"] = loopProfiler.cyclesToMicros(s.maxCycles);
+        stage["avg"] = loopProfiler.cyclesToMicros(s.totalCycles / s.count);
+        stage["p50"] = loopProfiler.cyclesToMicros(loopProfiler.percentileCycles(i, 50));
+        stage["p90"] = loopProfiler.cyclesToMicros(loopProfiler.percentileCycles(i, 90));
+        stage["p99"] = loopProfiler.cyclesToMicros(loopProfiler.percentileCycles(i, 99));
+    }
+    
+    if (_display) {
+        const DisplayStats& ds = _display->getStats();
+        JsonObject display = doc["display"].to<JsonObject>();
+        display["frames"] = ds.frames;
+        display["framesPushed"] = ds.framesPushed;
+        display["bytesSent"] = ds.bytesSent;
+        display["transactions"] = ds.transactions;
+        display["busUs"] = ds.busMicros;
+        if (ds.busMicros > 0) {
+            display["bytesPerUs"] = (float)ds.bytesSent / ds.busMicros;
+        }
+        if (ds.frames > 0) {
+            display["bytesPerFrame"] = (float)ds.bytesSent / ds.frames;
+            display["transactionsPerFrame"] = (float)ds.transactions / ds.frames;
+        }
+    }
+    
+    String response;
+    serializeJson(doc, response);
+    
+    _server.send(200, "application/json", response);
+}
+
+void WebPortal::handleGetTime() {
+    if (!_timeManager) {
+        _server.send(503, "application/json", "{\"error\":\"Time not available\"}");
+        return;
+    }
+    
+    // Same snapshot the display rendered this pass
+    const TimeSnapshot& now = _timeManager->snapshot();
+    char local[24];
+    snprintf(local, sizeof(local), "%04ld-%02u-%02uT%02u:%02u:%02u",
+             (long)now.year, now.month, now.day, now.hours, now.minutes, now.seconds);
+    
+    JsonDocument doc;
+    doc["valid"] = now.valid;
+    doc["utcMs"] = now.utcMillis;
+    doc["local"] = local;
+    doc["millis"] = now.millis;
+    doc["dayOfWeek"] = now.dayOfWeek;
+    doc["utcOffset"] = now.utcOffset;
+    doc["dst"] = now.dst;
+    doc["zone"] = now.zone;
+    
+    String response;
+    serializeJson(doc, response);
+    
+    _server.send(200, "application/json", response);
+}
+
+void WebPortal::handleTimeStats() {
+    if (!_timeManager) {
+        _server.send(503, "application/json", "{\"error\":\"Time not available\"}");
+        return;
+    }
+    
+    const NtpStats& stats = _timeManager->getStats();
+    JsonDocument doc;
+    doc["total"] = stats.getTotal();
+    doc["availability"] = stats.availabilityPercent();
+    doc["jitterMs"] = stats.jitterMs();
+    doc["meanDelayMs"] = stats.meanDelayMs();
+    doc["maxDelayMs"] = stats.maxDelayMs();
+    doc["pollExponent"] = _timeManager->getPollExponent();
+    doc["frequencyPpb"] = _timeManager->getFrequencyPpb();
+    
+    JsonObject outcomes = doc["outcomes"].to<JsonObject>();
+    for (uint8_t i = 0; i < NTP_SYNC_OUTCOME_COUNT; i++) {
+        outcomes[NtpStats::outcomeName(i)] = stats.getOutcomeCount(i);
+    }
+    
+    // One array per sync, newest first, in the order given by "fields"
+    JsonArray fields = doc["fields"].to<JsonArray>();
+    fields.add("utc");
+    fields.add("offsetMs");
+    fields.add("delayMs");
+    fields.add("server");
+    fields.add("outcome");
+    fields.add("correction");
+    fields.add("replies");
+    fields.add("poll");
+    
+    JsonArray syncs = doc["syncs"].to<JsonArray>();
+    for (uint8_t i = 0; i < stats.count(); i++) {
+        const NtpSyncRecord& r = stats.get(i);
+        char server[16];
+        snprintf(server, sizeof(server), "%u.%u.%u.%u", r.server[0], r.server[1], r.server[2], r.server[3]);
+        
+        JsonArray sync = syncs.add<JsonArray>();
+        sync.add(r.utc);
+        sync.add(r.offsetMs);
+        sync.add(r.delayMs);
+        sync.add(server);
+        sync.add(NtpStats::outcomeName(r.outcome));
+        sync.add(NtpStats::correctionName(r.correction));
+        sync.add(r.replies);
+        sync.add(r.pollExponent);
+    }
+    
+    String response;
+    serializeJson(doc, response);
+    
+    _server.send(200, "application/json", response);
+}
+
+void WebPortal::handleRadioMetrics() {
+    if (!_radio) {
+        _server.send(503, "application/json", "{\"error\":\"Radio not available\"}");
+        return;
+    }
+    
+    JsonDocument doc;
+    doc["enabled"] = _radio->isEnabled();
+    doc["awake"] = _radio->isAwake();
+    doc["hourElapsedMs"] = _radio->getHourElapsedMs(millis());
+    
+    // hours[0] is the current partial hour, then completed hours newest first
+    JsonArray hours = doc["hours"].to<JsonArray>();
+    for (uint8_t i = 0; i <= _radio->getHoursRecorded(); i++) {
+        const RadioHourStats& h = _radio->getHour(i);
+        JsonObject hour = hours.add<JsonObject>();
+        hour["awakeMs"] = h.awakeMs;
+        hour["windows"] = h.windows;
+    }
+    
+    String response;
+    serializeJson(doc, response);
+    
+    _server.send(200, "application/json", response);
+}
+
 void WebPortal::handleNotFound() {
     _server.send(404, "text/plain", "Not Found");
 }
@@ -364,10 +553,31 @@ String WebPortal::generateHtml() {
     html += R"rawliteral(">
             </div>
             <div class="field">
-                <label>UTC Offset (seconds)</label>
-                <input type="number" id="timezoneOffset" value=")rawliteral";
-    html += String(cfg.timezoneOffset);
+                <label>Timezone (POSIX TZ string)</label>
+                <input type="text" id="timezone" list="timezonePresets" value=")rawliteral";
+    html += cfg.timezone;
     html += R"rawliteral(">
+                <datalist id="timezonePresets">
+                    <option value="PST8PDT,M3.2.0,M11.1.0">US Pacific</option>
+                    <option value="MST7MDT,M3.2.0,M11.1.0">US Mountain</option>
+                    <option value="CST6CDT,M3.2.0,M11.1.0">US Central</option>
+                    <option value="EST5EDT,M3.2.0,M11.1.0">US Eastern</option>
+                    <option value="GMT0BST,M3.5.0/1,M10.5.0">UK</option>
+                    <option value="CET-1CEST,M3.5.0,M10.5.0/3">Central Europe</option>
+                    <option value="IST-5:30">India</option>
+                    <option value="CST-8">China</option>
+                    <option value="JST-9">Japan</option>
+                    <option value="AEST-10AEDT,M10.1.0,M4.1.0/3">Australia Eastern</option>
+                    <option value="UTC0">UTC</option>
+                </datalist>
+            </div>
+            <div class="field">
+                <label class="toggle-label">
+                    <input type="checkbox" id="ntpServe")rawliteral";
+    if (cfg.ntpServe) html += " checked";
+    html += R"rawliteral(>
+                    <span class="toggle-text">Serve time to the local network (NTP, after restart)</span>
+                </label>
             </div>
         </div>
         
@@ -477,6 +687,9 @@ String WebPortal::generateHtml() {
                     <option value="1")rawliteral";
     if (cfg.clockSource == 1) html += " selected";
     html += R"rawliteral(>DS3231 RTC</option>
+                    <option value="2")rawliteral";
+    if (cfg.clockSource == 2) html += " selected";
+    html += R"rawliteral(>Hybrid (Software + DS3231 Holdover)</option>
                 </select>
             </div>
             <div class="field">
@@ -493,6 +706,14 @@ String WebPortal::generateHtml() {
                     <span class="toggle-text">Auto-rotate display based on tilt sensor</span>
                 </label>
             </div>
+            <div class="field">
+                <label class="toggle-label">
+                    <input type="checkbox" id="radioSleep")rawliteral";
+    if (cfg.radioSleep) html += " checked";
+    html += R"rawliteral(>
+                    <span class="toggle-text">Sleep Wi-Fi between syncs (saves power, not while serving NTP, after restart)</span>
+                </label>
+            </div>
         </div>
         
         <div class="buttons">
@@ -521,7 +742,8 @@ String WebPortal::generateHtml() {
                 wifiSsid: document.getElementById('wifiSsid').value,
                 wifiPassword: document.getElementById('wifiPassword').value,
                 ntpServer: document.getElementById('ntpServer').value,
-                timezoneOffset: parseInt(document.getElementById('timezoneOffset').value),
+                timezone: document.getElementById('timezone').value.trim(),
+                ntpServe: document.getElementById('ntpServe').checked,
                 brightness: parseInt(document.getElementById('brightness').value),
                 showSeconds: document.getElementById('showSeconds').checked,
                 showActivityIndicators: document.getElementById('showActivityIndicators').checked,
@@ -535,7 +757,8 @@ String WebPortal::generateHtml() {
                 weatherDurationMax: parseInt(document.getElementById('weatherDurationMax').value),
                 clockSource: parseInt(document.getElementById('clockSource').value),
                 tiltSensorPin: parseInt(document.getElementById('tiltSensorPin').value),
-                autoRotate: document.getElementById('autoRotate').checked
+                autoRotate: document.getElementById('autoRotate').checked,
+                radioSleep: document.getElementById('radioSleep').checked
             };
             
             try {
@@ -547,7 +770,8 @@ String WebPortal::generateHtml() {
                 if (res.ok) {
                     showStatus('Settings saved!', false);
                 } else {
-                    showStatus('Save failed', true);
+                    const err = await res.json().catch(() => ({}));
+                    showStatus(err.error || 'Save failed', true);
                 }
             } catch(e) {
                 showStatus('Connection error', true);
@@ -591,6 +815,66 @@ String WebPortal::generateHtml() {
             }
         }
         
+        // UTC offset of an IANA zone at a given time, in minutes east
+        function tzOffsetMin(zone, date) {
+            const name = new Intl.DateTimeFormat('en-US', {timeZone: zone, timeZoneName: 'longOffset'})
+                .formatToParts(date).find(p => p.type === 'timeZoneName').value;
+            const m = name.match(/GMT([+-])(\d{2}):?(\d{2})?/);
+            return m ? (m[1] === '-' ? -1 : 1) * (parseInt(m[2]) * 60 + parseInt(m[3] || '0')) : 0;
+        }
+        
+        // POSIX offsets count west of Greenwich
+        function posixOffset(min) {
+            const a = Math.abs(min);
+            return (min > 0 ? '-' : '') + Math.floor(a / 60) + (a % 60 ? ':' + String(a % 60).padStart(2, '0') : '');
+        }
+        
+        function posixName(min) {
+            const a = Math.abs(min);
+            return '<' + (min < 0 ? '-' : '+') + String(Math.floor(a / 60)).padStart(2, '0') +
+                (a % 60 ? String(a % 60).padStart(2, '0') : '') + '>';
+        }
+        
+        // Mm.w.d[/time] for a transition at UTC ms, in the local time it replaces
+        function posixRule(at, fromMin) {
+            const t = new Date(at + fromMin * 60000);
+            const day = t.getUTCDate();
+            const last = new Date(Date.UTC(t.getUTCFullYear(), t.getUTCMonth() + 1, 0)).getUTCDate();
+            const week = day + 7 > last ? 5 : Math.ceil(day / 7);
+            const mins = t.getUTCHours() * 60 + t.getUTCMinutes();
+            return 'M' + (t.getUTCMonth() + 1) + '.' + week + '.' + t.getUTCDay() +
+                (mins === 120 ? '' : '/' + posixOffset(-mins));
+        }
+        
+        // Build a POSIX TZ string from this year's transitions of an IANA zone
+        function posixFromIana(zone) {
+            const year = new Date().getUTCFullYear();
+            let t = Date.UTC(year, 0, 1);
+            let prev = tzOffsetMin(zone, new Date(t));
+            const changes = [];
+            for (let d = 0; d < 366 && changes.length < 2; d++) {
+                const next = t + 86400000;
+                const off = tzOffsetMin(zone, new Date(next));
+                if (off !== prev) {
+                    let lo = t, hi = next;
+                    while (hi - lo > 60000) {
+                        const mid = lo + Math.floor((hi - lo) / 120000) * 60000;
+                        if (tzOffsetMin(zone, new Date(mid)) === prev) lo = mid; else hi = mid;
+                    }
+                    changes.push({at: hi, from: prev, to: off});
+                    prev = off;
+                }
+                t = next;
+            }
+            if (changes.length < 2) return posixName(prev) + posixOffset(prev);
+            
+            const dst = changes[0].to > changes[0].from ? changes[0] : changes[1];
+            const std = dst === changes[0] ? changes[1] : changes[0];
+            let tz = posixName(std.to) + posixOffset(std.to) + posixName(dst.to);
+            if (dst.to - std.to !== 60) tz += posixOffset(dst.to);
+            return tz + ',' + posixRule(dst.at, dst.from) + ',' + posixRule(std.at, std.from);
+        }
+        
         async function selectLocation(lat, lon, name) {
             document.getElementById('weatherLat').value = lat.toFixed(4);
             document.getElementById('weatherLon').value = lon.toFixed(4);
@@ -604,10 +888,17 @@ String WebPortal::generateHtml() {
                 const res = await fetch(`https://api.open-meteo.com/v1/forecast?latitude=${lat}&longitude=${lon}&current=weather_code&timezone=auto`);
                 const data = await res.json();
                 
-                if (data.utc_offset_seconds !== undefined) {
-                    const offset = data.utc_offset_seconds;
-                    document.getElementById('timezoneOffset').value = offset;
-                    showStatus(`Location set. Timezone updated to UTC${offset >= 0 ? '+' : ''}${offset/3600}h`, false);
+                let tz = null;
+                try {
+                    if (data.timezone) tz = posixFromIana(data.timezone);
+                } catch(e) {}
+                if (!tz && data.utc_offset_seconds !== undefined) {
+                    tz = posixName(data.utc_offset_seconds / 60) + posixOffset(data.utc_offset_seconds / 60);
+                }
+                
+                if (tz) {
+                    document.getElementById('timezone').value = tz;
+                    showStatus(`Location set. Timezone updated to ${tz}`, false);
                 } else {
                     showStatus('Location set. Could not detect timezone.', true);
                 }
@@ -9,6 +9,9 @@
 
 #include <Arduino.h>
 #include <ESP8266WebServer.h>
+#include "display_driver.h"
+#include "time_manager.h"
+#include "radio_duty.h"
 
 class WebPortal {
 public:
@@ -24,6 +27,27 @@ public:
      */
     void handleClient();
     
+    /**
+     * Set the display whose counters are reported in the metrics API
+     * @param display Pointer to the active DisplayDriver
+     */
+    void setDisplay(const DisplayDriver* display) { _display = display; }
+    
+    /**
+     * Set the time manager whose snapshot the time API reports
+     */
+    void setTimeManager(const TimeManager* timeManager) { _timeManager = timeManager; }
+    
+    /**
+     * Set the radio duty cycle reported in the radio metrics API
+     */
+    void setRadio(const RadioDutyCycle* radio) { _radio = radio; }
+    
+    /**
+     * millis() of the last handled request (keeps the radio awake for follow-ups)
+     */
+    unsigned long getLastRequestMillis() const { return _lastRequestMillis; }
+    
     /**
      * Get server port
      */
@@ -31,12 +55,21 @@ public:
 
 private:
     ESP8266WebServer _server;
+    const DisplayDriver* _display;
+    const TimeManager* _timeManager;
+    const RadioDutyCycle* _radio;
+    unsigned long _lastRequestMillis;
     
-    // Request handlers
+    // Request handlers (each route records the request time first)
+    void noteRequest();
     void handleRoot();
     void handleGetConfig();
     void handlePostConfig();
     void handleRestart();
+    void handleLoopMetrics();
+    void handleGetTime();
+    void handleTimeStats();
+    void handleRadioMetrics();
     void handleNotFound();
     
     // HTML page generator
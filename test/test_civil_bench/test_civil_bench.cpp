@@ -0,0 +1,62 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <time.h>
+#include "civil_time.h"
+
+// One call per second of clock time, starting a minute before midnight
+#define BENCH_ITERATIONS 2000
+#define BENCH_START 1709251140UL  // 2024-02-29 23:59:00
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+static void report(const char* name, uint32_t cycles) {
+    Serial.printf("%-14s %6lu cycles/call  %.3f us/call\n",
+                  name,
+                  (unsigned long)(cycles / BENCH_ITERATIONS),
+                  (float)cycles / BENCH_ITERATIONS / ESP.getCpuFreqMHz());
+}
+
+void test_bench_date(void) {
+    volatile uint32_t sink = 0;  // Keep the calls from being optimized out
+
+    uint32_t start = ESP.getCycleCount();
+    for (uint32_t i = 0; i < BENCH_ITERATIONS; i++) {
+        time_t t = BENCH_START + i;
+        struct tm tm;
+        gmtime_r(&t, &tm);
+        sink += tm.tm_mday;
+    }
+    uint32_t gmtimeCycles = ESP.getCycleCount() - start;
+    report("gmtime_r", gmtimeCycles);
+
+    start = ESP.getCycleCount();
+    for (uint32_t i = 0; i < BENCH_ITERATIONS; i++) {
+        sink += civilFromDays((int32_t)((BENCH_START + i) / SECONDS_PER_DAY)).day;
+    }
+    uint32_t civilCycles = ESP.getCycleCount() - start;
+    report("civilFromDays", civilCycles);
+
+    CivilDateMemo memo;
+    start = ESP.getCycleCount();
+    for (uint32_t i = 0; i < BENCH_ITERATIONS; i++) {
+        sink += memo.get(BENCH_START + i).day;
+    }
+    uint32_t memoCycles = ESP.getCycleCount() - start;
+    report("memo", memoCycles);
+
+    TEST_ASSERT_TRUE(civilCycles < gmtimeCycles);
+    TEST_ASSERT_TRUE(memoCycles < civilCycles);
+}
+
+void setup() {
+    delay(2000);
+    UNITY_BEGIN();
+    RUN_TEST(test_bench_date);
+    UNITY_END();
+}
+
+void loop() {}
@@ -0,0 +1,160 @@
+#include <unity.h>
+#include <string.h>
+#include "canvas.h"
+#include "max7219_font.h"
+
+// Wider than one word so blits can straddle a word boundary
+#define WIDTH 40
+#define HEIGHT 8
+
+static uint32_t words[HEIGHT * CANVAS_STRIDE(WIDTH)];
+static Canvas* canvas;
+
+// 3x3 ring, one byte per row
+static const uint8_t RING_BITS[] PROGMEM = { 0xE0, 0xA0, 0xE0 };
+static const Sprite RING = { RING_BITS, 3, 3 };
+
+static uint16_t countPixels(void) {
+    uint16_t count = 0;
+    for (int16_t y = 0; y < HEIGHT; y++) {
+        for (int16_t x = 0; x < WIDTH; x++) {
+            count += canvas->getPixel(x, y);
+        }
+    }
+    return count;
+}
+
+void setUp(void) {
+    memset(words, 0xA5, sizeof(words));  // The constructor must clear it
+    canvas = new Canvas(words, WIDTH, HEIGHT);
+}
+
+void tearDown(void) {
+    delete canvas;
+}
+
+void test_blit_ops(void) {
+    TEST_ASSERT_EQUAL_UINT16(0, countPixels());
+
+    // Run across the word boundary at column 32
+    canvas->blitRow(28, 2, 0xFF000000UL, 8, BLIT_OR);
+    TEST_ASSERT_FALSE(canvas->getPixel(27, 2));
+    TEST_ASSERT_TRUE(canvas->getPixel(28, 2));
+    TEST_ASSERT_TRUE(canvas->getPixel(35, 2));
+    TEST_ASSERT_FALSE(canvas->getPixel(36, 2));
+    TEST_ASSERT_EQUAL_HEX8(0xFF, canvas->readByte(28, 2));
+    TEST_ASSERT_EQUAL_HEX8(0x0F, canvas->readByte(24, 2));
+
+    // XOR inverts, COPY replaces blanks too, OR never clears
+    canvas->blitRow(30, 2, 0xF0000000UL, 4, BLIT_XOR);
+    TEST_ASSERT_EQUAL_HEX8(0xC3, canvas->readByte(28, 2));
+    canvas->blitRow(28, 2, 0x50000000UL, 4, BLIT_COPY);
+    TEST_ASSERT_EQUAL_HEX8(0x53, canvas->readByte(28, 2));
+    canvas->blitRow(28, 2, 0x00000000UL, 8, BLIT_OR);
+    TEST_ASSERT_EQUAL_HEX8(0x53, canvas->readByte(28, 2));
+
+    // Off the edges: nothing outside the canvas is touched or read
+    canvas->blitRow(-4, 0, 0xFF000000UL, 8, BLIT_OR);
+    TEST_ASSERT_EQUAL_HEX8(0xF0, canvas->readByte(0, 0));
+    TEST_ASSERT_EQUAL_HEX8(0x0F, canvas->readByte(-4, 0));
+    canvas->blitRow(36, 0, 0xFF000000UL, 8, BLIT_OR);
+    TEST_ASSERT_EQUAL_HEX8(0xF0, canvas->readByte(36, 0));
+    canvas->blitRow(0, HEIGHT, 0xFF000000UL, 8, BLIT_OR);
+    TEST_ASSERT_EQUAL_UINT16(4 + 4 + 4, countPixels());
+}
+
+void test_clip(void) {
+    canvas->setClip(4, 2, 8, 3);
+    canvas->fillRect(0, 0, WIDTH, HEIGHT);
+    TEST_ASSERT_EQUAL_UINT16(8 * 3, countPixels());
+    TEST_ASSERT_TRUE(canvas->getPixel(4, 2));
+    TEST_ASSERT_TRUE(canvas->getPixel(11, 4));
+    TEST_ASSERT_FALSE(canvas->getPixel(3, 2));
+    TEST_ASSERT_FALSE(canvas->getPixel(12, 2));
+    TEST_ASSERT_FALSE(canvas->getPixel(4, 5));
+
+    // The clip is trimmed to the canvas; clear() blanks only the clip
+    canvas->setClip(-10, -10, 100, 100);
+    TEST_ASSERT_EQUAL_INT16(0, canvas->getClip().x);
+    TEST_ASSERT_EQUAL_INT16(WIDTH, canvas->getClip().width);
+    TEST_ASSERT_EQUAL_INT16(HEIGHT, canvas->getClip().height);
+    canvas->setClip(4, 2, 4, 3);
+    canvas->clear();
+    TEST_ASSERT_EQUAL_UINT16(4 * 3, countPixels());
+}
+
+void test_sprite_and_bitmap(void) {
+    canvas->drawSprite(RING, 31, 1);
+    TEST_ASSERT_TRUE(canvas->getPixel(31, 1));
+    TEST_ASSERT_TRUE(canvas->getPixel(33, 1));
+    TEST_ASSERT_FALSE(canvas->getPixel(32, 2));
+    TEST_ASSERT_EQUAL_UINT16(8, countPixels());
+
+    // XOR again erases it, leaving nothing behind
+    canvas->drawSprite(RING, 31, 1, BLIT_XOR);
+    TEST_ASSERT_EQUAL_UINT16(0, countPixels());
+
+    // A 36-pixel bitmap row takes two blits
+    const uint8_t bar[5] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xF0 };
+    canvas->blit(bar, 36, 1, 2, 7, BLIT_COPY);
+    TEST_ASSERT_EQUAL_UINT16(36, countPixels());
+    TEST_ASSERT_FALSE(canvas->getPixel(1, 7));
+    TEST_ASSERT_TRUE(canvas->getPixel(37, 7));
+    TEST_ASSERT_FALSE(canvas->getPixel(38, 7));
+
+    // Partly off the left edge
+    canvas->drawSprite(RING, -2, 0);
+    TEST_ASSERT_TRUE(canvas->getPixel(0, 0));
+    TEST_ASSERT_TRUE(canvas->getPixel(0, 1));
+    TEST_ASSERT_FALSE(canvas->getPixel(1, 0));
+}
+
+void test_text(void) {
+    // Same pixels the driver's font rows give, cell after cell
+    int16_t end = canvas->drawText("12", FONT_5X7, 1, 0);
+    TEST_ASSERT_EQUAL_INT16(1 + 2 * FONT_5X7.advance, end);
+
+    FontGlyph glyph;
+    fontGlyph(FONT_5X7, '2', glyph);
+    for (uint8_t row = 0; row < FONT_5X7.height; row++) {
+        TEST_ASSERT_EQUAL_HEX8(fontRow(FONT_5X7, glyph, row), canvas->readByte(1 + FONT_5X7.advance, row));
+    }
+}
+
+void test_dirty_region(void) {
+    TEST_ASSERT_FALSE(canvas->isDirty());
+
+    canvas->setPixel(5, 3, true);
+    canvas->fillRect(30, 6, 4, 1);
+    TEST_ASSERT_TRUE(canvas->isDirty());
+    TEST_ASSERT_EQUAL_INT16(5, canvas->getDirty().x);
+    TEST_ASSERT_EQUAL_INT16(3, canvas->getDirty().y);
+    TEST_ASSERT_EQUAL_INT16(29, canvas->getDirty().width);
+    TEST_ASSERT_EQUAL_INT16(4, canvas->getDirty().height);
+
+    // Drawing what is already there changes nothing, so nothing needs presenting
+    canvas->clearDirty();
+    canvas->setPixel(5, 3, true);
+    canvas->fillRect(30, 6, 4, 1, BLIT_OR);
+    canvas->clearRect(0, 0, 4, 4);
+    TEST_ASSERT_FALSE(canvas->isDirty());
+
+    // Clipped-away drawing isn't dirty either
+    canvas->setClip(0, 0, 10, 10);
+    canvas->setPixel(20, 0, true);
+    TEST_ASSERT_FALSE(canvas->isDirty());
+
+    canvas->markAllDirty();
+    TEST_ASSERT_EQUAL_INT16(WIDTH, canvas->getDirty().width);
+    TEST_ASSERT_EQUAL_INT16(HEIGHT, canvas->getDirty().height);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_blit_ops);
+    RUN_TEST(test_clip);
+    RUN_TEST(test_sprite_and_bitmap);
+    RUN_TEST(test_text);
+    RUN_TEST(test_dirty_region);
+    return UNITY_END();
+}
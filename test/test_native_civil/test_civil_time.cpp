@@ -0,0 +1,87 @@
+#include <unity.h>
+#include <stdio.h>
+#include <time.h>
+#include "civil_time.h"
+
+// Last whole day representable in an unsigned 32-bit epoch (2106-02-07)
+#define LAST_DAY_U32 (0xFFFFFFFFUL / SECONDS_PER_DAY)
+
+// Evaluated by the compiler
+static_assert(daysFromCivil(1970, 1, 1) == 0, "epoch");
+static_assert(daysFromCivil(2000, 3, 1) == 11017, "leap century");
+static_assert(civilFromDays(19723).year == 2024, "year");
+static_assert(civilFromDays(19723).weekday == 1, "weekday");
+static_assert(daysInMonth(1900, 2) == 28 && daysInMonth(2000, 2) == 29, "leap rules");
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_matches_gmtime(void) {
+    for (uint32_t days = 0; days <= LAST_DAY_U32; days++) {
+        time_t t = (time_t)days * SECONDS_PER_DAY;
+        struct tm tm;
+        gmtime_r(&t, &tm);
+
+        CivilDate date = civilFromDays((int32_t)days);
+        if (date.year != tm.tm_year + 1900 || date.month != tm.tm_mon + 1 ||
+            date.day != tm.tm_mday || date.weekday != tm.tm_wday) {
+            char msg[64];
+            snprintf(msg, sizeof(msg), "day %lu: %ld-%u-%u", (unsigned long)days,
+                     (long)date.year, date.month, date.day);
+            TEST_FAIL_MESSAGE(msg);
+        }
+    }
+}
+
+void test_round_trip(void) {
+    for (int32_t days = -800000; days <= 800000; days++) {
+        CivilDate date = civilFromDays(days);
+        if (daysFromCivil(date.year, date.month, date.day) != days) {
+            TEST_FAIL_MESSAGE("round trip");
+        }
+    }
+}
+
+void test_before_epoch(void) {
+    CivilDate date = civilFromDays(-1);
+    TEST_ASSERT_EQUAL_INT32(1969, date.year);
+    TEST_ASSERT_EQUAL_UINT8(12, date.month);
+    TEST_ASSERT_EQUAL_UINT8(31, date.day);
+    TEST_ASSERT_EQUAL_UINT8(3, date.weekday);  // Wednesday
+
+    date = civilFromDays(-11);
+    TEST_ASSERT_EQUAL_UINT8(21, date.day);
+    TEST_ASSERT_EQUAL_UINT8(0, date.weekday);  // Sunday
+}
+
+void test_memo(void) {
+    CivilDateMemo memo;
+
+    // 2024-02-29 23:59:59 then midnight
+    const CivilDate& date = memo.get(1709251199UL);
+    TEST_ASSERT_EQUAL_INT32(2024, date.year);
+    TEST_ASSERT_EQUAL_UINT8(2, date.month);
+    TEST_ASSERT_EQUAL_UINT8(29, date.day);
+    TEST_ASSERT_EQUAL_UINT8(4, date.weekday);
+
+    TEST_ASSERT_EQUAL_UINT8(3, memo.get(1709251200UL).month);
+    TEST_ASSERT_EQUAL_UINT8(1, memo.get(1709251200UL).day);
+
+    // The last representable second
+    TEST_ASSERT_EQUAL_INT32(2106, memo.get(0xFFFFFFFFUL).year);
+    TEST_ASSERT_EQUAL_UINT8(7, memo.get(0xFFFFFFFFUL).day);
+
+    TEST_ASSERT_EQUAL_INT32(1970, memo.get(0).year);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_matches_gmtime);
+    RUN_TEST(test_round_trip);
+    RUN_TEST(test_before_epoch);
+    RUN_TEST(test_memo);
+    return UNITY_END();
+}
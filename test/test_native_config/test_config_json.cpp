@@ -37,21 +37,42 @@ void test_deserialize_config(void) {
     doc["deviceName"] = "Imported Device";
     doc["brightness"] = 50;
     doc["showSeconds"] = false;
+    doc["ntpServe"] = true;
+    doc["radioSleep"] = false;
     
     configManager.deserializeConfig(doc);
     
     TEST_ASSERT_EQUAL_STRING("Imported Device", configManager.getDeviceName());
     TEST_ASSERT_EQUAL_UINT8(50, configManager.getBrightness());
     TEST_ASSERT_FALSE(configManager.getShowSeconds());
+    TEST_ASSERT_TRUE(configManager.getNtpServe());
+    TEST_ASSERT_FALSE(configManager.getRadioSleep());
     
     // Check missing fields preserved defaults
     TEST_ASSERT_EQUAL_STRING(WIFI_SSID, configManager.getWifiSsid());
 }
 
+void test_legacy_timezone_offset(void) {
+    JsonDocument doc;
+    doc["timezoneOffset"] = -28800;
+    configManager.deserializeConfig(doc);
+    TEST_ASSERT_EQUAL_STRING("<-08>8", configManager.getTimezone());
+    
+    doc["timezoneOffset"] = 19800;
+    configManager.deserializeConfig(doc);
+    TEST_ASSERT_EQUAL_STRING("<+0530>-5:30", configManager.getTimezone());
+    
+    // A TZ string wins over the legacy field
+    doc["timezone"] = "CET-1CEST,M3.5.0,M10.5.0/3";
+    configManager.deserializeConfig(doc);
+    TEST_ASSERT_EQUAL_STRING("CET-1CEST,M3.5.0,M10.5.0/3", configManager.getTimezone());
+}
+
 int main(int argc, char **argv) {
     UNITY_BEGIN();
     RUN_TEST(test_serialize_config);
     RUN_TEST(test_deserialize_config);
+    RUN_TEST(test_legacy_timezone_offset);
     UNITY_END();
     return 0;
 }
@@ -0,0 +1,268 @@
+#include <unity.h>
+#include "clock_discipline.h"
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_small_offset_is_slewed(void) {
+    ClockDiscipline d;
+    DisciplineResult r = d.sample(40, 0, 0);
+    TEST_ASSERT_FALSE(r.step);
+
+    r = d.sample(-CLOCK_STEP_THRESHOLD_MS, 0, 0);
+    TEST_ASSERT_FALSE(r.step);
+}
+
+void test_large_offset_is_stepped(void) {
+    ClockDiscipline d;
+    DisciplineResult r = d.sample(CLOCK_STEP_THRESHOLD_MS + 1, 0, 0);
+    TEST_ASSERT_TRUE(r.step);
+
+    r = d.sample(-5000, 0, 0);
+    TEST_ASSERT_TRUE(r.step);
+}
+
+void test_frequency_estimated_from_drift(void) {
+    ClockDiscipline d;
+
+    // Clock lost 45 ms over 15 minutes: 50 ppm slow
+    DisciplineResult r = d.sample(45, 0, 900000);
+    TEST_ASSERT_EQUAL_INT32(50000, r.freqErrorPpb);
+    TEST_ASSERT_EQUAL_INT32(50000, r.freqPpb);
+}
+
+void test_pending_slew_is_not_counted_as_drift(void) {
+    ClockDiscipline d;
+
+    // 20 ms of the last correction hasn't been applied yet: only 9 ms is drift
+    DisciplineResult r = d.sample(29, 20, 900000);
+    TEST_ASSERT_EQUAL_INT32(10000, r.freqErrorPpb);
+}
+
+void test_short_interval_does_not_update_frequency(void) {
+    ClockDiscipline d;
+    DisciplineResult r = d.sample(10, 0, CLOCK_FLL_MIN_INTERVAL_MS - 1);
+    TEST_ASSERT_EQUAL_INT32(0, r.freqPpb);
+}
+
+void test_time_error_is_not_a_frequency_error(void) {
+    ClockDiscipline d;
+
+    // 10 s over 15 minutes would be >10000 ppm: ignore for frequency
+    DisciplineResult r = d.sample(10000, 0, 900000);
+    TEST_ASSERT_TRUE(r.step);
+    TEST_ASSERT_EQUAL_INT32(0, r.freqPpb);
+}
+
+void test_converges_and_locks(void) {
+    ClockDiscipline d;
+    const int32_t truePpb = 37000;  // Oscillator runs 37 ppm fast
+    const uint32_t interval = 1800000;
+
+    for (int i = 0; i < 20; i++) {
+        // Offset that builds up with the current correction in place
+        int64_t offsetMs = -(int64_t)(truePpb + d.getFrequencyPpb()) * interval / 1000000000LL;
+        d.sample(offsetMs, 0, interval);
+    }
+
+    TEST_ASSERT_INT32_WITHIN(1000, truePpb, -d.getFrequencyPpb());
+    TEST_ASSERT_TRUE(d.isLocked());
+}
+
+void test_repeated_sample_does_not_count_toward_lock(void) {
+    ClockDiscipline d;
+    d.sample(-60, 0, 1800000);  // 33 ppm fast
+    int32_t freq = d.getFrequencyPpb();
+
+    // The same measurement offered again after it was corrected reads ~0;
+    // with no interval since the correction it must not look like a settled loop
+    for (int i = 0; i < 2 * CLOCK_LOCK_SAMPLES; i++) {
+        DisciplineResult r = d.sample(0, 0, 0);
+        TEST_ASSERT_EQUAL_INT32(freq, r.freqPpb);
+        TEST_ASSERT_EQUAL_INT32(0, r.freqErrorPpb);
+    }
+    TEST_ASSERT_FALSE(d.isLocked());
+}
+
+void test_frequency_is_clamped(void) {
+    ClockDiscipline d;
+    d.setFrequencyPpb(10 * CLOCK_MAX_FREQ_PPB);
+    TEST_ASSERT_EQUAL_INT32(CLOCK_MAX_FREQ_PPB, d.getFrequencyPpb());
+}
+
+void test_poll_grows_after_good_samples(void) {
+    PollController p(6, 14, 10);
+    TEST_ASSERT_EQUAL_UINT8(6, p.getExponent());
+    TEST_ASSERT_EQUAL_UINT32(64000, p.getIntervalMs());
+
+    // 6 per good sample: the 5th reaches the limit
+    for (int i = 0; i < 4; i++) p.update(5, 10, false, true);
+    TEST_ASSERT_EQUAL_UINT8(6, p.getExponent());
+    p.update(5, 10, false, true);
+    TEST_ASSERT_EQUAL_UINT8(7, p.getExponent());
+}
+
+void test_poll_shrinks_on_jitter(void) {
+    PollController p(6, 14, 14);
+    for (int i = 0; i < 10; i++) p.update(0, 0, false, true);
+    TEST_ASSERT_EQUAL_UINT8(8, p.getExponent());
+
+    // 16 per bad sample: the 2nd passes the limit
+    p.update(0, POLL_JITTER_TOLERANCE_MS + 1, false, true);
+    TEST_ASSERT_EQUAL_UINT8(8, p.getExponent());
+    p.update(0, POLL_JITTER_TOLERANCE_MS + 1, false, true);
+    TEST_ASSERT_EQUAL_UINT8(7, p.getExponent());
+}
+
+void test_poll_resets_on_step(void) {
+    PollController p(6, 14, 14);
+    for (int i = 0; i < 10; i++) p.update(0, 0, false, true);
+    TEST_ASSERT_EQUAL_UINT8(8, p.getExponent());
+
+    p.update(0, 0, true, true);
+    TEST_ASSERT_EQUAL_UINT8(6, p.getExponent());
+}
+
+void test_poll_capped_until_locked(void) {
+    PollController p(6, 14, 10);
+    for (int i = 0; i < 200; i++) p.update(0, 0, false, false);
+    TEST_ASSERT_EQUAL_UINT8(10, p.getExponent());
+
+    for (int i = 0; i < 200; i++) p.update(0, 0, false, true);
+    TEST_ASSERT_EQUAL_UINT8(14, p.getExponent());
+
+    // Losing lock pulls the interval back under the unlocked ceiling
+    p.update(0, 0, false, false);
+    TEST_ASSERT_EQUAL_UINT8(10, p.getExponent());
+}
+
+// Syncs an RTC that runs driftPpb fast every intervalMs until the calibrator has
+// a baseline; each write it asks for restarts the RTC second lagMs late
+static void syncRtc(AgingCalibrator& c, int32_t driftPpb, uint32_t intervalMs, int32_t lagMs) {
+    int64_t rtcAheadUs = 250000;  // Unset: the first sync writes it
+    uint32_t interval = 0;
+    for (int i = 0; i < 1000; i++) {
+        int64_t offsetMs = -rtcAheadUs / 1000;
+        bool ready = c.sample(offsetMs, interval);
+        if (c.needsWrite()) {
+            rtcAheadUs = -lagMs * 1000LL;
+        }
+        if (ready) return;
+        interval = intervalMs;
+        rtcAheadUs += (int64_t)driftPpb * intervalMs / 1000000;
+    }
+}
+
+void test_aging_needs_long_baseline(void) {
+    AgingCalibrator c;
+    TEST_ASSERT_FALSE(c.sample(-50, 0));  // First sync only starts the baseline
+    TEST_ASSERT_TRUE(c.needsWrite());
+
+    // RTC 1 ppm fast: 3.6 ms further ahead each hour, left in the RTC
+    for (int i = 1; i < 24; i++) {
+        TEST_ASSERT_FALSE(c.sample(-(int64_t)i * 36 / 10, 3600000));
+        TEST_ASSERT_FALSE(c.needsWrite());
+    }
+    TEST_ASSERT_TRUE(c.sample(-86, 3600000));
+    TEST_ASSERT_EQUAL_UINT32(86400000UL, (uint32_t)c.getBaselineMs());
+    TEST_ASSERT_INT32_WITHIN(10, 995, c.getDriftPpb());
+}
+
+void test_aging_from_drift(void) {
+    AgingCalibrator c;
+    c.sample(0, 0);
+    // 86.4 ms ahead over a day = 1 ppm fast -> 10 LSB slower
+    c.sample(-43, 43200000);
+    c.sample(-86, 43200000);
+    TEST_ASSERT_INT32_WITHIN(10, 995, c.getDriftPpb());
+    TEST_ASSERT_EQUAL_INT8(13, c.agingFor(3));
+
+    // Slow RTC needs a lower (faster) aging offset
+    c.reset();
+    c.sample(0, 0);
+    c.sample(173, 86400000);
+    TEST_ASSERT_EQUAL_INT8(-20, c.agingFor(0));
+}
+
+void test_aging_is_clamped(void) {
+    AgingCalibrator c;
+    c.sample(0, 0);
+    c.sample(-1500, 86400000);  // 17 ppm fast
+    TEST_ASSERT_EQUAL_INT8(127, c.agingFor(100));
+}
+
+void test_aging_ignores_time_errors(void) {
+    AgingCalibrator c;
+    c.sample(0, 0);
+    c.sample(-4, 43200000);
+    TEST_ASSERT_FALSE(c.sample(5000, 3600000));  // RTC reset, not drift
+    TEST_ASSERT_EQUAL_UINT32(0, (uint32_t)c.getBaselineMs());
+    TEST_ASSERT_TRUE(c.needsWrite());  // The new baseline starts from a corrected RTC
+}
+
+// The error is written out once it reaches RTC_CAL_WRITE_MS, without losing the drift in it
+void test_aging_writes_past_threshold(void) {
+    AgingCalibrator c;
+    c.sample(0, 0);
+
+    // 2 ppm slow: 7.2 ms behind per hour reaches 100 ms in the 14th hour
+    int64_t behindMs = 0;
+    int writes = 0;
+    for (int i = 0; i < 24; i++) {
+        behindMs += 72;
+        c.sample(behindMs / 10, 3600000);
+        TEST_ASSERT_EQUAL_INT32(i == 13 ? 7 : (behindMs / 10 - (behindMs - 72) / 10),
+                                (int32_t)c.getChangeMs());
+        if (c.needsWrite()) {
+            writes++;
+            behindMs = 0;
+        }
+    }
+    TEST_ASSERT_EQUAL_INT(1, writes);
+    TEST_ASSERT_INT32_WITHIN(20, -2000, c.getDriftPpb());
+}
+
+// Each write restarts the RTC second a little late; that lag is only
+// counted once per write, not once per sync
+void test_aging_write_lag_is_not_drift(void) {
+    // A write a whole 10 ms loop period late, at the start of the baseline only
+    AgingCalibrator c;
+    syncRtc(c, 0, 1024000, 10);
+    TEST_ASSERT_TRUE(c.getBaselineMs() >= RTC_CAL_BASELINE_MS);
+    TEST_ASSERT_INT32_WITHIN(150, 0, c.getDriftPpb());
+    TEST_ASSERT_EQUAL_INT8(-1, c.agingFor(0));  // Rewritten every poll it would be ~100 LSB
+
+    // Fast enough to be rewritten part way through, writes within 1 ms of the second
+    c.reset();
+    syncRtc(c, 2000, 1024000, 1);
+    TEST_ASSERT_INT32_WITHIN(50, 2000, c.getDriftPpb());
+    TEST_ASSERT_EQUAL_INT8(-20, c.agingFor(-40));
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_small_offset_is_slewed);
+    RUN_TEST(test_large_offset_is_stepped);
+    RUN_TEST(test_frequency_estimated_from_drift);
+    RUN_TEST(test_pending_slew_is_not_counted_as_drift);
+    RUN_TEST(test_short_interval_does_not_update_frequency);
+    RUN_TEST(test_time_error_is_not_a_frequency_error);
+    RUN_TEST(test_converges_and_locks);
+    RUN_TEST(test_repeated_sample_does_not_count_toward_lock);
+    RUN_TEST(test_frequency_is_clamped);
+    RUN_TEST(test_poll_grows_after_good_samples);
+    RUN_TEST(test_poll_shrinks_on_jitter);
+    RUN_TEST(test_poll_resets_on_step);
+    RUN_TEST(test_poll_capped_until_locked);
+    RUN_TEST(test_aging_needs_long_baseline);
+    RUN_TEST(test_aging_from_drift);
+    RUN_TEST(test_aging_is_clamped);
+    RUN_TEST(test_aging_ignores_time_errors);
+    RUN_TEST(test_aging_writes_past_threshold);
+    RUN_TEST(test_aging_write_lag_is_not_drift);
+    UNITY_END();
+    return 0;
+}
@@ -0,0 +1,90 @@
+#include <unity.h>
+#include "font.h"
+#include "max7219_font.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_monospace_lookup(void) {
+    FontGlyph g;
+    TEST_ASSERT_TRUE(fontGlyph(FONT_5X7, 'A', g));
+    TEST_ASSERT_EQUAL_UINT8(5, g.width);
+    TEST_ASSERT_EQUAL_UINT8(6, g.advance);
+    
+    // 'A' from the 5x7 table: .###. #...# #...# #...# ##### #...# #...#
+    TEST_ASSERT_EQUAL_HEX8(0x70, fontRow(FONT_5X7, g, 0));
+    TEST_ASSERT_EQUAL_HEX8(0x88, fontRow(FONT_5X7, g, 1));
+    TEST_ASSERT_EQUAL_HEX8(0xF8, fontRow(FONT_5X7, g, 4));
+    TEST_ASSERT_EQUAL_HEX8(0x88, fontRow(FONT_5X7, g, 6));
+    
+    // Past the font's height
+    TEST_ASSERT_EQUAL_HEX8(0x00, fontRow(FONT_5X7, g, 7));
+}
+
+// Rows that straddle a byte boundary read the same as aligned ones
+void test_rows_across_bytes(void) {
+    FontGlyph g;
+    for (char c = '0'; c <= '9'; c++) {
+        fontGlyph(FONT_5X7, c, g);
+        for (uint8_t row = 0; row < 7; row++) {
+            TEST_ASSERT_EQUAL_HEX8(0, fontRow(FONT_5X7, g, row) & 0x07);
+        }
+    }
+    
+    // '8': .###. #...# #...# .###. #...# #...# .###.
+    fontGlyph(FONT_5X7, '8', g);
+    TEST_ASSERT_EQUAL_HEX8(0x70, fontRow(FONT_5X7, g, 3));
+    TEST_ASSERT_EQUAL_HEX8(0x88, fontRow(FONT_5X7, g, 4));
+}
+
+void test_fallback(void) {
+    FontGlyph g;
+    
+    // The narrow font has no lowercase
+    TEST_ASSERT_FALSE(fontGlyph(FONT_NARROW, 'a', g));
+    TEST_ASSERT_EQUAL_UINT8(0, g.width);
+    TEST_ASSERT_EQUAL_UINT8(0, fontRow(FONT_NARROW, g, 3));
+    
+    TEST_ASSERT_FALSE(fontGlyph(FONT_5X7, (char)200, g));
+    TEST_ASSERT_EQUAL_UINT8(6, g.advance);
+}
+
+void test_variable_width(void) {
+    FontGlyph digit, colon;
+    TEST_ASSERT_TRUE(fontGlyph(FONT_NARROW, '0', digit));
+    TEST_ASSERT_TRUE(fontGlyph(FONT_NARROW, ':', colon));
+    TEST_ASSERT_EQUAL_UINT8(3, digit.width);
+    TEST_ASSERT_EQUAL_UINT8(1, colon.width);
+    TEST_ASSERT_EQUAL_UINT8(2, colon.advance);
+    
+    // '0': ### #.# ... ###
+    TEST_ASSERT_EQUAL_HEX8(0xE0, fontRow(FONT_NARROW, digit, 0));
+    TEST_ASSERT_EQUAL_HEX8(0xA0, fontRow(FONT_NARROW, digit, 1));
+    TEST_ASSERT_EQUAL_HEX8(0xE0, fontRow(FONT_NARROW, digit, 6));
+    TEST_ASSERT_EQUAL_HEX8(0x80, fontRow(FONT_NARROW, colon, 2));
+    TEST_ASSERT_EQUAL_HEX8(0x00, fontRow(FONT_NARROW, colon, 3));
+    
+    // A blanked colon takes the colon's columns
+    FontGlyph space;
+    fontGlyph(FONT_NARROW, ' ', space);
+    TEST_ASSERT_EQUAL_UINT8(colon.advance, space.advance);
+}
+
+void test_clock_strings_fit(void) {
+    TEST_ASSERT_EQUAL_UINT16(48, fontTextWidth(FONT_5X7, "12:34:56"));
+    TEST_ASSERT_EQUAL_UINT16(28, fontTextWidth(FONT_NARROW, "12:34:56"));
+    TEST_ASSERT_EQUAL_UINT16(fontTextWidth(FONT_NARROW, "12:34:56"), fontTextWidth(FONT_NARROW, "12 34 56"));
+    TEST_ASSERT_EQUAL_UINT16(32, fontTextWidth(FONT_NARROW, "01-02-26"));
+    TEST_ASSERT_EQUAL_UINT16(27, fontTextWidth(FONT_CLOCK, "12:34"));
+    TEST_ASSERT_EQUAL_UINT16(0, fontTextWidth(FONT_CLOCK, ""));
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_monospace_lookup);
+    RUN_TEST(test_rows_across_bytes);
+    RUN_TEST(test_fallback);
+    RUN_TEST(test_variable_width);
+    RUN_TEST(test_clock_strings_fit);
+    return UNITY_END();
+}
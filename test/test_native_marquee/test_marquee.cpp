@@ -0,0 +1,132 @@
+#include <unity.h>
+#include <string.h>
+#include "marquee.h"
+#include "text_layout.h"
+#include "max7219_font.h"
+
+#define VIEW 32
+#define VIEW_BYTES (VIEW / 8)
+
+static Marquee* marquee;
+
+// Column col of the text drawn glyph by glyph (reference for the canvas)
+static bool textPixel(const char* text, uint8_t row, uint16_t col) {
+    uint16_t x = 0;
+    TextGlyph g;
+    while (*text) {
+        textGlyph(FONT_5X7, (uint8_t)*text++, false, g);
+        if (col < x + g.advance) {
+            uint8_t bits = fontRow(FONT_5X7, g.glyph, row);
+            return col - x < 8 && (bits & (0x80 >> (col - x)));
+        }
+        x += g.advance;
+    }
+    return false;
+}
+
+// The view at the marquee's offset matches the text placed on a loop of text + gap
+static void checkView(const char* text) {
+    uint16_t loop = marquee->getTextWidth() + VIEW;
+    uint8_t view[VIEW_BYTES];
+    for (uint8_t row = 0; row < MARQUEE_ROWS; row++) {
+        marquee->window(row, view, VIEW_BYTES);
+        for (uint8_t x = 0; x < VIEW; x++) {
+            uint16_t col = (marquee->getOffset() + x) % loop;
+            bool expected = col < marquee->getTextWidth() && textPixel(text, row, col);
+            bool actual = view[x / 8] & (0x80 >> (x % 8));
+            TEST_ASSERT_EQUAL(expected, actual);
+        }
+    }
+}
+
+void setUp(void) {
+    marquee = new Marquee();
+}
+
+void tearDown(void) {
+    delete marquee;
+}
+
+void test_canvas(void) {
+    const char* text = "HELLO, WORLD";
+    TEST_ASSERT_EQUAL_UINT16(72, marquee->setText(text, FONT_5X7, VIEW));
+    TEST_ASSERT_FALSE(marquee->isActive());
+    TEST_ASSERT_TRUE(marquee->hasText(text, FONT_5X7));
+    TEST_ASSERT_FALSE(marquee->hasText("HELLO", FONT_5X7));
+    TEST_ASSERT_FALSE(marquee->hasText(text, FONT_NARROW));
+    checkView(text);
+}
+
+// Every offset, including the ones where the gap wraps back to the start of the text
+void test_window_all_offsets(void) {
+    const char* text = "ABCDEFG";
+    marquee->setText(text, FONT_5X7, VIEW);
+    marquee->start(0, 1000, 0);  // One column per millisecond
+    
+    uint16_t loop = marquee->getTextWidth() + VIEW;
+    for (uint16_t i = 0; i < loop; i++) {
+        TEST_ASSERT_EQUAL_UINT16(i, marquee->getOffset());
+        checkView(text);
+        marquee->advance((i + 1) * 1000UL);
+    }
+    TEST_ASSERT_EQUAL_UINT16(0, marquee->getOffset());
+    TEST_ASSERT_EQUAL_UINT32(1, marquee->getPasses());
+}
+
+void test_hold_and_speed(void) {
+    marquee->setText("WEDNESDAY 01-15", FONT_5X7, VIEW);
+    marquee->start(5000, 20, 1000);
+    
+    // Holds on the start of the text
+    TEST_ASSERT_FALSE(marquee->advance(505000));
+    TEST_ASSERT_FALSE(marquee->advance(1005000));
+    TEST_ASSERT_EQUAL_UINT16(0, marquee->getOffset());
+    
+    // 20 columns per second: one every 50 ms
+    TEST_ASSERT_FALSE(marquee->advance(1054000));
+    TEST_ASSERT_TRUE(marquee->advance(1055000));
+    TEST_ASSERT_EQUAL_UINT16(1, marquee->getOffset());
+}
+
+// Position follows time, however unevenly the frames come
+void test_jittered_frames(void) {
+    marquee->setText("WEDNESDAY 01-15", FONT_5X7, VIEW);
+    marquee->start(0, 30, 0);
+    
+    uint32_t now = 0;
+    const uint32_t steps[] = {33000, 41000, 12000, 90000, 33333, 1000, 29667};
+    for (uint8_t i = 0; i < 30; i++) {
+        now += steps[i % 7];
+        marquee->advance(now);
+    }
+    
+    // 1.034 s at 30 columns per second, as if every frame had been on time
+    TEST_ASSERT_EQUAL_UINT32(1034000, now);
+    TEST_ASSERT_EQUAL_UINT16(31, marquee->getOffset());
+}
+
+void test_micros_wrap(void) {
+    marquee->setText("WEDNESDAY 01-15", FONT_5X7, VIEW);
+    marquee->start(0xFFFFFFFFUL - 50000, 20, 0);
+    TEST_ASSERT_TRUE(marquee->advance(50000));
+    TEST_ASSERT_EQUAL_UINT16(2, marquee->getOffset());
+}
+
+void test_stop(void) {
+    marquee->setText("WEDNESDAY 01-15", FONT_5X7, VIEW);
+    marquee->start(0, 20, 0);
+    marquee->stop();
+    TEST_ASSERT_FALSE(marquee->isActive());
+    TEST_ASSERT_FALSE(marquee->advance(1000000));
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_canvas);
+    RUN_TEST(test_window_all_offsets);
+    RUN_TEST(test_hold_and_speed);
+    RUN_TEST(test_jittered_frames);
+    RUN_TEST(test_micros_wrap);
+    RUN_TEST(test_stop);
+    return UNITY_END();
+}
@@ -0,0 +1,239 @@
+#include <unity.h>
+#include "ntp_math.h"
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_timestamp_round_trip(void) {
+    uint8_t buf[8];
+    // 2023-01-01 12:00:00.250 UTC
+    ntpWriteTimestampMs(1672574400250ULL, buf);
+
+    // Seconds since 1900 = 1672574400 + 2208988800 = 3881563200 (0xE75BF440)
+    TEST_ASSERT_EQUAL_HEX8(0xE7, buf[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x5B, buf[1]);
+    TEST_ASSERT_EQUAL_HEX8(0xF4, buf[2]);
+    TEST_ASSERT_EQUAL_HEX8(0x40, buf[3]);
+    // 0.25 s = 0x40000000
+    TEST_ASSERT_EQUAL_HEX8(0x40, buf[4]);
+
+    TEST_ASSERT_TRUE(ntpReadTimestampMs(buf) == 1672574400250ULL);
+}
+
+void test_zero_timestamp_is_unset(void) {
+    uint8_t buf[8] = {0};
+    TEST_ASSERT_TRUE(ntpReadTimestampMs(buf) == 0);
+}
+
+void test_era_rollover(void) {
+    // NTP second 1 of era 1 is 2036-02-07 06:28:17 UTC
+    uint8_t buf[8] = {0, 0, 0, 1, 0, 0, 0, 0};
+    TEST_ASSERT_TRUE(ntpReadTimestampMs(buf) == (2085978496ULL + 1) * 1000ULL);
+}
+
+void test_offset_and_delay(void) {
+    // Local clock 100 ms behind, 40 ms each way, 5 ms server turnaround
+    int64_t t1 = 1000000;
+    int64_t t2 = t1 + 100 + 40;
+    int64_t t3 = t2 + 5;
+    int64_t t4 = t3 - 100 + 40;
+
+    NtpSample s = ntpComputeSample(t1, t2, t3, t4);
+    TEST_ASSERT_EQUAL_INT32(100, (int32_t)s.offsetMs);
+    TEST_ASSERT_EQUAL_INT32(80, s.delayMs);
+}
+
+void test_asymmetric_path_bounded_by_half_delay(void) {
+    // 10 ms out, 90 ms back: error is at most delay / 2
+    int64_t t1 = 0;
+    int64_t t2 = 10;
+    int64_t t3 = 10;
+    int64_t t4 = 100;
+
+    NtpSample s = ntpComputeSample(t1, t2, t3, t4);
+    TEST_ASSERT_EQUAL_INT32(100, s.delayMs);
+    TEST_ASSERT_TRUE(s.offsetMs >= -50 && s.offsetMs <= 50);
+}
+
+void test_filter_picks_lowest_delay(void) {
+    NtpClockFilter f;
+    NtpSample a = {30, 60, 0};
+    NtpSample b = {12, 20, 0};
+    NtpSample c = {25, 45, 0};
+
+    TEST_ASSERT_TRUE(f.add(a));
+    TEST_ASSERT_TRUE(f.add(b));
+    TEST_ASSERT_TRUE(f.add(c));
+    TEST_ASSERT_EQUAL_UINT8(3, f.count());
+    TEST_ASSERT_EQUAL_INT32(12, (int32_t)f.best()->offsetMs);
+}
+
+void test_filter_rejects_delay_spikes(void) {
+    NtpClockFilter f;
+    NtpSample good = {5, 20, 0};
+    NtpSample spike = {400, 800, 0};
+    NtpSample huge = {0, NTP_MAX_DELAY_MS + 1, 0};
+
+    TEST_ASSERT_TRUE(f.add(good));
+    TEST_ASSERT_FALSE(f.add(spike));
+    TEST_ASSERT_FALSE(f.add(huge));
+    TEST_ASSERT_EQUAL_UINT8(1, f.count());
+    TEST_ASSERT_EQUAL_UINT32(2, f.rejected());
+}
+
+void test_filter_accepts_lasting_path_change(void) {
+    NtpClockFilter f;
+    NtpSample good = {5, 20, 0};
+    NtpSample slow = {5, 300, 0};
+
+    f.add(good);
+    bool accepted = false;
+    for (int i = 0; i < NTP_FILTER_SIZE && !accepted; i++) {
+        accepted = f.add(slow);
+    }
+    TEST_ASSERT_TRUE(accepted);
+}
+
+void test_filter_correction_and_jitter(void) {
+    NtpClockFilter f;
+    NtpSample a = {100, 20, 0};
+    NtpSample b = {110, 30, 0};
+    f.add(a);
+    f.add(b);
+
+    TEST_ASSERT_EQUAL_UINT32(10, f.jitterMs());
+
+    // Clock stepped by +100 ms: stored offsets shrink accordingly
+    f.applyCorrection(100);
+    TEST_ASSERT_EQUAL_INT32(0, (int32_t)f.best()->offsetMs);
+}
+
+void test_filter_ages_samples(void) {
+    NtpClockFilter f;
+    NtpSample old = {5, 20, 0};
+    NtpSample recent = {8, 24, 100000};
+    f.add(old);
+    f.add(recent);
+
+    // 100 s older adds 1.5 ms, less than the 2 ms of extra half-delay
+    TEST_ASSERT_EQUAL_INT32(5, (int32_t)f.best()->offsetMs);
+
+    // 200 s older adds 3 ms: the newer sample is now the better bound
+    NtpClockFilter g;
+    NtpSample later = {8, 24, 200000};
+    g.add(old);
+    g.add(later);
+    TEST_ASSERT_EQUAL_INT32(8, (int32_t)g.best()->offsetMs);
+}
+
+void test_filter_stale_sample_does_not_mask_drift(void) {
+    NtpClockFilter f;
+    NtpSample fast = {40, 10, 0};
+    f.add(fast);
+    TEST_ASSERT_EQUAL_PTR(f.best(), f.freshBest());
+    f.applyCorrection(fast.offsetMs);
+    TEST_ASSERT_NULL(f.freshBest());
+
+    // Drift builds up while every later path is slower than the first sample
+    int64_t applied = 0;
+    for (uint32_t poll = 1; poll <= 7; poll++) {
+        NtpSample s = {(int64_t)(4 * poll) - applied, 30, poll * 64000};
+        f.add(s);
+
+        // The sample that was already applied still has the best bound
+        TEST_ASSERT_EQUAL_INT32(10, f.best()->delayMs);
+
+        const NtpSample* fresh = f.freshBest();
+        TEST_ASSERT_NOT_NULL(fresh);
+        TEST_ASSERT_EQUAL_INT32(4, (int32_t)fresh->offsetMs);
+        applied += fresh->offsetMs;
+        f.applyCorrection(fresh->offsetMs);
+    }
+    TEST_ASSERT_EQUAL_INT32(28, (int32_t)applied);
+}
+
+void test_read_short_format(void) {
+    // 0x00018000 = 1.5 s in 16.16 format
+    uint8_t buf[4] = {0x00, 0x01, 0x80, 0x00};
+    TEST_ASSERT_EQUAL_UINT32(1500, ntpReadShortMs(buf));
+}
+
+void test_select_all_agree(void) {
+    NtpCandidate c[3] = {
+        {100, 20, 15},
+        {104, 40, 25},
+        {98, 30, 20},
+    };
+    NtpSelection sel;
+
+    TEST_ASSERT_TRUE(ntpSelectSources(c, 3, sel));
+    TEST_ASSERT_EQUAL_UINT8(3, sel.truechimers);
+    TEST_ASSERT_EQUAL_HEX8(0x07, sel.trueMask);
+    TEST_ASSERT_EQUAL_INT32(20, sel.delayMs);
+    TEST_ASSERT_TRUE(sel.offsetMs >= 98 && sel.offsetMs <= 104);
+}
+
+void test_select_drops_falseticker(void) {
+    // Third server is 5 s off
+    NtpCandidate c[4] = {
+        {100, 20, 15},
+        {110, 40, 25},
+        {5000, 10, 10},
+        {95, 30, 20},
+    };
+    NtpSelection sel;
+
+    TEST_ASSERT_TRUE(ntpSelectSources(c, 4, sel));
+    TEST_ASSERT_EQUAL_UINT8(3, sel.truechimers);
+    TEST_ASSERT_EQUAL_HEX8(0x0B, sel.trueMask);
+    TEST_ASSERT_TRUE(sel.offsetMs >= 95 && sel.offsetMs <= 110);
+    TEST_ASSERT_EQUAL_INT32(20, sel.delayMs);
+}
+
+void test_select_needs_majority(void) {
+    NtpCandidate c[2] = {
+        {0, 20, 10},
+        {1000, 20, 10},
+    };
+    NtpSelection sel;
+
+    TEST_ASSERT_FALSE(ntpSelectSources(c, 2, sel));
+    TEST_ASSERT_EQUAL_UINT8(0, sel.truechimers);
+}
+
+void test_select_weights_by_distance(void) {
+    // Tight source dominates a loose one
+    NtpCandidate c[2] = {
+        {0, 10, 10},
+        {90, 10, 90},
+    };
+    NtpSelection sel;
+
+    TEST_ASSERT_TRUE(ntpSelectSources(c, 2, sel));
+    TEST_ASSERT_EQUAL_INT32(9, (int32_t)sel.offsetMs);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_timestamp_round_trip);
+    RUN_TEST(test_zero_timestamp_is_unset);
+    RUN_TEST(test_era_rollover);
+    RUN_TEST(test_offset_and_delay);
+    RUN_TEST(test_asymmetric_path_bounded_by_half_delay);
+    RUN_TEST(test_filter_picks_lowest_delay);
+    RUN_TEST(test_filter_rejects_delay_spikes);
+    RUN_TEST(test_filter_accepts_lasting_path_change);
+    RUN_TEST(test_filter_correction_and_jitter);
+    RUN_TEST(test_filter_ages_samples);
+    RUN_TEST(test_filter_stale_sample_does_not_mask_drift);
+    RUN_TEST(test_read_short_format);
+    RUN_TEST(test_select_all_agree);
+    RUN_TEST(test_select_drops_falseticker);
+    RUN_TEST(test_select_needs_majority);
+    RUN_TEST(test_select_weights_by_distance);
+    UNITY_END();
+    return 0;
+}
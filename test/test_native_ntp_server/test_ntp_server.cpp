@@ -0,0 +1,161 @@
+#include <unity.h>
+#include <string.h>
+#include "ntp_server.h"
+#include "ntp_math.h"
+
+// 2023-01-01 12:00:00 UTC
+#define NOW_MS 1672574400000ULL
+
+static NtpServer* server;
+static NtpServerInfo info;
+
+void setUp(void) {
+    server = new NtpServer();
+    memset(&info, 0, sizeof(info));
+    info.synced = true;
+    info.stratum = 3;
+    info.refId[0] = 192;
+    info.refId[1] = 0;
+    info.refId[2] = 2;
+    info.refId[3] = 7;
+    info.refTimeMs = NOW_MS - 64000;
+    info.rootDelayMs = 30;
+    info.rootDispersionMs = 10;
+}
+
+void tearDown(void) {
+    delete server;
+}
+
+// What ntpdate -q and SNTP clients send: version 4, mode 3, transmit timestamp set
+static void makeRequest(uint8_t* packet, uint64_t transmitMs) {
+    memset(packet, 0, NTP_PACKET_SIZE);
+    packet[0] = 0x23;  // LI 0, version 4, mode 3
+    packet[2] = 6;
+    ntpWriteTimestampMs(transmitMs, &packet[40]);
+    packet[47] = 0x5A;  // Sub-ms bits must come back untouched
+}
+
+void test_reply_fields(void) {
+    uint8_t packet[NTP_PACKET_SIZE];
+    makeRequest(packet, NOW_MS - 20);
+    uint8_t origin[8];
+    memcpy(origin, &packet[40], 8);
+
+    TEST_ASSERT_EQUAL(NTP_SERVE_REPLY, server->handle(packet, NTP_PACKET_SIZE, 0x0A000002, 1000, NOW_MS, info));
+    NtpServer::stampTransmit(packet, NOW_MS + 1);
+
+    TEST_ASSERT_EQUAL_HEX8(0x24, packet[0]);  // LI 0, version 4, mode 4
+    TEST_ASSERT_EQUAL_UINT8(3, packet[1]);
+    TEST_ASSERT_EQUAL_UINT8(6, packet[2]);    // Poll echoed
+    TEST_ASSERT_EQUAL_INT8(NTP_SERVE_PRECISION, (int8_t)packet[3]);
+    TEST_ASSERT_EQUAL_UINT32(30, ntpReadShortMs(&packet[4]));
+    // 10 ms + 64 s at 15 ppm
+    TEST_ASSERT_UINT32_WITHIN(1, 11, ntpReadShortMs(&packet[8]));
+    TEST_ASSERT_EQUAL_HEX8(192, packet[12]);
+    TEST_ASSERT_EQUAL_HEX8(7, packet[15]);
+    TEST_ASSERT_TRUE(ntpReadTimestampMs(&packet[16]) == NOW_MS - 64000);
+    TEST_ASSERT_EQUAL_MEMORY(origin, &packet[24], 8);
+    TEST_ASSERT_TRUE(ntpReadTimestampMs(&packet[32]) == NOW_MS);
+    TEST_ASSERT_TRUE(ntpReadTimestampMs(&packet[40]) - NOW_MS <= 1);
+
+    // The client's view: 10 ms each way, clocks agree
+    NtpSample s = ntpComputeSample(NOW_MS - 10, NOW_MS, NOW_MS + 1, NOW_MS + 11);
+    TEST_ASSERT_TRUE(s.offsetMs == 0);
+    TEST_ASSERT_EQUAL_INT32(20, s.delayMs);
+}
+
+void test_ignores_non_requests(void) {
+    uint8_t packet[NTP_PACKET_SIZE];
+
+    makeRequest(packet, NOW_MS);
+    packet[0] = 0x24;  // A server reply
+    TEST_ASSERT_EQUAL(NTP_SERVE_IGNORED, server->handle(packet, NTP_PACKET_SIZE, 1, 0, NOW_MS, info));
+
+    makeRequest(packet, NOW_MS);
+    TEST_ASSERT_EQUAL(NTP_SERVE_IGNORED, server->handle(packet, 47, 1, 0, NOW_MS, info));
+
+    makeRequest(packet, NOW_MS);
+    packet[0] = 0x03;  // Version 0
+    TEST_ASSERT_EQUAL(NTP_SERVE_IGNORED, server->handle(packet, NTP_PACKET_SIZE, 1, 0, NOW_MS, info));
+
+    TEST_ASSERT_EQUAL_UINT32(0, server->getServed());
+}
+
+void test_unsynchronized(void) {
+    uint8_t packet[NTP_PACKET_SIZE];
+    makeRequest(packet, NOW_MS);
+    packet[0] = 0x1B;  // Version 3 (ntpdate)
+    info.synced = false;
+
+    TEST_ASSERT_EQUAL(NTP_SERVE_REPLY, server->handle(packet, NTP_PACKET_SIZE, 1, 0, NOW_MS, info));
+    TEST_ASSERT_EQUAL_HEX8(0xDC, packet[0]);  // LI 3 (alarm), version 3, mode 4
+    TEST_ASSERT_EQUAL_UINT8(16, packet[1]);
+}
+
+void test_rate_limit(void) {
+    uint8_t packet[NTP_PACKET_SIZE];
+    uint32_t now = 5000;
+
+    // A burst is allowed, then one request per interval
+    for (int i = 0; i < NTP_SERVE_BURST; i++) {
+        makeRequest(packet, NOW_MS);
+        TEST_ASSERT_EQUAL(NTP_SERVE_REPLY, server->handle(packet, NTP_PACKET_SIZE, 42, now, NOW_MS, info));
+    }
+    makeRequest(packet, NOW_MS);
+    TEST_ASSERT_EQUAL(NTP_SERVE_LIMITED, server->handle(packet, NTP_PACKET_SIZE, 42, now + 100, NOW_MS, info));
+
+    // Other clients are unaffected
+    makeRequest(packet, NOW_MS);
+    TEST_ASSERT_EQUAL(NTP_SERVE_REPLY, server->handle(packet, NTP_PACKET_SIZE, 43, now + 100, NOW_MS, info));
+
+    now += NTP_SERVE_MIN_INTERVAL_MS;
+    makeRequest(packet, NOW_MS);
+    TEST_ASSERT_EQUAL(NTP_SERVE_REPLY, server->handle(packet, NTP_PACKET_SIZE, 42, now, NOW_MS, info));
+    makeRequest(packet, NOW_MS);
+    TEST_ASSERT_EQUAL(NTP_SERVE_LIMITED, server->handle(packet, NTP_PACKET_SIZE, 42, now, NOW_MS, info));
+
+    TEST_ASSERT_EQUAL_UINT32(NTP_SERVE_BURST + 2, server->getServed());
+    TEST_ASSERT_EQUAL_UINT32(2, server->getLimited());
+}
+
+void test_client_table_eviction(void) {
+    uint8_t packet[NTP_PACKET_SIZE];
+
+    // Exhaust client 1, then push it out of the table with newer clients
+    for (int i = 0; i <= NTP_SERVE_BURST; i++) {
+        makeRequest(packet, NOW_MS);
+        server->handle(packet, NTP_PACKET_SIZE, 1, 0, NOW_MS, info);
+    }
+    for (uint32_t c = 2; c <= NTP_SERVE_CLIENTS + 1; c++) {
+        makeRequest(packet, NOW_MS);
+        TEST_ASSERT_EQUAL(NTP_SERVE_REPLY, server->handle(packet, NTP_PACKET_SIZE, c, c, NOW_MS, info));
+    }
+
+    // Forgotten, so it starts with a fresh allowance
+    makeRequest(packet, NOW_MS);
+    TEST_ASSERT_EQUAL(NTP_SERVE_REPLY, server->handle(packet, NTP_PACKET_SIZE, 1, 100, NOW_MS, info));
+}
+
+void test_short_format(void) {
+    uint8_t buf[4];
+    ntpWriteShortMs(1500, buf);
+    TEST_ASSERT_EQUAL_HEX8(0x00, buf[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x01, buf[1]);
+    TEST_ASSERT_EQUAL_HEX8(0x80, buf[2]);
+    TEST_ASSERT_EQUAL_UINT32(1500, ntpReadShortMs(buf));
+
+    ntpWriteShortMs(0xFFFFFFFFUL, buf);
+    TEST_ASSERT_EQUAL_HEX8(0xFF, buf[0]);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_reply_fields);
+    RUN_TEST(test_ignores_non_requests);
+    RUN_TEST(test_unsynchronized);
+    RUN_TEST(test_rate_limit);
+    RUN_TEST(test_client_table_eviction);
+    RUN_TEST(test_short_format);
+    return UNITY_END();
+}
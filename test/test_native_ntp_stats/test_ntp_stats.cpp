@@ -0,0 +1,103 @@
+#include <unity.h>
+#include <string.h>
+#include "ntp_stats.h"
+
+static NtpStats* stats;
+
+static NtpSyncRecord makeRecord(NtpSyncOutcome outcome, int32_t offsetMs, int32_t delayMs) {
+    NtpSyncRecord r;
+    memset(&r, 0, sizeof(r));
+    r.utc = 1672574400;
+    r.outcome = outcome;
+    r.correction = outcome == NTP_SYNC_OK ? NTP_CORRECTION_SLEW : NTP_CORRECTION_NONE;
+    r.offsetMs = offsetMs;
+    r.delayMs = delayMs;
+    return r;
+}
+
+void setUp(void) {
+    stats = new NtpStats();
+}
+
+void tearDown(void) {
+    delete stats;
+}
+
+void test_empty(void) {
+    TEST_ASSERT_EQUAL_UINT8(0, stats->count());
+    TEST_ASSERT_EQUAL_UINT32(0, stats->getTotal());
+    TEST_ASSERT_EQUAL_UINT8(0, stats->availabilityPercent());
+    TEST_ASSERT_EQUAL_UINT32(0, stats->jitterMs());
+    TEST_ASSERT_EQUAL_INT32(0, stats->meanDelayMs());
+}
+
+void test_ring_order_and_wrap(void) {
+    for (int32_t i = 0; i < NTP_STATS_HISTORY + 5; i++) {
+        stats->add(makeRecord(NTP_SYNC_OK, i, 10));
+    }
+
+    TEST_ASSERT_EQUAL_UINT8(NTP_STATS_HISTORY, stats->count());
+    TEST_ASSERT_EQUAL_UINT32(NTP_STATS_HISTORY + 5, stats->getTotal());
+    TEST_ASSERT_EQUAL_INT32(NTP_STATS_HISTORY + 4, stats->get(0).offsetMs);
+    TEST_ASSERT_EQUAL_INT32(5, stats->get(NTP_STATS_HISTORY - 1).offsetMs);
+}
+
+void test_availability_and_outcomes(void) {
+    stats->add(makeRecord(NTP_SYNC_OK, 0, 20));
+    stats->add(makeRecord(NTP_SYNC_TIMEOUT, 0, 0));
+    stats->add(makeRecord(NTP_SYNC_KOD, 0, 0));
+    stats->add(makeRecord(NTP_SYNC_OK, 0, 40));
+
+    TEST_ASSERT_EQUAL_UINT8(50, stats->availabilityPercent());
+    TEST_ASSERT_EQUAL_UINT32(2, stats->getOutcomeCount(NTP_SYNC_OK));
+    TEST_ASSERT_EQUAL_UINT32(1, stats->getOutcomeCount(NTP_SYNC_TIMEOUT));
+    TEST_ASSERT_EQUAL_UINT32(1, stats->getOutcomeCount(NTP_SYNC_KOD));
+    TEST_ASSERT_EQUAL_UINT32(0, stats->getOutcomeCount(NTP_SYNC_OUTCOME_COUNT));
+
+    // Delay figures only count syncs that produced a sample
+    TEST_ASSERT_EQUAL_INT32(30, stats->meanDelayMs());
+    TEST_ASSERT_EQUAL_INT32(40, stats->maxDelayMs());
+}
+
+// RMS of consecutive offset changes, skipping failures, clock sets and held RTC errors
+void test_jitter(void) {
+    stats->add(makeRecord(NTP_SYNC_OK, 10, 20));
+    stats->add(makeRecord(NTP_SYNC_TIMEOUT, 500, 0));
+    NtpSyncRecord set = makeRecord(NTP_SYNC_OK, 0, 20);
+    set.correction = NTP_CORRECTION_SET;
+    stats->add(set);
+    NtpSyncRecord held = makeRecord(NTP_SYNC_OK, 60, 20);
+    held.correction = NTP_CORRECTION_HELD;
+    stats->add(held);
+    stats->add(makeRecord(NTP_SYNC_OK, 13, 20));
+    stats->add(makeRecord(NTP_SYNC_OK, 9, 20));
+
+    // Changes +3 and -4: sqrt((9 + 16) / 2) = 3.5
+    TEST_ASSERT_EQUAL_UINT32(3, stats->jitterMs());
+
+    // A steady clock has no jitter
+    stats->reset();
+    for (uint8_t i = 0; i < 5; i++) {
+        stats->add(makeRecord(NTP_SYNC_OK, -7, 20));
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, stats->jitterMs());
+}
+
+void test_names(void) {
+    TEST_ASSERT_EQUAL_STRING("ok", NtpStats::outcomeName(NTP_SYNC_OK));
+    TEST_ASSERT_EQUAL_STRING("kod", NtpStats::outcomeName(NTP_SYNC_KOD));
+    TEST_ASSERT_EQUAL_STRING("send_failed", NtpStats::outcomeName(NTP_SYNC_SEND_FAILED));
+    TEST_ASSERT_EQUAL_STRING("?", NtpStats::outcomeName(NTP_SYNC_OUTCOME_COUNT));
+    TEST_ASSERT_EQUAL_STRING("step", NtpStats::correctionName(NTP_CORRECTION_STEP));
+    TEST_ASSERT_EQUAL_STRING("held", NtpStats::correctionName(NTP_CORRECTION_HELD));
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_empty);
+    RUN_TEST(test_ring_order_and_wrap);
+    RUN_TEST(test_availability_and_outcomes);
+    RUN_TEST(test_jitter);
+    RUN_TEST(test_names);
+    return UNITY_END();
+}
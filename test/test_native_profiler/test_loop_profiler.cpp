@@ -0,0 +1,79 @@
+#include <unity.h>
+#include "loop_profiler.h"
+
+static LoopProfiler* profiler;
+
+void setUp(void) {
+    profiler = new LoopProfiler();
+}
+
+void tearDown(void) {
+    delete profiler;
+}
+
+void test_empty_stage(void) {
+    TEST_ASSERT_EQUAL_UINT32(0, profiler->percentileCycles(PROFILE_STAGE_TIME, 50));
+    TEST_ASSERT_EQUAL_UINT32(0, profiler->percentileCycles(PROFILE_STAGE_COUNT, 50));
+}
+
+// 90 x 100 cycles in [64, 128), 9 x 1000 in [512, 1024), 1 x 5000 in [4096, 8192)
+void test_percentiles_from_buckets(void) {
+    for (int i = 0; i < 90; i++) profiler->record(PROFILE_STAGE_WEB, 100);
+    for (int i = 0; i < 9; i++) profiler->record(PROFILE_STAGE_WEB, 1000);
+    profiler->record(PROFILE_STAGE_WEB, 5000);
+
+    const StageStats& s = profiler->getStats(PROFILE_STAGE_WEB);
+    TEST_ASSERT_EQUAL_UINT32(100, s.count);
+    TEST_ASSERT_EQUAL_UINT32(90, s.buckets[6]);
+    TEST_ASSERT_EQUAL_UINT32(9, s.buckets[9]);
+    TEST_ASSERT_EQUAL_UINT32(1, s.buckets[12]);
+
+    // Ranks 1-90 fall in bucket 6, 91-99 in bucket 9
+    TEST_ASSERT_EQUAL_UINT32(127, profiler->percentileCycles(PROFILE_STAGE_WEB, 0));
+    TEST_ASSERT_EQUAL_UINT32(127, profiler->percentileCycles(PROFILE_STAGE_WEB, 50));
+    TEST_ASSERT_EQUAL_UINT32(127, profiler->percentileCycles(PROFILE_STAGE_WEB, 90));
+    TEST_ASSERT_EQUAL_UINT32(1023, profiler->percentileCycles(PROFILE_STAGE_WEB, 91));
+    TEST_ASSERT_EQUAL_UINT32(1023, profiler->percentileCycles(PROFILE_STAGE_WEB, 99));
+
+    // Bucket 12 tops out at 8191, but nothing above the max was seen
+    TEST_ASSERT_EQUAL_UINT32(5000, profiler->percentileCycles(PROFILE_STAGE_WEB, 100));
+
+    // Other stages are untouched
+    TEST_ASSERT_EQUAL_UINT32(0, profiler->percentileCycles(PROFILE_STAGE_TIME, 50));
+}
+
+void test_rank_rounds_up(void) {
+    profiler->record(PROFILE_STAGE_RENDER, 10);    // [8, 16)
+    profiler->record(PROFILE_STAGE_RENDER, 100);   // [64, 128)
+    profiler->record(PROFILE_STAGE_RENDER, 1000);  // [512, 1024)
+
+    // 3 * 33% = 0.99 is rank 1, 3 * 34% = 1.02 is rank 2
+    TEST_ASSERT_EQUAL_UINT32(15, profiler->percentileCycles(PROFILE_STAGE_RENDER, 33));
+    TEST_ASSERT_EQUAL_UINT32(127, profiler->percentileCycles(PROFILE_STAGE_RENDER, 34));
+    TEST_ASSERT_EQUAL_UINT32(127, profiler->percentileCycles(PROFILE_STAGE_RENDER, 66));
+    TEST_ASSERT_EQUAL_UINT32(1000, profiler->percentileCycles(PROFILE_STAGE_RENDER, 67));
+}
+
+void test_extreme_buckets(void) {
+    // 0 cycles share bucket 0 with 1; the bound is clamped to the max
+    profiler->record(PROFILE_STAGE_TILT, 0);
+    TEST_ASSERT_EQUAL_UINT32(1, profiler->getStats(PROFILE_STAGE_TILT).buckets[0]);
+    TEST_ASSERT_EQUAL_UINT32(0, profiler->percentileCycles(PROFILE_STAGE_TILT, 50));
+
+    // The top bucket's bound is the largest uint32_t, not a shift past it
+    profiler->record(PROFILE_STAGE_TIME, 0x80000001UL);
+    TEST_ASSERT_EQUAL_UINT32(1, profiler->getStats(PROFILE_STAGE_TIME).buckets[31]);
+    TEST_ASSERT_EQUAL_UINT32(0x80000001UL, profiler->percentileCycles(PROFILE_STAGE_TIME, 99));
+
+    profiler->reset();
+    TEST_ASSERT_EQUAL_UINT32(0, profiler->percentileCycles(PROFILE_STAGE_TIME, 99));
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_empty_stage);
+    RUN_TEST(test_percentiles_from_buckets);
+    RUN_TEST(test_rank_rounds_up);
+    RUN_TEST(test_extreme_buckets);
+    return UNITY_END();
+}
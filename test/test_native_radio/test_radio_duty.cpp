@@ -0,0 +1,117 @@
+#include <unity.h>
+#include "radio_duty.h"
+
+// Start near the millis() wrap so every comparison crosses it
+#define T0 ((uint32_t)(0xFFFFFFFFUL - 5000UL))
+
+// T0 plus an offset, wrapped like millis() even where unsigned long is 64-bit
+static uint32_t at(uint32_t d) { return T0 + d; }
+
+static RadioDutyCycle* radio;
+
+void setUp(void) {
+    radio = new RadioDutyCycle();
+    radio->setEnabled(true, T0);
+    radio->update(at(RADIO_MIN_WINDOW_MS));  // Nothing pending: the boot window closes
+}
+
+void tearDown(void) {
+    delete radio;
+}
+
+void test_sleeps_when_idle(void) {
+    TEST_ASSERT_FALSE(radio->isAwake());
+
+    radio->request(RADIO_JOB_NTP, at(1000), at(20000));
+    TEST_ASSERT_FALSE(radio->update(at(10000)));  // Early window reached, deadline not
+    TEST_ASSERT_FALSE(radio->isAwake());
+    TEST_ASSERT_FALSE(radio->mayStart(RADIO_JOB_NTP, at(10000)));
+}
+
+// The first deadline opens a window and the other job rides along
+void test_coalesces_jobs(void) {
+    radio->request(RADIO_JOB_NTP, at(10000), at(20000));
+    radio->request(RADIO_JOB_WEATHER, at(15000), at(60000));
+
+    TEST_ASSERT_TRUE(radio->update(at(20000)));
+    TEST_ASSERT_TRUE(radio->isAwake());
+    TEST_ASSERT_TRUE(radio->mayStart(RADIO_JOB_NTP, at(20000)));
+    TEST_ASSERT_TRUE(radio->mayStart(RADIO_JOB_WEATHER, at(20000)));
+    TEST_ASSERT_EQUAL_UINT16(1, radio->getHour(0).windows);
+
+    // Stays open while either job has traffic in flight
+    radio->setBusy(RADIO_JOB_NTP, false);
+    TEST_ASSERT_FALSE(radio->update(at(25000)));
+    radio->setBusy(RADIO_JOB_WEATHER, false);
+    TEST_ASSERT_TRUE(radio->update(at(26000)));
+    TEST_ASSERT_FALSE(radio->isAwake());
+}
+
+// A job whose early time hasn't come doesn't hold the window or start in it
+void test_not_yet_runnable(void) {
+    radio->request(RADIO_JOB_NTP, at(10000), at(20000));
+    radio->request(RADIO_JOB_WEATHER, at(500000), at(600000));
+
+    radio->update(at(20000));
+    TEST_ASSERT_TRUE(radio->mayStart(RADIO_JOB_NTP, at(20000)));
+    TEST_ASSERT_FALSE(radio->mayStart(RADIO_JOB_WEATHER, at(20000)));
+
+    radio->setBusy(RADIO_JOB_NTP, false);
+    TEST_ASSERT_TRUE(radio->update(at(20000 + RADIO_MIN_WINDOW_MS)));
+    TEST_ASSERT_FALSE(radio->isAwake());
+}
+
+void test_disabled_runs_at_deadline(void) {
+    radio->setEnabled(false, at(1000));
+    TEST_ASSERT_TRUE(radio->isAwake());
+
+    radio->request(RADIO_JOB_WEATHER, at(2000), at(8000));
+    TEST_ASSERT_FALSE(radio->mayStart(RADIO_JOB_WEATHER, at(5000)));
+    TEST_ASSERT_TRUE(radio->mayStart(RADIO_JOB_WEATHER, at(8000)));
+
+    radio->setBusy(RADIO_JOB_WEATHER, false);
+    TEST_ASSERT_FALSE(radio->update(at(60000)));
+    TEST_ASSERT_TRUE(radio->isAwake());
+}
+
+void test_hold_awake(void) {
+    radio->holdAwake(at(1000), 10000);
+    TEST_ASSERT_TRUE(radio->update(at(1000)));
+    TEST_ASSERT_TRUE(radio->isAwake());
+
+    TEST_ASSERT_FALSE(radio->update(at(10999)));
+    TEST_ASSERT_TRUE(radio->update(at(11000)));
+    TEST_ASSERT_FALSE(radio->isAwake());
+}
+
+void test_hourly_accounting(void) {
+    // Awake for the last 2 s of the first hour and the first 3 s of the next
+    uint32_t hourEnd = at(RADIO_HOUR_MS);
+    radio->holdAwake(hourEnd - 2000, 5000);
+    radio->update(hourEnd - 2000);
+    radio->update(hourEnd + 3000);
+    TEST_ASSERT_FALSE(radio->isAwake());
+
+    TEST_ASSERT_EQUAL_UINT8(1, radio->getHoursRecorded());
+    TEST_ASSERT_EQUAL_UINT32(3000, radio->getHour(0).awakeMs);
+    TEST_ASSERT_EQUAL_UINT16(0, radio->getHour(0).windows);
+    TEST_ASSERT_EQUAL_UINT32(RADIO_MIN_WINDOW_MS + 2000, radio->getHour(1).awakeMs);
+    TEST_ASSERT_EQUAL_UINT16(1, radio->getHour(1).windows);
+    TEST_ASSERT_EQUAL_UINT32(3000, radio->getHourElapsedMs(hourEnd + 3000));
+
+    // The ring keeps RADIO_HISTORY_HOURS, the oldest hours drop off
+    radio->update(hourEnd + 30 * RADIO_HOUR_MS);
+    TEST_ASSERT_EQUAL_UINT8(RADIO_HISTORY_HOURS - 1, radio->getHoursRecorded());
+    TEST_ASSERT_EQUAL_UINT32(0, radio->getHour(RADIO_HISTORY_HOURS - 1).awakeMs);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_sleeps_when_idle);
+    RUN_TEST(test_coalesces_jobs);
+    RUN_TEST(test_not_yet_runnable);
+    RUN_TEST(test_disabled_runs_at_deadline);
+    RUN_TEST(test_hold_awake);
+    RUN_TEST(test_hourly_accounting);
+    return UNITY_END();
+}
@@ -0,0 +1,114 @@
+#include <unity.h>
+#include "scheduler.h"
+
+static int runsA;
+static int runsB;
+static int runsOnce;
+static int order[8];
+static int orderLen;
+
+static void taskA() { runsA++; if (orderLen < 8) order[orderLen++] = 'A'; }
+static void taskB() { runsB++; if (orderLen < 8) order[orderLen++] = 'B'; }
+static void taskOnce() { runsOnce++; }
+
+void setUp(void) {
+    runsA = 0;
+    runsB = 0;
+    runsOnce = 0;
+    orderLen = 0;
+}
+
+void tearDown(void) {
+}
+
+void test_runs_in_deadline_order(void) {
+    TaskScheduler s;
+    s.addTask(taskA, 100, 0, CATCH_UP_SKIP, 50);
+    s.addTask(taskB, 100, 0, CATCH_UP_SKIP, 20);
+
+    TEST_ASSERT_EQUAL_UINT32(20, s.timeUntilNext(0));
+    TEST_ASSERT_EQUAL_UINT8(0, s.run(10));
+    TEST_ASSERT_EQUAL_UINT8(2, s.run(60));
+    TEST_ASSERT_EQUAL_INT('B', order[0]);
+    TEST_ASSERT_EQUAL_INT('A', order[1]);
+
+    // Next deadlines are 120 (B) and 150 (A)
+    TEST_ASSERT_EQUAL_UINT32(60, s.timeUntilNext(60));
+}
+
+void test_skip_policy_realigns_to_grid(void) {
+    TaskScheduler s;
+    int8_t id = s.addTask(taskA, 1000, 0);
+
+    s.run(0);
+    TEST_ASSERT_EQUAL_INT(1, runsA);
+
+    // Stall for 3.5 periods: one run, missed slots dropped
+    s.run(4500);
+    TEST_ASSERT_EQUAL_INT(2, runsA);
+    TEST_ASSERT_EQUAL_UINT32(3, s.getMissedCount(id));
+    TEST_ASSERT_EQUAL_UINT32(500, s.timeUntilNext(4500));
+}
+
+void test_catch_up_all_runs_missed_periods(void) {
+    TaskScheduler s;
+    s.addTask(taskA, 1000, 0, CATCH_UP_ALL);
+
+    s.run(0);
+    s.run(3000);
+    // Deadlines 1000, 2000 and 3000 are all served
+    TEST_ASSERT_EQUAL_INT(4, runsA);
+    TEST_ASSERT_EQUAL_UINT32(1000, s.timeUntilNext(3000));
+}
+
+void test_one_shot_arms_and_disarms(void) {
+    TaskScheduler s;
+    int8_t id = s.addOneShot(taskOnce);
+    s.addTask(taskA, 500, 0, CATCH_UP_SKIP, 500);
+
+    TEST_ASSERT_FALSE(s.isArmed(id));
+    s.run(1000);
+    TEST_ASSERT_EQUAL_INT(0, runsOnce);
+
+    s.runAt(id, 1200);
+    TEST_ASSERT_TRUE(s.isArmed(id));
+    s.run(1200);
+    TEST_ASSERT_EQUAL_INT(1, runsOnce);
+    TEST_ASSERT_FALSE(s.isArmed(id));
+
+    s.run(5000);
+    TEST_ASSERT_EQUAL_INT(1, runsOnce);
+}
+
+// Start 0x100 ms before the millis() wrap
+#define T0 ((uint32_t)0xFFFFFF00UL)
+
+// T0 plus an offset, wrapped like millis() even where unsigned long is 64-bit
+static uint32_t at(uint32_t d) { return T0 + d; }
+
+void test_millis_rollover(void) {
+    TaskScheduler s;
+    s.addTask(taskA, 0x200, T0, CATCH_UP_SKIP, 0x100);
+
+    TEST_ASSERT_EQUAL_UINT8(0, s.run(at(0xFF)));
+    TEST_ASSERT_EQUAL_UINT32(1, s.timeUntilNext(at(0xFF)));
+    TEST_ASSERT_EQUAL_UINT32(0, at(0x100));
+    TEST_ASSERT_EQUAL_UINT8(1, s.run(at(0x100)));  // Deadline wraps to 0
+    TEST_ASSERT_EQUAL_UINT32(0x200, s.timeUntilNext(at(0x100)));
+
+    // The next deadline is counted past the wrap as well
+    TEST_ASSERT_EQUAL_UINT8(0, s.run(at(0x2FF)));
+    TEST_ASSERT_EQUAL_UINT8(1, s.run(at(0x300)));
+    TEST_ASSERT_EQUAL_INT(2, runsA);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_runs_in_deadline_order);
+    RUN_TEST(test_skip_policy_realigns_to_grid);
+    RUN_TEST(test_catch_up_all_runs_missed_periods);
+    RUN_TEST(test_one_shot_arms_and_disarms);
+    RUN_TEST(test_millis_rollover);
+    UNITY_END();
+    return 0;
+}
@@ -0,0 +1,133 @@
+#include <unity.h>
+#include "text_layout.h"
+#include "max7219_font.h"
+
+#define PANEL 32
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_measure(void) {
+    bool covered;
+    
+    // Spacing after the last glyph doesn't count
+    TEST_ASSERT_EQUAL_UINT16(5, textMeasure(FONT_5X7, "A", false, covered));
+    TEST_ASSERT_EQUAL_UINT16(47, textMeasure(FONT_5X7, "12:34:56", false, covered));
+    TEST_ASSERT_TRUE(covered);
+    TEST_ASSERT_EQUAL_UINT16(27, textMeasure(FONT_NARROW, "12:34:56", false, covered));
+    TEST_ASSERT_EQUAL_UINT16(0, textMeasure(FONT_5X7, "", false, covered));
+    
+    textMeasure(FONT_NARROW, "abc", false, covered);
+    TEST_ASSERT_FALSE(covered);
+}
+
+void test_narrow_punctuation(void) {
+    TextGlyph g;
+    
+    // 5x7 colon .##.. crops to its two ink columns
+    textGlyph(FONT_5X7, ':', true, g);
+    TEST_ASSERT_EQUAL_UINT8(1, g.skip);
+    TEST_ASSERT_EQUAL_UINT8(2, g.width);
+    TEST_ASSERT_EQUAL_UINT8(3, g.advance);
+    
+    // Digits keep their cells so the time doesn't shift as it changes
+    textGlyph(FONT_5X7, '1', true, g);
+    TEST_ASSERT_EQUAL_UINT8(0, g.skip);
+    TEST_ASSERT_EQUAL_UINT8(6, g.advance);
+    
+    // Spaces take half a cell
+    textGlyph(FONT_5X7, ' ', true, g);
+    TEST_ASSERT_EQUAL_UINT8(0, g.width);
+    TEST_ASSERT_EQUAL_UINT8(3, g.advance);
+    
+    // Off unless asked for
+    textGlyph(FONT_5X7, ':', false, g);
+    TEST_ASSERT_EQUAL_UINT8(6, g.advance);
+    
+    bool covered;
+    TEST_ASSERT_EQUAL_UINT16(41, textMeasure(FONT_5X7, "12:34:56", true, covered));
+}
+
+void test_fit_alignment(void) {
+    TextFit fit = textFit("12:34", FONT_5X7, &FONT_NARROW, PANEL, TEXT_ALIGN_CENTER);
+    TEST_ASSERT_TRUE(fit.fits);
+    TEST_ASSERT_EQUAL_PTR(&FONT_5X7, fit.font);
+    TEST_ASSERT_FALSE(fit.narrowPunctuation);
+    TEST_ASSERT_EQUAL_UINT16(29, fit.width);
+    TEST_ASSERT_EQUAL_UINT8(1, fit.x);
+    
+    fit = textFit("12:34", FONT_5X7, &FONT_NARROW, PANEL, TEXT_ALIGN_RIGHT);
+    TEST_ASSERT_EQUAL_UINT8(3, fit.x);
+    fit = textFit("12:34", FONT_5X7, &FONT_NARROW, PANEL, TEXT_ALIGN_LEFT);
+    TEST_ASSERT_EQUAL_UINT8(0, fit.x);
+}
+
+void test_fit_falls_back(void) {
+    // Narrowed dots take "WiFi..." from 41 columns to 32
+    TextFit fit = textFit("WiFi...", FONT_5X7, &FONT_NARROW, PANEL, TEXT_ALIGN_CENTER);
+    TEST_ASSERT_TRUE(fit.fits);
+    TEST_ASSERT_EQUAL_PTR(&FONT_5X7, fit.font);
+    TEST_ASSERT_TRUE(fit.narrowPunctuation);
+    TEST_ASSERT_EQUAL_UINT16(32, fit.width);
+    
+    // HH:MM:SS needs the narrow digits
+    fit = textFit("12:34:56", FONT_5X7, &FONT_NARROW, PANEL, TEXT_ALIGN_CENTER);
+    TEST_ASSERT_TRUE(fit.fits);
+    TEST_ASSERT_EQUAL_PTR(&FONT_NARROW, fit.font);
+    TEST_ASSERT_EQUAL_UINT16(27, fit.width);
+    TEST_ASSERT_EQUAL_UINT8(2, fit.x);
+    
+    // So does the weather
+    fit = textFit(" 72F SUN", FONT_5X7, &FONT_NARROW, PANEL, TEXT_ALIGN_CENTER);
+    TEST_ASSERT_TRUE(fit.fits);
+    TEST_ASSERT_EQUAL_PTR(&FONT_NARROW, fit.font);
+    
+    // The condensed font is skipped when it lacks characters; what doesn't fit starts at the left
+    fit = textFit("Wednesday", FONT_5X7, &FONT_NARROW, PANEL, TEXT_ALIGN_CENTER);
+    TEST_ASSERT_FALSE(fit.fits);
+    TEST_ASSERT_EQUAL_PTR(&FONT_5X7, fit.font);
+    TEST_ASSERT_EQUAL_UINT8(0, fit.x);
+    
+    fit = textFit("12:34:56", FONT_5X7, nullptr, PANEL, TEXT_ALIGN_CENTER);
+    TEST_ASSERT_FALSE(fit.fits);
+    TEST_ASSERT_TRUE(fit.narrowPunctuation);
+}
+
+void test_cache(void) {
+    TextLayoutCache cache;
+    
+    const TextFit& first = cache.fit("12:34:56", FONT_5X7, &FONT_NARROW, PANEL, TEXT_ALIGN_CENTER);
+    TEST_ASSERT_EQUAL_PTR(&FONT_NARROW, first.font);
+    cache.fit("12:34:56", FONT_5X7, &FONT_NARROW, PANEL, TEXT_ALIGN_CENTER);
+    TEST_ASSERT_EQUAL_UINT32(1, cache.getHits());
+    TEST_ASSERT_EQUAL_UINT32(1, cache.getMisses());
+    
+    // Different alignment or font is a different layout
+    TEST_ASSERT_EQUAL_UINT8(0, cache.fit("12:34:56", FONT_5X7, &FONT_NARROW, PANEL, TEXT_ALIGN_LEFT).x);
+    cache.fit("12:34", FONT_CLOCK, &FONT_NARROW, PANEL, TEXT_ALIGN_CENTER);
+    TEST_ASSERT_EQUAL_UINT32(3, cache.getMisses());
+    
+    // Oldest entries make way for new ones
+    for (uint8_t i = 0; i < TEXT_LAYOUT_CACHE_SIZE; i++) {
+        char text[4] = {'A', (char)('A' + i), 0, 0};
+        cache.fit(text, FONT_5X7, &FONT_NARROW, PANEL, TEXT_ALIGN_CENTER);
+    }
+    cache.fit("12:34:56", FONT_5X7, &FONT_NARROW, PANEL, TEXT_ALIGN_CENTER);
+    TEST_ASSERT_EQUAL_UINT32(1, cache.getHits());
+    
+    // Too long to cache, still laid out
+    const char* longText = "THE QUICK BROWN FOX JUMPS";
+    TEST_ASSERT_FALSE(cache.fit(longText, FONT_5X7, &FONT_NARROW, PANEL, TEXT_ALIGN_CENTER).fits);
+    cache.fit(longText, FONT_5X7, &FONT_NARROW, PANEL, TEXT_ALIGN_CENTER);
+    TEST_ASSERT_EQUAL_UINT32(1, cache.getHits());
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_measure);
+    RUN_TEST(test_narrow_punctuation);
+    RUN_TEST(test_fit_alignment);
+    RUN_TEST(test_fit_falls_back);
+    RUN_TEST(test_cache);
+    return UNITY_END();
+}
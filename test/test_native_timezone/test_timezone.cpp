@@ -0,0 +1,103 @@
+#include <unity.h>
+#include "timezone.h"
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_fixed_offset(void) {
+    TimeZone tz;
+    TEST_ASSERT_TRUE(tz.parse("JST-9"));
+    TEST_ASSERT_FALSE(tz.hasDst());
+    TEST_ASSERT_EQUAL_INT32(32400, tz.offsetAt(1672574400));
+    TEST_ASSERT_EQUAL_STRING("JST", tz.getAbbreviation(1672574400));
+
+    TEST_ASSERT_TRUE(tz.parse("<+0530>-5:30"));
+    TEST_ASSERT_EQUAL_INT32(19800, tz.offsetAt(1672574400));
+    TEST_ASSERT_EQUAL_STRING("+0530", tz.getAbbreviation(0));
+}
+
+void test_us_transitions(void) {
+    TimeZone tz;
+    TEST_ASSERT_TRUE(tz.parse("PST8PDT,M3.2.0,M11.1.0"));
+
+    // 2024-03-10 02:00 PST = 10:00 UTC
+    TEST_ASSERT_EQUAL_INT32(-28800, tz.offsetAt(1710064799));
+    TEST_ASSERT_EQUAL_INT32(-25200, tz.offsetAt(1710064800));
+    TEST_ASSERT_EQUAL_STRING("PDT", tz.getAbbreviation(1710064800));
+
+    // 2024-11-03 02:00 PDT = 09:00 UTC
+    TEST_ASSERT_EQUAL_INT32(-25200, tz.offsetAt(1730624399));
+    TEST_ASSERT_EQUAL_INT32(-28800, tz.offsetAt(1730624400));
+}
+
+void test_default_rules_are_us(void) {
+    TimeZone tz;
+    TEST_ASSERT_TRUE(tz.parse("EST5EDT"));
+    TEST_ASSERT_TRUE(tz.isDst(1720000000));   // July 2024
+    TEST_ASSERT_FALSE(tz.isDst(1705000000));  // January 2024
+    TEST_ASSERT_EQUAL_INT32(-14400, tz.getDstOffset());
+}
+
+void test_eu_last_sunday(void) {
+    TimeZone tz;
+    TEST_ASSERT_TRUE(tz.parse("CET-1CEST,M3.5.0,M10.5.0/3"));
+
+    // 2024-03-31 and 2024-10-27, both 01:00 UTC
+    TEST_ASSERT_FALSE(tz.isDst(1711846799));
+    TEST_ASSERT_TRUE(tz.isDst(1711846800));
+    TEST_ASSERT_TRUE(tz.isDst(1729990799));
+    TEST_ASSERT_FALSE(tz.isDst(1729990800));
+}
+
+void test_southern_hemisphere(void) {
+    TimeZone tz;
+    TEST_ASSERT_TRUE(tz.parse("AEST-10AEDT,M10.1.0,M4.1.0/3"));
+
+    // DST spans the new year: ends 2024-04-07 03:00 AEDT, starts 2024-10-06 02:00 AEST
+    TEST_ASSERT_TRUE(tz.isDst(1704067200));   // 2024-01-01
+    TEST_ASSERT_TRUE(tz.isDst(1712419199));
+    TEST_ASSERT_FALSE(tz.isDst(1712419200));
+    TEST_ASSERT_FALSE(tz.isDst(1728143999));
+    TEST_ASSERT_TRUE(tz.isDst(1728144000));
+}
+
+void test_julian_rules(void) {
+    TimeZone tz;
+    // J60 is March 1 even in leap years; 59 (zero-based) is Feb 29 in 2024
+    TEST_ASSERT_TRUE(tz.parse("XST0XDT,J60/0,59/0"));
+    tz.isDst(1709251200);  // 2024-03-01
+    TEST_ASSERT_EQUAL_INT64(1709251200LL, tz.getDstStart());
+    TEST_ASSERT_EQUAL_INT64(1709164800LL - 3600, tz.getDstEnd());  // 2024-02-29 00:00 XDT
+}
+
+void test_rejects_malformed(void) {
+    TimeZone tz;
+    TEST_ASSERT_TRUE(tz.parse("PST8PDT"));
+    TEST_ASSERT_FALSE(tz.parse(""));
+    TEST_ASSERT_FALSE(tz.parse("PS8"));
+    TEST_ASSERT_FALSE(tz.parse("PST"));
+    TEST_ASSERT_FALSE(tz.parse("PST8PDT,M13.1.0,M11.1.0"));
+    TEST_ASSERT_FALSE(tz.parse("PST8PDT,M3.2.0"));
+    TEST_ASSERT_FALSE(tz.parse("PST8PDT,M3.2.0,M11.1.0x"));
+    TEST_ASSERT_FALSE(tz.parse("<+05"));
+
+    // A failed parse leaves the zone unchanged
+    TEST_ASSERT_EQUAL_INT32(-28800, tz.getStdOffset());
+    TEST_ASSERT_TRUE(tz.hasDst());
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_fixed_offset);
+    RUN_TEST(test_us_transitions);
+    RUN_TEST(test_default_rules_are_us);
+    RUN_TEST(test_eu_last_sunday);
+    RUN_TEST(test_southern_hemisphere);
+    RUN_TEST(test_julian_rules);
+    RUN_TEST(test_rejects_malformed);
+    UNITY_END();
+    return 0;
+}
@@ -1,18 +1,25 @@
 #include <Arduino.h>
 #include <unity.h>
 #include "time_manager.h"
+#include "esp8266_clock.h"
 
 TimeManager* tm_test;
+ESP8266Clock* clock_test;
 
 void setUp(void) {
     tm_test = new TimeManager();
-    // Default config has UTC_OFFSET_SECONDS (-28800 for PST)
-    // We should ensure timezone is set to 0 for easier testing, or account for it
-    tm_test->setTimezoneOffset(0);
+    // Without a clock source setTime() is dropped and every field reads 0
+    clock_test = new ESP8266Clock();
+    clock_test->begin();
+    tm_test->setClockSource(clock_test);
+    // Default config has TIMEZONE (US Pacific)
+    // Use UTC for easier testing
+    tm_test->setTimezone("UTC0");
 }
 
 void tearDown(void) {
     delete tm_test;
+    delete clock_test;
 }
 
 void test_time_components(void) {
@@ -48,16 +55,115 @@ void test_timezone_offset(void) {
     tm_test->setTime(epoch);
     
     // Set PST (-8 hours = -28800)
-    tm_test->setTimezoneOffset(-28800);
+    tm_test->setTimezone("PST8");
     
     // Should be 04:00
     TEST_ASSERT_EQUAL_INT(4, tm_test->getHours());
     
     // Set JST (+9 hours = 32400)
-    tm_test->setTimezoneOffset(32400);
+    tm_test->setTimezone("JST-9");
     
     // Should be 21:00 (12 + 9)
     TEST_ASSERT_EQUAL_INT(21, tm_test->getHours());
+    
+    // The clock itself keeps UTC
+    TEST_ASSERT_EQUAL_UINT32(epoch, tm_test->getEpochTime());
+}
+
+void test_daylight_saving(void) {
+    tm_test->setTimezone("PST8PDT,M3.2.0,M11.1.0");
+    
+    // 2024-03-10 09:59:59 UTC = 01:59:59 PST
+    tm_test->setTime(1710064799);
+    TEST_ASSERT_EQUAL_INT(1, tm_test->getHours());
+    TEST_ASSERT_FALSE(tm_test->isDst());
+    
+    // One second later it is 03:00:00 PDT
+    tm_test->setTime(1710064800);
+    TEST_ASSERT_EQUAL_INT(3, tm_test->getHours());
+    TEST_ASSERT_TRUE(tm_test->isDst());
+    TEST_ASSERT_EQUAL_INT32(-25200, tm_test->getTimezoneOffset());
+
+    // 2024-11-03 08:59:59 UTC = 01:59:59 PDT, then 01:00:00 PST again
+    tm_test->setTime(1730624399);
+    TEST_ASSERT_EQUAL_INT(1, tm_test->getHours());
+    TEST_ASSERT_TRUE(tm_test->isDst());
+    tm_test->setTime(1730624400);
+    TEST_ASSERT_EQUAL_INT(1, tm_test->getHours());
+    TEST_ASSERT_EQUAL_INT(0, tm_test->getMinutes());
+    TEST_ASSERT_FALSE(tm_test->isDst());
+    TEST_ASSERT_EQUAL_INT32(-28800, tm_test->getTimezoneOffset());
+
+    // UTC itself never repeats
+    TEST_ASSERT_EQUAL_UINT32(1730624400, tm_test->getEpochTime());
+}
+
+void test_local_date_rollover(void) {
+    tm_test->setTimezone("JST-9");
+    
+    // 2024-02-29 14:59:59 UTC = 23:59:59 JST, Thursday
+    tm_test->setTime(1709218799);
+    TEST_ASSERT_EQUAL_INT(29, tm_test->getDay());
+    TEST_ASSERT_EQUAL_INT(4, tm_test->getDayOfWeek());
+    
+    // The date follows the local midnight straight away
+    tm_test->setTime(1709218800);
+    TEST_ASSERT_EQUAL_INT(2024, tm_test->getYear());
+    TEST_ASSERT_EQUAL_INT(3, tm_test->getMonth());
+    TEST_ASSERT_EQUAL_INT(1, tm_test->getDay());
+    TEST_ASSERT_EQUAL_INT(5, tm_test->getDayOfWeek());
+}
+
+void test_snapshot(void) {
+    tm_test->setTimezone("PST8PDT,M3.2.0,M11.1.0");
+    
+    // 2024-03-10 10:00:00 UTC = 03:00:00 PDT, Sunday
+    tm_test->setTime(1710064800);
+    tm_test->takeSnapshot();
+    const TimeSnapshot& now = tm_test->snapshot();
+    TEST_ASSERT_TRUE(now.valid);
+    TEST_ASSERT_EQUAL_UINT8(3, now.hours);
+    TEST_ASSERT_EQUAL_UINT8(0, now.minutes);
+    TEST_ASSERT_EQUAL_UINT8(0, now.seconds);
+    TEST_ASSERT_EQUAL_INT32(2024, now.year);
+    TEST_ASSERT_EQUAL_UINT8(3, now.month);
+    TEST_ASSERT_EQUAL_UINT8(10, now.day);
+    TEST_ASSERT_EQUAL_UINT8(0, now.dayOfWeek);
+    TEST_ASSERT_FALSE(now.pm);
+    TEST_ASSERT_TRUE(now.dst);
+    TEST_ASSERT_EQUAL_STRING("PDT", now.zone);
+    
+    // Held until the next snapshot, however the clock moves
+    tm_test->setTime(1710108000);
+    TEST_ASSERT_EQUAL_UINT8(3, tm_test->snapshot().hours);
+    tm_test->takeSnapshot();
+    TEST_ASSERT_EQUAL_UINT8(15, tm_test->snapshot().hours);
+    TEST_ASSERT_TRUE(tm_test->snapshot().pm);
+    TEST_ASSERT_EQUAL_UINT8(3, tm_test->snapshot().hours12());
+}
+
+void test_epoch_millis_fraction(void) {
+    ESP8266Clock clock;
+    clock.begin();
+
+    // 2023-01-01 12:00:00.900 UTC
+    clock.setEpochMillis(1672574400900ULL);
+    TEST_ASSERT_EQUAL_UINT32(1672574400, clock.getEpochTime());
+
+    // The second flips 100ms later, not a full second after the set
+    delay(150);
+    TEST_ASSERT_EQUAL_UINT32(1672574401, clock.getEpochTime());
+    uint32_t fraction = (uint32_t)(clock.getEpochMillis() % 1000ULL);
+    TEST_ASSERT_UINT32_WITHIN(20, 50, fraction);
+}
+
+void test_offline_poll_backs_off(void) {
+    // The test build never connects Wi-Fi, so the poll update() starts when due fails
+    tm_test->startSync();
+    TEST_ASSERT_FALSE(tm_test->isSyncing());
+    
+    // It still waits out the minimum interval instead of coming due again next pass
+    TEST_ASSERT_UINT32_WITHIN(1000, 1000UL << NTP_MIN_POLL, tm_test->getMillisUntilPoll());
 }
 
 void setup() {
@@ -66,6 +172,11 @@ void setup() {
     RUN_TEST(test_time_components);
     RUN_TEST(test_time_math);
     RUN_TEST(test_timezone_offset);
+    RUN_TEST(test_daylight_saving);
+    RUN_TEST(test_local_date_rollover);
+    RUN_TEST(test_snapshot);
+    RUN_TEST(test_epoch_millis_fraction);
+    RUN_TEST(test_offline_poll_backs_off);
     UNITY_END();
 }
 
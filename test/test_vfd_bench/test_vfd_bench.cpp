@@ -0,0 +1,104 @@
+#include <Arduino.h>
+#include <unity.h>
+#include "vfd_driver.h"
+
+// Frames alternate so every iteration changes all 8 digits
+#define BENCH_ITERATIONS 500
+
+static const char* FRAMES[2] = { "12345678", "87654321" };
+
+VFDDriver* vfd;
+
+void setUp(void) {
+    vfd = new VFDDriver();
+    vfd->begin();
+}
+
+void tearDown(void) {
+    delete vfd;
+}
+
+// Old print(): setCursor(0) then one transaction per character
+static void legacyPrint(const char* text) {
+    vfd->setCursor(0);
+    for (uint8_t i = 0; i < VFD_NUM_DIGITS; i++) {
+        vfd->printChar(text[i]);
+    }
+}
+
+// Old clear(): setCursor + space for every digit, then home the cursor
+static void legacyClear() {
+    for (uint8_t i = 0; i < VFD_NUM_DIGITS; i++) {
+        vfd->setCursor(i);
+        vfd->printChar(' ');
+    }
+    vfd->setCursor(0);
+}
+
+static void report(const char* name, unsigned long elapsedUs, const DisplayStats& stats) {
+    Serial.printf("%-14s %6lu us/frame  %4lu bytes/frame  %4lu transactions/frame  %.3f bytes/us on bus\n",
+                  name,
+                  elapsedUs / BENCH_ITERATIONS,
+                  (unsigned long)(stats.bytesSent / BENCH_ITERATIONS),
+                  (unsigned long)(stats.transactions / BENCH_ITERATIONS),
+                  stats.busMicros ? (float)stats.bytesSent / stats.busMicros : 0.0f);
+}
+
+void test_bench_print(void) {
+    vfd->resetStats();
+    unsigned long start = micros();
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+        legacyPrint(FRAMES[i & 1]);
+    }
+    unsigned long legacyUs = micros() - start;
+    DisplayStats legacy = vfd->getStats();
+    report("print legacy", legacyUs, legacy);
+
+    vfd->resetStats();
+    start = micros();
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+        vfd->print(FRAMES[i & 1]);
+    }
+    unsigned long burstUs = micros() - start;
+    DisplayStats burst = vfd->getStats();
+    report("print burst", burstUs, burst);
+
+    // One transaction per frame instead of nine
+    TEST_ASSERT_EQUAL_UINT32(BENCH_ITERATIONS, burst.transactions);
+    TEST_ASSERT_TRUE(burstUs < legacyUs);
+}
+
+void test_bench_clear(void) {
+    vfd->resetStats();
+    unsigned long start = micros();
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+        legacyClear();
+        vfd->invalidate();
+    }
+    unsigned long legacyUs = micros() - start;
+    DisplayStats legacy = vfd->getStats();
+    report("clear legacy", legacyUs, legacy);
+
+    vfd->resetStats();
+    start = micros();
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+        vfd->clear();
+        vfd->invalidate();  // Defeat the shadow so every clear hits the bus
+    }
+    unsigned long burstUs = micros() - start;
+    DisplayStats burst = vfd->getStats();
+    report("clear burst", burstUs, burst);
+
+    TEST_ASSERT_EQUAL_UINT32(BENCH_ITERATIONS, burst.transactions);
+    TEST_ASSERT_TRUE(burstUs < legacyUs);
+}
+
+void setup() {
+    delay(2000);
+    UNITY_BEGIN();
+    RUN_TEST(test_bench_print);
+    RUN_TEST(test_bench_clear);
+    UNITY_END();
+}
+
+void loop() {}